@@ -3,6 +3,7 @@ package com.judax.oculusmobilesdkheadtracking;
 import java.util.ArrayList;
 
 import android.app.Activity;
+import android.content.ComponentCallbacks2;
 import android.view.Surface;
 import android.view.SurfaceHolder;
 import android.view.SurfaceView;
@@ -20,21 +21,117 @@ import android.view.View;
  * one on top of the other. The view required for the head tracking to work can be occluded by the view of your app.  
  * 2) Add the view as a 1x1 pixel size view using the corresponding layout parameters. Not recommended as at least one
  * pixel of you application will be used by this view. Not a perfect solution but works
+ * Several instances can be used at the same time in the same process (for example, one per component that needs the
+ * head tracking). They all share a single native head tracking session, which is only started for the first one and
+ * stopped with the last one. It is resumed while any of them is resumed and it only needs the view of one of them
+ * to be in the view hierarchy. Each instance keeps its own data, sampling rate and sample history cursor; the rest of
+ * the configuration is shared by all of them.
+ * Applications that only want the head tracking (and do not render with the Oculus Mobile SDK) should use the
+ * tracking-only mode (see start(Activity, boolean)), which keeps the graphics resources to the minimum the SDK needs.
  * 
  * @author JudaX
  *
  */
 public class OculusMobileSDKHeadTracking
 {
+	static
+	{
+		System.loadLibrary("OculusMobileSDKHeadTracking");
+	}
+	
 	private SurfaceView surfaceView;
 	private SurfaceHolder surfaceHolder;
 	private long nativeObjectPtr;
 	private SurfaceHolderCallback surfaceHolderCallback = new SurfaceHolderCallback();
 	private ArrayList<OculusMobileSDKHeadTrackingListener> oculusMobileSDKHeadTrackingListeners = new ArrayList<OculusMobileSDKHeadTrackingListener>();
 
+	/**
+	 * getData(int) field set: all the fields of OculusMobileSDKHeadTrackingData (same as getData()).
+	 */
+	public static final int DATA_FIELDS_FULL = 0;
+	/**
+	 * getData(int) field set: only the timeStamp and the orientation are updated.
+	 */
+	public static final int DATA_FIELDS_ORIENTATION = 1;
+	/**
+	 * getData(int) field set: the timeStamp, the orientation and the linear and angular velocities are updated.
+	 */
+	public static final int DATA_FIELDS_ORIENTATION_AND_VELOCITY = 2;
+	/**
+	 * setThreadConfiguration/getThreadTelemetry thread: the native thread that owns the VR mode.
+	 */
+	public static final int TRACKING_THREAD = 0;
+	/**
+	 * setThreadConfiguration/getThreadTelemetry thread: the native sampling thread (see setSamplingRate).
+	 */
+	public static final int SAMPLER_THREAD = 1;
+	/**
+	 * setDataListener deliveries per second: deliver on every refresh of the display, paced by the predicted display
+	 * times while in VR mode.
+	 */
+	public static final int DATA_DELIVERY_DISPLAY_REFRESH = -1;
+	/**
+	 * getVrModeState state: the native session has no window surface.
+	 */
+	public static final int VR_MODE_STATE_IDLE = 0;
+	/**
+	 * getVrModeState state: the window surface is created but the native session is not in VR mode.
+	 */
+	public static final int VR_MODE_STATE_SURFACE = 1;
+	/**
+	 * getVrModeState state: in VR mode, the head tracking is available.
+	 */
+	public static final int VR_MODE_STATE_VR_MODE = 2;
+	/**
+	 * getVrModeState state: still in VR mode but paused, see setWarmResumeGracePeriod.
+	 */
+	public static final int VR_MODE_STATE_SUSPENDED = 3;
+	/**
+	 * The number of VR_MODE_STATE_* states.
+	 */
+	public static final int VR_MODE_STATE_COUNT = 4;
+	/**
+	 * playPoseReplay speed: every pose query gets the next recorded pose, whatever the time.
+	 */
+	public static final float POSE_REPLAY_AS_FAST_AS_POSSIBLE = 0.0f;
+	/**
+	 * readPoseDoubleColumn columns (as in PoseColumns.h): the pose time and the prediction, in seconds.
+	 */
+	public static final int POSE_COLUMN_POSE_TIME = 1;
+	public static final int POSE_COLUMN_PREDICTION = 2;
+	/**
+	 * readPoseColumn columns (as in PoseColumns.h): the components of the orientation quaternion, of the position, of the
+	 * angular and linear velocities and of the angular and linear accelerations.
+	 */
+	public static final int POSE_COLUMN_ORIENTATION_X = 3;
+	public static final int POSE_COLUMN_ORIENTATION_Y = 4;
+	public static final int POSE_COLUMN_ORIENTATION_Z = 5;
+	public static final int POSE_COLUMN_ORIENTATION_W = 6;
+	public static final int POSE_COLUMN_POSITION_X = 7;
+	public static final int POSE_COLUMN_POSITION_Y = 8;
+	public static final int POSE_COLUMN_POSITION_Z = 9;
+	public static final int POSE_COLUMN_ANGULAR_VELOCITY_X = 10;
+	public static final int POSE_COLUMN_ANGULAR_VELOCITY_Y = 11;
+	public static final int POSE_COLUMN_ANGULAR_VELOCITY_Z = 12;
+	public static final int POSE_COLUMN_LINEAR_VELOCITY_X = 13;
+	public static final int POSE_COLUMN_LINEAR_VELOCITY_Y = 14;
+	public static final int POSE_COLUMN_LINEAR_VELOCITY_Z = 15;
+	public static final int POSE_COLUMN_ANGULAR_ACCELERATION_X = 16;
+	public static final int POSE_COLUMN_ANGULAR_ACCELERATION_Y = 17;
+	public static final int POSE_COLUMN_ANGULAR_ACCELERATION_Z = 18;
+	public static final int POSE_COLUMN_LINEAR_ACCELERATION_X = 19;
+	public static final int POSE_COLUMN_LINEAR_ACCELERATION_Y = 20;
+	public static final int POSE_COLUMN_LINEAR_ACCELERATION_Z = 21;
+	
+	private static final int PREDICTION_ACCURACY_FLOATS_PER_BUCKET = 5;
+	// The size of the window buffers in tracking-only mode (landscape, as the SDK expects).
+	private static final int TRACKING_ONLY_SURFACE_WIDTH = 64;
+	private static final int TRACKING_ONLY_SURFACE_HEIGHT = 32;
+
 	private boolean started = false;
 	private String errorMessage = "";
 	private OculusMobileSDKHeadTrackingData data = new OculusMobileSDKHeadTrackingData();
+	private OculusMobileSDKHeadTrackingData[] dataPool = null;
 	
 	/**
 	 * Call this method to initialize the Oculus mobile head tracking.
@@ -43,14 +140,33 @@ public class OculusMobileSDKHeadTracking
 	 */
 	public void start(Activity activity)
 	{
-		System.loadLibrary("OculusMobileSDKHeadTracking");
-
+		start(activity, false);
+	}
+	
+	/**
+	 * Call this method to initialize the Oculus mobile head tracking, optionally in tracking-only mode. The Oculus
+	 * mobile SDK cannot enter VR mode without an EGL context and a window surface, so the view is still needed, but in
+	 * tracking-only mode its buffers are a few pixels instead of the size of the display (so the memory they take and the
+	 * timewarp the SDK does on them every vsync are negligible), the offscreen surface is 1x1 and the lowest CPU and GPU
+	 * levels are requested. Nothing rendered to the view would be visible. As the native session is shared, the mode
+	 * is decided by the first instance started in the process. See getGraphicsFootprint to compare both modes.
+	 * @throws IllegalStateException if the Oculus mobile SDK could not be initialized.
+	 * @param activity The activity where the head tracking will be executed on.
+	 * @param trackingOnly Whether to use the tracking-only mode.
+	 */
+	public void start(Activity activity, boolean trackingOnly)
+	{
 		// Create the surface and listen to it's holder's states
 		surfaceView = new SurfaceView(activity);
 		surfaceView.getHolder().addCallback(surfaceHolderCallback);
+		if (trackingOnly)
+		{
+			// The buffers are scaled to the view, whatever its size in the layout
+			surfaceView.getHolder().setFixedSize(TRACKING_ONLY_SURFACE_WIDTH, TRACKING_ONLY_SURFACE_HEIGHT);
+		}
 
 		// Call the native side so it is initialized and so it returns the pointer to the main C++ object
-		nativeObjectPtr = nativeStart(activity, this, data);
+		nativeObjectPtr = nativeStart(activity, this, data, trackingOnly);
 		if (nativeObjectPtr == 0)
 		{
 			throw new IllegalStateException("The native corresponding object could not be instantiated to handle the Oculus Mobile SDK Head Tracking.");
@@ -123,6 +239,596 @@ public class OculusMobileSDKHeadTracking
 		nativeGetData(nativeObjectPtr);
 		return data;
 	}
+	
+	/**
+	 * Only updates a subset of the head tracking data. The rest of the fields keep their previous values.
+	 * Each field set has its own specialized native implementation so the values that are not needed are neither
+	 * computed nor transferred.
+	 * @param fieldSet One of DATA_FIELDS_FULL, DATA_FIELDS_ORIENTATION or DATA_FIELDS_ORIENTATION_AND_VELOCITY.
+	 * @return the current head tracking data.
+	 */
+	public OculusMobileSDKHeadTrackingData getData(int fieldSet)
+	{
+		switch (fieldSet)
+		{
+			case DATA_FIELDS_ORIENTATION:
+				nativeGetOrientationData(nativeObjectPtr);
+				break;
+			case DATA_FIELDS_ORIENTATION_AND_VELOCITY:
+				nativeGetOrientationAndVelocityData(nativeObjectPtr);
+				break;
+			case DATA_FIELDS_FULL:
+				nativeGetData(nativeObjectPtr);
+				break;
+			default:
+				throw new IllegalArgumentException("Unknown field set " + fieldSet + ".");
+		}
+		return data;
+	}
+
+	/**
+	 * Enables or disables the evaluation of the head tracking predictions. While enabled, every prediction returned by
+	 * getData is later compared with the orientation observed at the predicted time. Enabling it resets the statistics.
+	 * It adds a sensor reading per getData call so it is disabled by default.
+	 * @param enabled true to start evaluating the predictions, false to stop.
+	 */
+	public void setPredictionAccuracyEnabled(boolean enabled)
+	{
+		nativeSetPredictionAccuracyEnabled(nativeObjectPtr, enabled);
+	}
+	
+	/**
+	 * @return the angular error distribution (p50/p95/p99) per prediction horizon accumulated since the prediction accuracy was enabled.
+	 */
+	public OculusMobileSDKHeadTrackingPredictionAccuracy getPredictionAccuracy()
+	{
+		int bucketCount = nativeGetPredictionAccuracyBucketCount();
+		float[] statistics = new float[bucketCount * PREDICTION_ACCURACY_FLOATS_PER_BUCKET];
+		nativeGetPredictionAccuracy(nativeObjectPtr, statistics);
+		return new OculusMobileSDKHeadTrackingPredictionAccuracy(statistics, bucketCount);
+	}
+
+	/**
+	 * Starts (or stops) a native thread that samples the head tracking at a fixed rate, independently of how
+	 * often (and from which thread) getData is called. While it runs, the late latched poses are based on its newest
+	 * sample (and getData too if setSampledPredictionEnabled is set). The sampling period is paced against absolute deadlines, see getSamplingStatistics.
+	 * The shared session samples at the highest rate requested by any of the instances.
+	 * @param samplesPerSecond The sampling rate (for example 500 or 1000). 0 stops the sampling thread (the default).
+	 */
+	public void setSamplingRate(int samplesPerSecond)
+	{
+		nativeSetSamplingRate(nativeObjectPtr, samplesPerSecond);
+	}
+	
+	/**
+	 * While the sampling thread runs (see setSamplingRate), makes getData re-predict its newest sample (at most one
+	 * sampling period old) to the display time with constant velocities instead of asking the Oculus Mobile SDK for a
+	 * prediction. It is cheaper to call but it is a different prediction: compare both with getPredictionAccuracy.
+	 * @param enabled false (the default) keeps getData on the predictions of the Oculus Mobile SDK.
+	 */
+	public void setSampledPredictionEnabled(boolean enabled)
+	{
+		nativeSetSampledPredictionEnabled(nativeObjectPtr, enabled);
+	}
+	
+	/**
+	 * Statistics of the sampling thread since its rate was last set. The jitter is the delay between each sampling
+	 * deadline and the moment the thread actually woke up.
+	 * @return { samples, mean jitter (microseconds), p99 jitter (microseconds), max jitter (microseconds), missed deadlines }
+	 */
+	public float[] getSamplingStatistics()
+	{
+		float[] statistics = new float[5];
+		nativeGetSamplingStatistics(nativeObjectPtr, statistics);
+		return statistics;
+	}
+	
+	/**
+	 * Keeps the VR mode alive for a while after a pause, so a brief interruption (a dialog, the notification shade)
+	 * does not cost leaving and entering the VR mode again. If the head tracking is resumed within the grace period with
+	 * the same surface, it resumes right away; otherwise the VR mode is left once the period is over (or as soon as the
+	 * surface is destroyed). The sampling thread is stopped in the meantime.
+	 * @param seconds The grace period. 0 (the default) leaves the VR mode as soon as the head tracking is paused.
+	 */
+	public void setWarmResumeGracePeriod(float seconds)
+	{
+		nativeSetWarmResumeGracePeriod(nativeObjectPtr, seconds);
+	}
+	
+	/**
+	 * How long it took to have poses again after each resume, from the moment the native side handled it. Warm resumes
+	 * found the VR mode suspended (see setWarmResumeGracePeriod), cold ones had to enter it again (which includes waiting
+	 * for the surface).
+	 * @return { warm resumes, mean warm latency (ms), last warm latency (ms), cold resumes, mean cold latency (ms), last cold latency (ms) }
+	 */
+	public float[] getResumeStatistics()
+	{
+		float[] statistics = new float[6];
+		nativeGetResumeStatistics(nativeObjectPtr, statistics);
+		return statistics;
+	}
+	
+	/**
+	 * The state of the native session, one of the VR_MODE_STATE_* constants. It only changes when the lifecycle of the
+	 * instances sharing the session (resume, pause, surface created or destroyed) requires a different one, so for
+	 * example a surface that only changes its size does not make the session leave and enter VR mode again.
+	 * @return the VR_MODE_STATE_* the native session is in.
+	 */
+	public int getVrModeState()
+	{
+		return nativeGetVrModeState(nativeObjectPtr);
+	}
+	
+	/**
+	 * The transitions the native session made between its states since it started (see getVrModeState). Only the
+	 * transitions between neighbour states are made (IDLE - SURFACE - VR_MODE - SUSPENDED, and SUSPENDED - SURFACE) so the
+	 * others are always 0.
+	 * @return for each transition (from * VR_MODE_STATE_COUNT + to): { count, mean duration (ms), max duration (ms) }
+	 */
+	public float[] getVrModeTransitions()
+	{
+		float[] statistics = new float[VR_MODE_STATE_COUNT * VR_MODE_STATE_COUNT * 3];
+		nativeGetVrModeTransitions(nativeObjectPtr, statistics);
+		return statistics;
+	}
+	
+	/**
+	 * What the graphics state of the native session costs, to compare the tracking-only mode (see start(Activity, boolean))
+	 * with the default one. The window surface is 0x0 while there is none. The black frames are the ones submitted to
+	 * hand the CPU and GPU levels to the Oculus Mobile SDK (nothing else is rendered); their submit time is the GPU driver
+	 * overhead of the session. The startup time of each mode can be compared with getStartupTimeline.
+	 * @return { tracking only (1 or 0), window surface width, window surface height, window surface KB per buffer, offscreen surface width, offscreen surface height, CPU level, GPU level, black frames submitted, mean black frame submit (microseconds) }
+	 */
+	public float[] getGraphicsFootprint()
+	{
+		float[] statistics = new float[10];
+		nativeGetGraphicsFootprint(nativeObjectPtr, statistics);
+		return statistics;
+	}
+	
+	/**
+	 * Records every pose sampled by the native session (see setSamplingRate, nothing is recorded while not sampling) to
+	 * binary files named pathPrefix.<index>.ovrpose. Each file is a 64 byte header followed by fixed-size 128 byte records
+	 * (monotonic time in nanoseconds, pose time, prediction, orientation, position, velocities, accelerations, tracking
+	 * status, mounted/docked flags and a sequence number), see PoseRecorder.h for the exact layout. The files are created
+	 * and mapped in memory ahead of time so recording a pose costs the sampling thread a copy only. When a file is full the
+	 * next one is used and only the last maxFiles full ones are kept (besides the one being written and the next one).
+	 * Poses are dropped (see getPoseRecorderStatistics) if the next file is not ready in time. Any recording in progress
+	 * is stopped first.
+	 * @param pathPrefix The path of the files without the index and extension, in a directory the app can write to.
+	 * @param fileSize The size of each file in bytes (at least 64 KB). 4 MB hold about 32000 poses.
+	 * @param maxFiles How many full files to keep, the older ones are deleted. 0 keeps them all.
+	 * @return true if the recording started, false if the first file could not be created.
+	 */
+	public boolean startPoseRecording(String pathPrefix, int fileSize, int maxFiles)
+	{
+		return nativeStartPoseRecording(nativeObjectPtr, pathPrefix, fileSize, maxFiles);
+	}
+	
+	/**
+	 * Stops the pose recording (see startPoseRecording) and closes its files. The recording is also stopped when the
+	 * native session stops.
+	 */
+	public void stopPoseRecording()
+	{
+		nativeStopPoseRecording(nativeObjectPtr);
+	}
+	
+	/**
+	 * @return { poses recorded, poses dropped (the next file was not ready), files completed, MB written, files that could not be created, recording (1 or 0) }
+	 */
+	public float[] getPoseRecorderStatistics()
+	{
+		float[] statistics = new float[6];
+		nativeGetPoseRecorderStatistics(nativeObjectPtr, statistics);
+		return statistics;
+	}
+	
+	/**
+	 * The native session always keeps the last 8192 poses it handed out or sampled (getData, the data listener and the
+	 * sampling thread: about 8 seconds with sampling at 1 kHz) and the last 1024 events it went through (start and
+	 * stop, lifecycle messages, VR mode transitions with their duration, mounted/docked and performance governor
+	 * changes, errors). Recording them costs a copy of each pose, so it is left enabled. With a dump path set they are
+	 * written as text to pathPrefix.error.txt when an error happens (as reported to headTrackingError) and to
+	 * pathPrefix.stop.txt when the native session stops, from a worker thread. They are also kept in the
+	 * pathPrefix.flight file instead of memory while the path is set, so they survive the process: if it dies without
+	 * stopping the native session (a crash, a kill) the next one to set the same path writes them to
+	 * pathPrefix.previous.txt. Not from the UI thread for that reason. See also dumpFlightRecorder.
+	 * @param pathPrefix The path of the files without the reason and extension, in a directory the app can write to.
+	 * null to not write them (the default).
+	 */
+	public void setFlightRecorderDumpPath(String pathPrefix)
+	{
+		nativeSetFlightRecorderDumpPath(nativeObjectPtr, pathPrefix);
+	}
+	
+	/**
+	 * Writes the poses and events the native session keeps (see setFlightRecorderDumpPath) to a text file
+	 * now, one line per pose or event, oldest first, with its time in seconds relative to the dump. Not from the UI
+	 * thread.
+	 * @param path The file to write.
+	 * @return true if the file was written.
+	 */
+	public boolean dumpFlightRecorder(String path)
+	{
+		return nativeDumpFlightRecorder(nativeObjectPtr, path);
+	}
+	
+	/**
+	 * @return { poses recorded, events recorded, dumps written, dumps that could not be written }
+	 */
+	public float[] getFlightRecorderStatistics()
+	{
+		float[] statistics = new float[4];
+		nativeGetFlightRecorderStatistics(nativeObjectPtr, statistics);
+		return statistics;
+	}
+	
+	/**
+	 * Loads a recording made with startPoseRecording (every pathPrefix.<index>.ovrpose file) to replay it instead of
+	 * the live head tracking, see playPoseReplay. The replayed poses go through the same path as the live ones (sampling,
+	 * late latching, getData, the data listeners, the pose recorder) so a field recording can be reproduced, also with
+	 * the simulated native backend on Linux without a headset. Any recording loaded before is unloaded first.
+	 * @param pathPrefix The path given to startPoseRecording. null only unloads the current recording.
+	 * @return true if some poses were loaded.
+	 */
+	public boolean loadPoseReplay(String pathPrefix)
+	{
+		return nativeLoadPoseReplay(nativeObjectPtr, pathPrefix);
+	}
+	
+	/**
+	 * Replays the recording loaded with loadPoseReplay from the current position (the start, where it was paused or
+	 * where it was moved to with seekPoseReplay). The pose returned for a time is the last recorded one at or before the
+	 * matching time of the recording.
+	 * @param speed 1 plays in real time, any other positive value faster or slower (the velocities and accelerations are
+	 * scaled too). POSE_REPLAY_AS_FAST_AS_POSSIBLE gives the next recorded pose to every sample and every getData call,
+	 * so the same queries always get the same poses. The data listeners get the last pose handed out and don't move the
+	 * replay forward.
+	 * @param loop Whether to start over when the end is reached, otherwise the last pose is kept.
+	 */
+	public void playPoseReplay(float speed, boolean loop)
+	{
+		nativePlayPoseReplay(nativeObjectPtr, speed, loop);
+	}
+	
+	/**
+	 * Stops replaying (the live head tracking is used again) and keeps the position, see playPoseReplay.
+	 */
+	public void pausePoseReplay()
+	{
+		nativePausePoseReplay(nativeObjectPtr);
+	}
+	
+	/**
+	 * Moves the replay to a time of the recording.
+	 * @param seconds From the first pose of the recording.
+	 */
+	public void seekPoseReplay(double seconds)
+	{
+		nativeSeekPoseReplay(nativeObjectPtr, seconds);
+	}
+	
+	/**
+	 * @return { poses loaded, duration (seconds), playing (1 or 0), position (seconds), loops, poses replayed }
+	 */
+	public float[] getPoseReplayStatistics()
+	{
+		float[] statistics = new float[6];
+		nativeGetPoseReplayStatistics(nativeObjectPtr, statistics);
+		return statistics;
+	}
+	
+	/**
+	 * Compresses a recording made with startPoseRecording into a single pathPrefix.ovrposez file, which loadPoseReplay
+	 * reads when the original files are not there anymore. Every value is quantized to fixed point within the given
+	 * errors and encoded as the difference with the previous pose (see PoseCodec.h): a recording of realistic head
+	 * motion at 1 kHz takes 6 to 9 times less space than the original with errors from 0.5 to 4 times the defaults.
+	 * Can be called at any time, even without a started head tracking. Not from the UI thread for long recordings.
+	 * @param pathPrefix The path given to startPoseRecording.
+	 * @param orientationError Max error of the quaternion components (0.0001 by default, about 0.06 degrees).
+	 * @param positionError Max error of the positions in meters (0.0001 by default).
+	 * @param velocityError Max error of the angular (rad/s) and linear (m/s) velocities (0.001 by default).
+	 * @param accelerationError Max error of the angular (rad/s^2) and linear (m/s^2) accelerations (0.01 by default).
+	 * @param keyframeInterval Poses between the ones encoded on their own (1000 by default).
+	 * @return the size of the compressed file in bytes, 0 if the recording could not be read or the file written.
+	 */
+	public static long compressPoseRecording(String pathPrefix, float orientationError, float positionError, float velocityError, float accelerationError, int keyframeInterval)
+	{
+		return nativeCompressPoseRecording(pathPrefix, orientationError, positionError, velocityError, accelerationError, keyframeInterval);
+	}
+	
+	/**
+	 * Writes a recording made with startPoseRecording as a single columnar pathPrefix.ovrposec file (see PoseColumns.h):
+	 * chunks of poses that store every value as its own array, with the time range of every chunk in an index at the end
+	 * of the file. readPoseColumn reads a time window of one value from it without going through the rest of the file,
+	 * and loadPoseReplay reads it when the original files are not there anymore.
+	 * Can be called at any time, even without a started head tracking. Not from the UI thread for long recordings.
+	 * @param pathPrefix The path given to startPoseRecording.
+	 * @param chunkSize Poses per chunk (4096 if 0 or less). Smaller chunks make smaller windows cheaper to find.
+	 * @return the size of the file in bytes, 0 if the recording could not be read or the file written.
+	 */
+	public static long convertPoseRecordingToColumns(String pathPrefix, int chunkSize)
+	{
+		return nativeConvertPoseRecordingToColumns(pathPrefix, chunkSize);
+	}
+	
+	/**
+	 * Reads one value of the poses of a time window from a file written by convertPoseRecordingToColumns. The file is
+	 * memory-mapped and only the chunks of the window are touched. The last file read stays mapped, so reading more
+	 * windows or columns of it does not open it again.
+	 * Can be called at any time, even without a started head tracking.
+	 * @param pathPrefix The path given to convertPoseRecordingToColumns.
+	 * @param column One of the POSE_COLUMN_* constants.
+	 * @param startTime The first pose time of the window (in seconds, as the recorded pose times).
+	 * @param endTime The last pose time of the window (included).
+	 * @return the value of every pose in the window, in time order, or null if the file could not be read or the column
+	 * is not valid.
+	 */
+	public static float[] readPoseColumn(String pathPrefix, int column, double startTime, double endTime)
+	{
+		return nativeReadPoseColumn(pathPrefix, column, startTime, endTime);
+	}
+	
+	/**
+	 * The same as readPoseColumn for the columns of doubles: the pose times of the window (to go with the values
+	 * readPoseColumn returns for it) or their predictions.
+	 * @param pathPrefix The path given to convertPoseRecordingToColumns.
+	 * @param column POSE_COLUMN_POSE_TIME or POSE_COLUMN_PREDICTION.
+	 * @param startTime The first pose time of the window (in seconds, as the recorded pose times).
+	 * @param endTime The last pose time of the window (included).
+	 * @return the value of every pose in the window, in time order, or null if the file could not be read or the column
+	 * is not valid.
+	 */
+	public static double[] readPoseDoubleColumn(String pathPrefix, int column, double startTime, double endTime)
+	{
+		return nativeReadPoseDoubleColumn(pathPrefix, column, startTime, endTime);
+	}
+	
+	/**
+	 * When each phase of the startup of the native session was reached, to see where the time to the first pose goes.
+	 * The EGL context is created in parallel with the initialization of the Oculus Mobile SDK and start() does not wait
+	 * for either of them, so the phases do not necessarily follow each other.
+	 * @return the seconds since start() was called (-1 for the phases not reached yet) for: { start, tracking thread created, JNI cached (start returned), system activities initialized, Oculus Mobile SDK initialized, EGL context created, tracking thread ready, VR mode entered, first pose }
+	 */
+	public double[] getStartupTimeline()
+	{
+		double[] timeline = new double[9];
+		nativeGetStartupTimeline(nativeObjectPtr, timeline);
+		return timeline;
+	}
+	
+	/**
+	 * When the native session stops, its EGL display, context and offscreen surface are kept so the next start (of any
+	 * instance) does not have to create them again. This releases them right away.
+	 * @return true if there were resources kept to release.
+	 */
+	public static boolean releaseEglResources()
+	{
+		return nativeReleaseEglResources();
+	}
+	
+	/**
+	 * Call this method from the Activity (or Application) onTrimMemory so the EGL resources kept between sessions (see
+	 * releaseEglResources) are released when the system runs low on memory or the application goes to the background.
+	 * @param level The level passed to onTrimMemory.
+	 */
+	public static void trimMemory(int level)
+	{
+		if (level >= ComponentCallbacks2.TRIM_MEMORY_RUNNING_LOW)
+		{
+			releaseEglResources();
+		}
+	}
+	
+	/**
+	 * The EGL config used by the native session is found by scanning all the configs of the driver once per process and
+	 * then remembered. With a cache file, it is also remembered across processes (for the same device build and EGL
+	 * driver), so only the very first start pays for the scan. A remembered config is checked before it is used and
+	 * the scan is done again if it is not valid anymore. Call it before start(), for example with
+	 * new File(activity.getCacheDir(), "egl_config").getAbsolutePath().
+	 * @param path The file to keep the config in. null only keeps it in memory (the default).
+	 */
+	public static void setEglConfigCacheFile(String path)
+	{
+		nativeSetEglConfigCacheFile(path);
+	}
+	
+	/**
+	 * How the EGL config was selected in this process (see setEglConfigCacheFile), to compare the time of a remembered
+	 * selection with the time of a full scan.
+	 * @return { remembered in memory, remembered on disk, scans, remembered configs that were not valid anymore, mean remembered selection (microseconds), mean scan (microseconds) }
+	 */
+	public static float[] getEglConfigCacheStatistics()
+	{
+		float[] statistics = new float[6];
+		nativeGetEglConfigCacheStatistics(statistics);
+		return statistics;
+	}
+	
+	/**
+	 * How long the slow native calls took during the last (at most 8) lifecycles of the native session, from its start
+	 * to its stop, oldest first. They are kept for the whole process so they can also be read after stop(). The phases are,
+	 * in order: JNI caching, tracking thread creation, system activities initialization, Oculus Mobile SDK initialization,
+	 * EGL context creation, EGL surface creation, VR mode enter, VR mode leave, EGL surface destruction, EGL context
+	 * release (kept for the next session), Oculus Mobile SDK shutdown and tracking thread join.
+	 * The timers can be built out of the native library (LIFECYCLE_PROFILER_ENABLED=0), the array is empty then.
+	 * @return 3 values per phase (12 phases per lifecycle): { times, total (ms), max (ms) }
+	 */
+	public static double[] getLifecycleProfile()
+	{
+		return nativeGetLifecycleProfile();
+	}
+	
+	/**
+	 * Statistics of the native worker threads that do the work that does not need to be done right away (logging) on
+	 * behalf of the tracking and sampling threads. The latency is the time a task waited in the queue. Tasks submitted
+	 * while the queue is full are rejected (dropped) instead of blocking the thread that submits them.
+	 * @return { submitted tasks, executed tasks, rejected tasks, queue depth, max queue depth, mean latency (microseconds), max latency (microseconds) }
+	 */
+	public float[] getWorkerPoolStatistics()
+	{
+		float[] statistics = new float[7];
+		nativeGetWorkerPoolStatistics(nativeObjectPtr, statistics);
+		return statistics;
+	}
+	
+	/**
+	 * Reads the samples taken by the sampling thread (see setSamplingRate) since the last call on this instance. Each instance
+	 * has its own cursor in the (1024 samples) history so several consumers can read all the samples independently.
+	 * If this instance falls further behind than the history size, the oldest samples are skipped.
+	 * @param samples The array to store the samples in, 5 values per sample: { timeStamp, orientationX, orientationY, orientationZ, orientationW }
+	 * @return the number of samples stored.
+	 */
+	public int readSamples(double[] samples)
+	{
+		return nativeReadSamples(nativeObjectPtr, samples);
+	}
+	
+	/**
+	 * Pushes the head tracking data to a listener from a native thread at a fixed rate, instead of having to call
+	 * getData. The data objects are preallocated and recycled, so nothing is allocated per delivery: the data passed
+	 * to the listener is only valid during the call. The deliveries carry the prediction for the next frame but do not
+	 * count as frames themselves: they do not advance it nor feed the adaptive horizon.
+	 * @param listener The listener to deliver the data to. null stops the delivery (the default).
+	 * @param deliveriesPerSecond How many times per second to deliver the data, or DATA_DELIVERY_DISPLAY_REFRESH.
+	 */
+	public void setDataListener(OculusMobileSDKHeadTrackingDataListener listener, int deliveriesPerSecond)
+	{
+		if (listener != null && dataPool == null)
+		{
+			dataPool = new OculusMobileSDKHeadTrackingData[nativeGetDataPoolSize()];
+			for (int i = 0; i < dataPool.length; i++)
+			{
+				dataPool[i] = new OculusMobileSDKHeadTrackingData();
+			}
+		}
+		nativeSetDataListener(nativeObjectPtr, listener, deliveriesPerSecond, dataPool);
+	}
+	
+	/**
+	 * Enables or disables the adaptive prediction horizon. By default, getData predicts the head pose for the time
+	 * the Oculus Mobile SDK expects the next frame to be displayed. When enabled, the horizon is derived instead from
+	 * the measured latencies: the time between each getData call and the following frameSubmitted call plus the
+	 * timewarp latency reported by the Oculus Mobile SDK (or its render latency if frameSubmitted is never called).
+	 * @param enabled true to adapt the prediction horizon to the measured latencies, false to use the default one.
+	 */
+	public void setAdaptivePredictionHorizonEnabled(boolean enabled)
+	{
+		nativeSetAdaptivePredictionHorizonEnabled(nativeObjectPtr, enabled);
+	}
+	
+	/**
+	 * Call this method right after the frame rendered using the last getData values has been submitted.
+	 * It feeds the adaptive prediction horizon with the real query-to-submit time of the application.
+	 */
+	public void frameSubmitted()
+	{
+		nativeFrameSubmitted(nativeObjectPtr);
+	}
+	
+	/**
+	 * Diagnostics of the prediction horizon. All the values are in seconds.
+	 * @return { horizon used by the last getData call, adaptive horizon, smoothed query-to-submit time, smoothed render latency, smoothed timewarp latency }
+	 */
+	public float[] getPredictionHorizon()
+	{
+		float[] statistics = new float[5];
+		nativeGetPredictionHorizon(nativeObjectPtr, statistics);
+		return statistics;
+	}
+	
+	/**
+	 * @return the current absolute time in seconds, in the same time base as OculusMobileSDKHeadTrackingData.timeStamp.
+	 */
+	public static double getTimeInSeconds()
+	{
+		return nativeGetTimeInSeconds();
+	}
+	
+	/**
+	 * Re-predicts the pose returned by the last getData call to a later time using its velocities and accelerations.
+	 * It is much cheaper than a new getData call so it can be called right before the frame is submitted.
+	 * @param targetTime The absolute time (same time base as OculusMobileSDKHeadTrackingData.timeStamp) to predict the pose for.
+	 * @param pose An array of at least 7 floats where the orientation (x, y, z, w) and the position (x, y, z) will be stored.
+	 * @return true if the pose could be predicted, false if there is no data yet.
+	 */
+	public boolean getLateLatchedPose(double targetTime, float[] pose)
+	{
+		return nativeGetLateLatchedPose(nativeObjectPtr, targetTime, pose);
+	}
+
+	/**
+	 * Returns the rotation between the orientation returned by the last getData call and the orientation predicted for a later time.
+	 * @param targetTime The absolute time (same time base as OculusMobileSDKHeadTrackingData.timeStamp) to predict the rotation for.
+	 * @param rotation An array of at least 4 floats where the world space delta rotation quaternion (x, y, z, w) will be stored.
+	 * @return true if the rotation could be predicted, false if there is no data yet.
+	 */
+	public boolean getLateLatchedDeltaRotation(double targetTime, float[] rotation)
+	{
+		return nativeGetLateLatchedDeltaRotation(nativeObjectPtr, targetTime, rotation);
+	}
+	
+	/**
+	 * Configures the CPU affinity and the scheduling of one of the native threads. SCHED_FIFO is usually not allowed
+	 * for applications: in that case the thread raises its own priority as much as it can and asks the Oculus Mobile SDK
+	 * to give it SCHED_FIFO. Use getThreadTelemetry to know what was actually granted.
+	 * @param thread TRACKING_THREAD or SAMPLER_THREAD.
+	 * @param affinityMask Bit i allows the thread to run on CPU i (see getBigCoresAffinityMask). 0 leaves the affinity as it is.
+	 * @param fifoPriority The SCHED_FIFO priority [1, 99]. 0 leaves the scheduling policy as it is.
+	 */
+	public void setThreadConfiguration(int thread, int affinityMask, int fifoPriority)
+	{
+		if (thread != TRACKING_THREAD && thread != SAMPLER_THREAD)
+		{
+			throw new IllegalArgumentException("Unknown thread " + thread + ".");
+		}
+		nativeSetThreadConfiguration(nativeObjectPtr, thread, affinityMask, fifoPriority);
+	}
+	
+	/**
+	 * What one of the native threads was actually granted.
+	 * @param thread TRACKING_THREAD or SAMPLER_THREAD.
+	 * @return { tid, requested affinity mask, granted affinity mask, requested SCHED_FIFO priority, granted policy (0 = SCHED_OTHER, 1 = SCHED_FIFO), granted priority, nice, 1 if SCHED_FIFO was requested through the Oculus Mobile SDK } or null if the thread is not running.
+	 */
+	public int[] getThreadTelemetry(int thread)
+	{
+		if (thread != TRACKING_THREAD && thread != SAMPLER_THREAD)
+		{
+			throw new IllegalArgumentException("Unknown thread " + thread + ".");
+		}
+		int[] telemetry = new int[8];
+		return nativeGetThreadTelemetry(nativeObjectPtr, thread, telemetry) ? telemetry : null;
+	}
+	
+	/**
+	 * @return the affinity mask of the fastest CPU cores of the device (the "big" cores of a big.LITTLE CPU) or 0 if it cannot be determined.
+	 */
+	public static int getBigCoresAffinityMask()
+	{
+		return nativeGetBigCoresAffinityMask();
+	}
+	
+	/**
+	 * Enables or disables the performance governor. While enabled, the thermal status reported by the Oculus Mobile SDK
+	 * is watched and the CPU/GPU clock levels and the sampling rate (see setSamplingRate) are lowered as soon as the device
+	 * warns that it is heating up or throttles, and raised again, one step at a time, once it has cooled down.
+	 * It is disabled by default.
+	 * @param enabled true to enable the governor, false to go back to the default clock levels and the requested sampling rate.
+	 */
+	public void setPerformanceGovernorEnabled(boolean enabled)
+	{
+		nativeSetPerformanceGovernorEnabled(nativeObjectPtr, enabled);
+	}
+	
+	/**
+	 * The last decisions (at most 64) of the performance governor, oldest first.
+	 * @return 6 values per decision: { time (seconds, same time base as getTimeInSeconds), state (0 = nominal, 1 = warning, 2 = throttled, 3 = extremely throttled), thermal warning level, CPU level, GPU level, sampling rate }
+	 */
+	public double[] getPerformanceGovernorDecisions()
+	{
+		return nativeGetPerformanceGovernorDecisions(nativeObjectPtr);
+	}
 
 	private class SurfaceHolderCallback implements SurfaceHolder.Callback
 	{
@@ -247,7 +953,7 @@ public class OculusMobileSDKHeadTracking
 		}
 	}
 	
-	private native long nativeStart(Activity activity, OculusMobileSDKHeadTracking oculusMobileSDKHeadTracking, OculusMobileSDKHeadTrackingData data);
+	private native long nativeStart(Activity activity, OculusMobileSDKHeadTracking oculusMobileSDKHeadTracking, OculusMobileSDKHeadTrackingData data, boolean trackingOnly);
 	private native long nativeResume(long nativeObjectPtr);
 	private native long nativePause(long nativeObjectPtr);
 	private native void nativeStop(long nativeObjectPtr);
@@ -255,4 +961,52 @@ public class OculusMobileSDKHeadTracking
 	private native void nativeSurfaceChanged(long nativeObjectPtr, Surface surface);
 	private native void nativeSurfaceDestroyed(long nativeObjectPtr);
 	private native void nativeGetData(long nativeObjectPtr);
+	private native void nativeGetOrientationData(long nativeObjectPtr);
+	private native void nativeGetOrientationAndVelocityData(long nativeObjectPtr);
+	private native void nativeSetPredictionAccuracyEnabled(long nativeObjectPtr, boolean enabled);
+	private native int nativeGetPredictionAccuracyBucketCount();
+	private native void nativeGetPredictionAccuracy(long nativeObjectPtr, float[] statistics);
+	private native void nativeSetSamplingRate(long nativeObjectPtr, int samplesPerSecond);
+	private native void nativeSetSampledPredictionEnabled(long nativeObjectPtr, boolean enabled);
+	private native void nativeGetSamplingStatistics(long nativeObjectPtr, float[] statistics);
+	private native void nativeSetWarmResumeGracePeriod(long nativeObjectPtr, float seconds);
+	private native void nativeGetResumeStatistics(long nativeObjectPtr, float[] statistics);
+	private native void nativeGetStartupTimeline(long nativeObjectPtr, double[] timeline);
+	private native void nativeGetGraphicsFootprint(long nativeObjectPtr, float[] statistics);
+	private native int nativeGetVrModeState(long nativeObjectPtr);
+	private native void nativeGetVrModeTransitions(long nativeObjectPtr, float[] statistics);
+	private native boolean nativeStartPoseRecording(long nativeObjectPtr, String pathPrefix, int fileSize, int maxFiles);
+	private native void nativeStopPoseRecording(long nativeObjectPtr);
+	private native void nativeGetPoseRecorderStatistics(long nativeObjectPtr, float[] statistics);
+	private native void nativeSetFlightRecorderDumpPath(long nativeObjectPtr, String pathPrefix);
+	private native boolean nativeDumpFlightRecorder(long nativeObjectPtr, String path);
+	private native void nativeGetFlightRecorderStatistics(long nativeObjectPtr, float[] statistics);
+	private native boolean nativeLoadPoseReplay(long nativeObjectPtr, String pathPrefix);
+	private native void nativePlayPoseReplay(long nativeObjectPtr, float speed, boolean loop);
+	private native void nativePausePoseReplay(long nativeObjectPtr);
+	private native void nativeSeekPoseReplay(long nativeObjectPtr, double seconds);
+	private native void nativeGetPoseReplayStatistics(long nativeObjectPtr, float[] statistics);
+	private static native long nativeCompressPoseRecording(String pathPrefix, float orientationError, float positionError, float velocityError, float accelerationError, int keyframeInterval);
+	private static native long nativeConvertPoseRecordingToColumns(String pathPrefix, int chunkSize);
+	private static native float[] nativeReadPoseColumn(String pathPrefix, int column, double startTime, double endTime);
+	private static native double[] nativeReadPoseDoubleColumn(String pathPrefix, int column, double startTime, double endTime);
+	private static native boolean nativeReleaseEglResources();
+	private static native void nativeSetEglConfigCacheFile(String path);
+	private static native void nativeGetEglConfigCacheStatistics(float[] statistics);
+	private static native double[] nativeGetLifecycleProfile();
+	private native void nativeGetWorkerPoolStatistics(long nativeObjectPtr, float[] statistics);
+	private native int nativeReadSamples(long nativeObjectPtr, double[] samples);
+	private native void nativeSetDataListener(long nativeObjectPtr, OculusMobileSDKHeadTrackingDataListener listener, int deliveriesPerSecond, OculusMobileSDKHeadTrackingData[] dataPool);
+	private static native int nativeGetDataPoolSize();
+	private native void nativeSetAdaptivePredictionHorizonEnabled(long nativeObjectPtr, boolean enabled);
+	private native void nativeFrameSubmitted(long nativeObjectPtr);
+	private native void nativeGetPredictionHorizon(long nativeObjectPtr, float[] statistics);
+	private static native double nativeGetTimeInSeconds();
+	private native boolean nativeGetLateLatchedPose(long nativeObjectPtr, double targetTime, float[] pose);
+	private native boolean nativeGetLateLatchedDeltaRotation(long nativeObjectPtr, double targetTime, float[] rotation);
+	private native void nativeSetThreadConfiguration(long nativeObjectPtr, int thread, int affinityMask, int fifoPriority);
+	private native boolean nativeGetThreadTelemetry(long nativeObjectPtr, int thread, int[] telemetry);
+	private static native int nativeGetBigCoresAffinityMask();
+	private native void nativeSetPerformanceGovernorEnabled(long nativeObjectPtr, boolean enabled);
+	private native double[] nativeGetPerformanceGovernorDecisions(long nativeObjectPtr);
 }
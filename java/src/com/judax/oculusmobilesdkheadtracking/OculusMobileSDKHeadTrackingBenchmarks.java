@@ -0,0 +1,146 @@
+package com.judax.oculusmobilesdkheadtracking;
+
+import android.app.Activity;
+
+/**
+ * Micro benchmarks of the native side of the library. They do not need the head tracking to be started
+ * so they can be executed at any time (preferably not from the UI thread as they may take a while).
+ * The results are also written to the log.
+ * 
+ * @author JudaX
+ *
+ */
+public class OculusMobileSDKHeadTrackingBenchmarks
+{
+	static
+	{
+		System.loadLibrary("OculusMobileSDKHeadTracking");
+	}
+	
+	/**
+	 * Compares the batched (structure of arrays) head model against calling vrapi_ApplyHeadModel once per sample.
+	 * @param sampleCount The number of samples in the batch.
+	 * @param iterations How many times the whole batch is processed.
+	 * @return { batched samples per second, vrapi_ApplyHeadModel samples per second, max position difference between both }
+	 */
+	public static double[] benchmarkHeadModel(int sampleCount, int iterations)
+	{
+		double[] results = new double[3];
+		nativeBenchmarkHeadModel(sampleCount, iterations, results);
+		return results;
+	}
+	
+	/**
+	 * Measures what getData pays to safely use the native VR session while the tracking thread may be leaving VR mode.
+	 * @param iterations The number of reads per measurement.
+	 * @param contendingThreads The number of extra threads that keep reading during the contended measurement.
+	 * @return { plain atomic load ns/read, guarded read ns/read, contended guarded read ns/read, VR mode transitions simulated, mean transition wait (microseconds) }
+	 */
+	public static double[] benchmarkGuardedRead(int iterations, int contendingThreads)
+	{
+		double[] results = new double[5];
+		nativeBenchmarkGuardedRead(iterations, contendingThreads, results);
+		return results;
+	}
+	
+	/**
+	 * Measures the pose recorder (see OculusMobileSDKHeadTracking.startPoseRecording) by recording synthetic poses as fast
+	 * as the files can be prepared, which is far more than any sampling rate. The poses dropped because the next file was
+	 * not ready are recorded again. The files are written to pathPrefix.<index>.ovrpose and the last 2 are kept.
+	 * @param pathPrefix The path of the files without the index and extension, in a directory the app can write to.
+	 * @param records How many poses to record.
+	 * @param fileSize The size of each file in bytes.
+	 * @return { poses recorded per second, MB written per second, mean ns per pose recorded (the cost for the sampling thread), max ns per pose recorded, poses dropped and recorded again, files completed }, all 0 if the first file could not be created.
+	 */
+	public static double[] benchmarkPoseRecorder(String pathPrefix, int records, int fileSize)
+	{
+		double[] results = new double[6];
+		nativeBenchmarkPoseRecorder(pathPrefix, records, fileSize, results);
+		return results;
+	}
+	
+	/**
+	 * Measures the pose codec used by OculusMobileSDKHeadTracking.compressPoseRecording on synthetic but realistic head
+	 * motion at 1 kHz (looking around with sampling jitter and sensor noise), checking the errors of the decoded poses.
+	 * @param poseCount The number of poses of the motion.
+	 * @param iterations How many times the motion is encoded and decoded.
+	 * @param errorScale Scales the default error bounds (1 uses them as they are).
+	 * @return { raw bytes per pose, encoded bytes per pose, compression ratio, poses encoded per second, poses decoded per second, max orientation error (degrees), max angular velocity error (rad/s) }
+	 */
+	public static double[] benchmarkPoseCodec(int poseCount, int iterations, float errorScale)
+	{
+		double[] results = new double[7];
+		nativeBenchmarkPoseCodec(poseCount, iterations, errorScale, results);
+		return results;
+	}
+	
+	/**
+	 * Measures reading the orientation of the poses of random time windows from the columnar file written by
+	 * OculusMobileSDKHeadTracking.convertPoseRecordingToColumns compared to the same poses as rows (as startPoseRecording
+	 * writes them), both memory-mapped, on the same synthetic head motion as benchmarkPoseCodec.
+	 * @param pathPrefix The path of the files (deleted afterwards) without the extension, in a directory the app can write to.
+	 * @param poseCount The number of poses of the motion (1 kHz).
+	 * @param windowSeconds The duration of each window.
+	 * @param iterations How many windows are read.
+	 * @return { columnar file MB, row file MB, mean microseconds to find a window in the columnar index, orientations read per second from the columns, orientations read per second from the rows, mean poses per window }, all 0 if the files could not be written.
+	 */
+	public static double[] benchmarkPoseColumns(String pathPrefix, int poseCount, double windowSeconds, int iterations)
+	{
+		double[] results = new double[6];
+		nativeBenchmarkPoseColumns(pathPrefix, poseCount, windowSeconds, iterations, results);
+		return results;
+	}
+	
+	/**
+	 * Measures what keeping the flight recorder of OculusMobileSDKHeadTracking.setFlightRecorderDumpPath on costs: recording
+	 * poses as the sampling thread does, recording events and dumping the full histories to a file.
+	 * @param path The file to dump to (deleted afterwards), in a directory the app can write to.
+	 * @param iterations How many poses and events to record.
+	 * @return { mean ns per pose recorded, mean ns per event recorded, ms to dump the full histories }, all 0 if the file could not be written.
+	 */
+	public static double[] benchmarkFlightRecorder(String path, int iterations)
+	{
+		double[] results = new double[3];
+		nativeBenchmarkFlightRecorder(path, iterations, results);
+		return results;
+	}
+	
+	/**
+	 * Measures the cold start of the native session: it is started (without a surface) and stopped again iterations
+	 * times. Unlike the other benchmarks it initializes the Oculus Mobile SDK, so it should only be run while no head
+	 * tracking is started.
+	 * @param activity The activity to initialize the Oculus Mobile SDK with.
+	 * @param iterations How many times the session is started.
+	 * @return the mean seconds to reach each startup phase, in the same order as OculusMobileSDKHeadTracking.getStartupTimeline (-1 for the phases that were never reached).
+	 */
+	public static double[] benchmarkStartup(Activity activity, int iterations)
+	{
+		double[] results = new double[9];
+		nativeBenchmarkStartup(activity, new OculusMobileSDKHeadTracking(), new OculusMobileSDKHeadTrackingData(), iterations, results);
+		return results;
+	}
+	
+	/**
+	 * Measures what keeping the EGL resources between sessions saves: the resources kept are released first, then the
+	 * native session is started (without a surface) and stopped once cold and iterations more times. As for
+	 * benchmarkStartup, it should only be run while no head tracking is started.
+	 * @param activity The activity to initialize the Oculus Mobile SDK with.
+	 * @param iterations How many restarts to average.
+	 * @return { cold start until the tracking thread is ready (ms), restart until the tracking thread is ready (ms), cold EGL context creation (ms since start), restart EGL context ready (ms since start), restarts that reused the EGL resources }
+	 */
+	public static double[] benchmarkRestart(Activity activity, int iterations)
+	{
+		double[] results = new double[5];
+		nativeBenchmarkRestart(activity, new OculusMobileSDKHeadTracking(), new OculusMobileSDKHeadTrackingData(), iterations, results);
+		return results;
+	}
+	
+	private static native void nativeBenchmarkHeadModel(int sampleCount, int iterations, double[] results);
+	private static native void nativeBenchmarkGuardedRead(int iterations, int contendingThreads, double[] results);
+	private static native boolean nativeBenchmarkPoseRecorder(String pathPrefix, int records, int fileSize, double[] results);
+	private static native void nativeBenchmarkPoseCodec(int poseCount, int iterations, float errorScale, double[] results);
+	private static native boolean nativeBenchmarkPoseColumns(String pathPrefix, int poseCount, double windowSeconds, int iterations, double[] results);
+	private static native boolean nativeBenchmarkFlightRecorder(String path, int iterations, double[] results);
+	private static native void nativeBenchmarkRestart(Activity activity, OculusMobileSDKHeadTracking oculusMobileSDKHeadTracking, OculusMobileSDKHeadTrackingData data, int iterations, double[] results);
+	private static native void nativeBenchmarkStartup(Activity activity, OculusMobileSDKHeadTracking oculusMobileSDKHeadTracking, OculusMobileSDKHeadTrackingData data, int iterations, double[] results);
+}
@@ -0,0 +1,18 @@
+package com.judax.oculusmobilesdkheadtracking;
+
+/**
+ * The interface to be implemented by any class that would like the head tracking data to be pushed to it
+ * instead of polling it with getData.
+ * The calls are made from a native thread, not from the UI thread.
+ * @see OculusMobileSDKHeadTracking#setDataListener(OculusMobileSDKHeadTrackingDataListener, int)
+ * @author ijamardo
+ *
+ */
+public interface OculusMobileSDKHeadTrackingDataListener
+{
+	/**
+	 * The data object is recycled by the following deliveries so it is only valid during this call. Copy
+	 * whatever needs to be kept.
+	 */
+	public void headTrackingData(OculusMobileSDKHeadTracking oculusMobileSDKHeadTracking, OculusMobileSDKHeadTrackingData data);
+}
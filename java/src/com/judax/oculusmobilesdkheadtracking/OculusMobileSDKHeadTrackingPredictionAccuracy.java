@@ -0,0 +1,53 @@
+package com.judax.oculusmobilesdkheadtracking;
+
+/**
+ * The angular error distribution of the head tracking predictions, grouped by how far ahead of time
+ * (horizon) each prediction was made. Each prediction is compared with the orientation that was
+ * actually observed at the predicted time.
+ * All the arrays have the same length, one entry per horizon bucket.
+ * @see OculusMobileSDKHeadTracking#setPredictionAccuracyEnabled(boolean)
+ * @see OculusMobileSDKHeadTracking#getPredictionAccuracy()
+ * @author JudaX
+ *
+ */
+public class OculusMobileSDKHeadTrackingPredictionAccuracy
+{
+	/**
+	 * The upper bound (in milliseconds) of the prediction horizon of each bucket. The last bucket also includes any longer horizon.
+	 */
+	public float[] horizonMilliseconds;
+	/**
+	 * The number of predictions that have been compared in each bucket.
+	 */
+	public int[] sampleCounts;
+	/**
+	 * The median angular error (in degrees) of each bucket.
+	 */
+	public float[] p50ErrorDegrees;
+	/**
+	 * The 95th percentile angular error (in degrees) of each bucket.
+	 */
+	public float[] p95ErrorDegrees;
+	/**
+	 * The 99th percentile angular error (in degrees) of each bucket.
+	 */
+	public float[] p99ErrorDegrees;
+	
+	OculusMobileSDKHeadTrackingPredictionAccuracy(float[] statistics, int bucketCount)
+	{
+		horizonMilliseconds = new float[bucketCount];
+		sampleCounts = new int[bucketCount];
+		p50ErrorDegrees = new float[bucketCount];
+		p95ErrorDegrees = new float[bucketCount];
+		p99ErrorDegrees = new float[bucketCount];
+		int floatsPerBucket = statistics.length / bucketCount;
+		for (int i = 0; i < bucketCount; i++)
+		{
+			horizonMilliseconds[i] = statistics[i * floatsPerBucket];
+			sampleCounts[i] = (int)statistics[i * floatsPerBucket + 1];
+			p50ErrorDegrees[i] = statistics[i * floatsPerBucket + 2];
+			p95ErrorDegrees[i] = statistics[i * floatsPerBucket + 3];
+			p99ErrorDegrees[i] = statistics[i * floatsPerBucket + 4];
+		}
+	}
+}
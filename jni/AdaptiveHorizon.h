@@ -0,0 +1,109 @@
+#ifndef ADAPTIVE_HORIZON_H
+#define ADAPTIVE_HORIZON_H
+
+#include <atomic>
+
+// ================================================================================================
+// AdaptiveHorizon
+// Chooses how far ahead of the query time the head pose should be predicted from what is actually
+// measured instead of assuming the standard vrapi pipeline depth:
+// - the consumer's query-to-submit time (from getData to the moment it reports its frame submitted),
+// - VRAPI_SYS_STATUS_TIMEWARP_LATENCY_MILLISECONDS (from the timewarp sample to scanout) and
+// - VRAPI_SYS_STATUS_RENDER_LATENCY_MILLISECONDS (from the render sample to scanout).
+// If the consumer reports submissions, the horizon is its query-to-submit time plus the timewarp
+// latency, otherwise the render latency. The vrapi statistics are polled at a low rate from the
+// tracking thread (update) so the query path only reads an atomic.
+// ================================================================================================
+class AdaptiveHorizon
+{
+private:
+    static constexpr float SMOOTHING = 0.2f;
+    static constexpr float MAX_HORIZON_SECONDS = 0.1f;
+
+    std::atomic<float> horizon;
+    std::atomic<double> lastQueryTime;
+    std::atomic<long long> queryToSubmitSumNanoseconds;
+    std::atomic<int> queryToSubmitCount;
+    // Smoothed values, in seconds. Only written by update.
+    std::atomic<float> queryToSubmit;
+    std::atomic<float> renderLatency;
+    std::atomic<float> timewarpLatency;
+
+    static float smooth(const float current, const float sample)
+    {
+        return current <= 0.0f ? sample : current + SMOOTHING * (sample - current);
+    }
+
+public:
+    AdaptiveHorizon(): horizon(0.0f), lastQueryTime(0.0), queryToSubmitSumNanoseconds(0), queryToSubmitCount(0), queryToSubmit(0.0f), renderLatency(0.0f), timewarpLatency(0.0f)
+    {
+    }
+
+    void reset()
+    {
+        horizon.store(0.0f);
+        lastQueryTime.store(0.0);
+        queryToSubmitSumNanoseconds.store(0);
+        queryToSubmitCount.store(0);
+        queryToSubmit.store(0.0f);
+        renderLatency.store(0.0f);
+        timewarpLatency.store(0.0f);
+    }
+
+    // The consumer queried a pose at this time (vrapi time base).
+    inline void queried(const double time)
+    {
+        lastQueryTime.store(time, std::memory_order_relaxed);
+    }
+
+    // The consumer submitted the frame rendered with the last queried pose at this time.
+    void submitted(const double time)
+    {
+        const double queryTime = lastQueryTime.load(std::memory_order_relaxed);
+        if (queryTime > 0.0 && time > queryTime)
+        {
+            queryToSubmitSumNanoseconds.fetch_add((long long)((time - queryTime) * 1e9), std::memory_order_relaxed);
+            queryToSubmitCount.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // Called periodically from the tracking thread with the latest vrapi latency statistics.
+    void update(const float renderLatencyMilliseconds, const float timewarpLatencyMilliseconds)
+    {
+        if (renderLatencyMilliseconds > 0.0f)
+        {
+            renderLatency.store(smooth(renderLatency.load(), renderLatencyMilliseconds * 0.001f));
+        }
+        if (timewarpLatencyMilliseconds > 0.0f)
+        {
+            timewarpLatency.store(smooth(timewarpLatency.load(), timewarpLatencyMilliseconds * 0.001f));
+        }
+        const int count = queryToSubmitCount.exchange(0, std::memory_order_relaxed);
+        const long long sum = queryToSubmitSumNanoseconds.exchange(0, std::memory_order_relaxed);
+        if (count > 0)
+        {
+            queryToSubmit.store(smooth(queryToSubmit.load(), (float)((double)sum / count * 1e-9)));
+        }
+
+        float newHorizon = queryToSubmit.load() > 0.0f ? queryToSubmit.load() + timewarpLatency.load() : renderLatency.load();
+        newHorizon = newHorizon > MAX_HORIZON_SECONDS ? MAX_HORIZON_SECONDS : newHorizon;
+        horizon.store(newHorizon, std::memory_order_relaxed);
+    }
+
+    // The prediction horizon in seconds, 0 if nothing has been measured yet.
+    inline float getHorizon() const
+    {
+        return horizon.load(std::memory_order_relaxed);
+    }
+
+    // horizon, query-to-submit, render latency, timewarp latency (all in seconds).
+    void getStatistics(float statistics[4]) const
+    {
+        statistics[0] = horizon.load();
+        statistics[1] = queryToSubmit.load();
+        statistics[2] = renderLatency.load();
+        statistics[3] = timewarpLatency.load();
+    }
+};
+
+#endif // ADAPTIVE_HORIZON_H
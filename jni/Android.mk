@@ -50,8 +50,11 @@ LOCAL_C_INCLUDES := \
 	. \
 	../3rdparty/ovr_sdk_mobile_1.0.3.1/include
 LOCAL_SRC_FILES := \
-	./OculusMobileSDKHeadTracking.cpp 
+	./OculusMobileSDKHeadTracking.cpp \
+	./OculusMobileSDKHeadTrackingBenchmarks.cpp
 LOCAL_CFLAGS := -std=c++11 -Werror 
+# Every Gear VR compatible device supports NEON (used by the batched head model)
+LOCAL_ARM_NEON := true
 LOCAL_SHARED_LIBRARIES := vrapi
 LOCAL_WHOLE_STATIC_LIBRARIES := \
 	openglloader \
@@ -0,0 +1,44 @@
+#ifndef BACKEND_H
+#define BACKEND_H
+
+// ================================================================================================
+// Backend
+// Every platform API the library calls (vrapi, SystemActivities, EGL and the Android NDK) comes from
+// the headers included here, so the backend is chosen at compile time and the call sites do not
+// change. The device build includes the real headers and calls the platform directly (no indirection
+// at all). Defining OVR_HEAD_TRACKING_HOST_BACKEND to 1 builds against HostBackend.h instead: the same
+// functions, implemented by HostBackend.cpp as a deterministic simulation that runs on Linux (see
+// HostBackend.h for how to build and drive it).
+// ================================================================================================
+#ifndef OVR_HEAD_TRACKING_HOST_BACKEND
+#define OVR_HEAD_TRACKING_HOST_BACKEND 0
+#endif
+
+#if OVR_HEAD_TRACKING_HOST_BACKEND == 1
+
+#include "HostBackend.h"
+
+#else
+
+#include <jni.h>
+
+#include <android/native_window_jni.h>	// for native window JNI
+#include <android/input.h>
+#include <android/log.h>
+#include <sys/system_properties.h>
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <GLES3/gl3.h>
+#include <GLES3/gl3ext.h>
+
+#include "VrApi.h"
+#include "VrApi_Helpers.h"
+#include "SystemActivities.h"
+
+// The JNIEnv * JavaVM::AttachCurrentThread stores (a JNIEnv ** on Android, a void ** in the JDK).
+#define BACKEND_JNI_ENV_OUT( env ) ( env )
+
+#endif
+
+#endif // BACKEND_H
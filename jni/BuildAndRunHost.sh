@@ -0,0 +1,10 @@
+# Builds the library with the host backend into the HostDriver program (see HostBackend.h) and runs it.
+# Only needs g++, the Khronos EGL and GLES3 headers and the JNI headers of a JDK (JAVA_HOME), no device.
+echo "Building the host driver..."
+mkdir -p ./objs/host
+if [ $? -ne 0 ];then exit 1;fi
+g++ -std=c++11 -O2 -fno-strict-aliasing -DOVR_HEAD_TRACKING_HOST_BACKEND=1 -I. -I../3rdparty/ovr_sdk_mobile_1.0.3.1/include -I$JAVA_HOME/include -I$JAVA_HOME/include/linux OculusMobileSDKHeadTracking.cpp OculusMobileSDKHeadTrackingBenchmarks.cpp HostBackend.cpp HostDriver.cpp -lpthread -o ./objs/host/HostDriver
+if [ $? -ne 0 ];then exit 1;fi
+echo "Built!"
+echo "Running the host driver..."
+./objs/host/HostDriver "$@"
@@ -0,0 +1,202 @@
+#ifndef EGL_CONFIG_CACHE_H
+#define EGL_CONFIG_CACHE_H
+
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+
+#include <atomic>
+
+// EGL and the system properties
+#include "Backend.h"
+#include "Clock.h"
+
+// ================================================================================================
+// EGL config cache
+// Finding the config for the tracking context means scanning every config the driver exposes (up to
+// 1024) with several eglGetConfigAttrib calls each. The EGL_CONFIG_ID of the config found is kept for
+// the rest of the process and, if a file is set, on disk for the next processes, together with the
+// device build fingerprint and the EGL vendor and version so another device or driver never uses it.
+// A cached id is validated in constant time (eglChooseConfig with only EGL_CONFIG_ID, which ignores
+// every other attribute, so the forced MSAA of the developer options does not get in) by checking
+// the config is still suitable. The scan is only done again if it is not.
+// ================================================================================================
+#ifndef EGL_OPENGL_ES3_BIT_KHR
+#define EGL_OPENGL_ES3_BIT_KHR		0x0040
+#endif
+
+#define EGL_CONFIG_CACHE_PATH_MAX	256
+#define EGL_CONFIG_CACHE_KEY_MAX	256
+
+// memory hits, disk hits, scans, invalidated ids, mean cached selection (us), mean scan (us)
+#define EGL_CONFIG_CACHE_STATISTICS_FLOAT_COUNT 6
+
+static pthread_mutex_t eglConfigCacheMutex = PTHREAD_MUTEX_INITIALIZER;
+// 0 when there is none (config ids are positive).
+static EGLint eglConfigCacheId = 0;
+static char eglConfigCachePath[EGL_CONFIG_CACHE_PATH_MAX] = "";
+
+static std::atomic<int> eglConfigCacheMemoryHits( 0 );
+static std::atomic<int> eglConfigCacheDiskHits( 0 );
+static std::atomic<int> eglConfigCacheScans( 0 );
+static std::atomic<int> eglConfigCacheInvalidations( 0 );
+static std::atomic<long long> eglConfigCacheHitNanoseconds( 0 );
+static std::atomic<long long> eglConfigCacheScanNanoseconds( 0 );
+
+// An RGBA8, no depth, no MSAA, ES3 config that can be used for both window and pbuffer surfaces (so the
+// pbuffer context can share textures with the window one).
+static inline bool ovrEglConfig_IsSuitable( EGLDisplay display, EGLConfig config )
+{
+    EGLint value = 0;
+    eglGetConfigAttrib( display, config, EGL_RENDERABLE_TYPE, &value );
+    if ( ( value & EGL_OPENGL_ES3_BIT_KHR ) != EGL_OPENGL_ES3_BIT_KHR )
+    {
+        return false;
+    }
+    eglGetConfigAttrib( display, config, EGL_SURFACE_TYPE, &value );
+    if ( ( value & ( EGL_WINDOW_BIT | EGL_PBUFFER_BIT ) ) != ( EGL_WINDOW_BIT | EGL_PBUFFER_BIT ) )
+    {
+        return false;
+    }
+    const EGLint configAttribs[] =
+    {
+        EGL_ALPHA_SIZE, 8, // need alpha for the multi-pass timewarp compositor
+        EGL_BLUE_SIZE,  8,
+        EGL_GREEN_SIZE, 8,
+        EGL_RED_SIZE,   8,
+        EGL_DEPTH_SIZE, 0,
+        EGL_SAMPLES,	0,
+        EGL_NONE
+    };
+    for ( int i = 0; configAttribs[i] != EGL_NONE; i += 2 )
+    {
+        eglGetConfigAttrib( display, config, configAttribs[i], &value );
+        if ( value != configAttribs[i + 1] )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// What the cached id depends on: the device build and the driver.
+static inline void ovrEglConfigCache_GetKey( EGLDisplay display, char key[EGL_CONFIG_CACHE_KEY_MAX] )
+{
+    char fingerprint[PROP_VALUE_MAX] = "";
+    __system_property_get( "ro.build.fingerprint", fingerprint );
+    const char * vendor = eglQueryString( display, EGL_VENDOR );
+    const char * version = eglQueryString( display, EGL_VERSION );
+    snprintf( key, EGL_CONFIG_CACHE_KEY_MAX, "%s|%s|%s", fingerprint, vendor != NULL ? vendor : "", version != NULL ? version : "" );
+}
+
+// NULL (or "") only keeps the id in memory. Takes effect on the next lookup.
+static inline void ovrEglConfigCache_SetFile( const char * path )
+{
+    pthread_mutex_lock( &eglConfigCacheMutex );
+    strncpy( eglConfigCachePath, path != NULL ? path : "", EGL_CONFIG_CACHE_PATH_MAX - 1 );
+    eglConfigCachePath[EGL_CONFIG_CACHE_PATH_MAX - 1] = '\0';
+    pthread_mutex_unlock( &eglConfigCacheMutex );
+}
+
+// Only with the mutex locked.
+static inline EGLint ovrEglConfigCache_ReadFile( EGLDisplay display )
+{
+    if ( eglConfigCachePath[0] == '\0' )
+    {
+        return 0;
+    }
+    FILE * file = fopen( eglConfigCachePath, "r" );
+    if ( file == NULL )
+    {
+        return 0;
+    }
+    char key[EGL_CONFIG_CACHE_KEY_MAX];
+    ovrEglConfigCache_GetKey( display, key );
+    char storedKey[EGL_CONFIG_CACHE_KEY_MAX];
+    EGLint id = 0;
+    if ( fgets( storedKey, sizeof( storedKey ), file ) == NULL || fscanf( file, "%d", &id ) != 1 )
+    {
+        id = 0;
+    }
+    fclose( file );
+    storedKey[strcspn( storedKey, "\n" )] = '\0';
+    return strcmp( key, storedKey ) == 0 ? id : 0;
+}
+
+// Returns the cached config if it is still suitable, 0 otherwise (the caller then scans and stores).
+static inline EGLConfig ovrEglConfigCache_Find( EGLDisplay display )
+{
+    const long long startTime = GetTimeInNanoseconds();
+    pthread_mutex_lock( &eglConfigCacheMutex );
+    bool fromDisk = false;
+    if ( eglConfigCacheId == 0 )
+    {
+        eglConfigCacheId = ovrEglConfigCache_ReadFile( display );
+        fromDisk = eglConfigCacheId != 0;
+    }
+    EGLConfig config = 0;
+    if ( eglConfigCacheId != 0 )
+    {
+        const EGLint attribs[] =
+        {
+            EGL_CONFIG_ID, eglConfigCacheId,
+            EGL_NONE
+        };
+        EGLint numConfigs = 0;
+        if ( eglChooseConfig( display, attribs, &config, 1, &numConfigs ) == EGL_FALSE || numConfigs != 1 || !ovrEglConfig_IsSuitable( display, config ) )
+        {
+            // A driver update that was not reflected in the version, a corrupt file...
+            eglConfigCacheInvalidations.fetch_add( 1, std::memory_order_relaxed );
+            eglConfigCacheId = 0;
+            config = 0;
+        }
+    }
+    pthread_mutex_unlock( &eglConfigCacheMutex );
+    if ( config != 0 )
+    {
+        ( fromDisk ? eglConfigCacheDiskHits : eglConfigCacheMemoryHits ).fetch_add( 1, std::memory_order_relaxed );
+        eglConfigCacheHitNanoseconds.fetch_add( GetTimeInNanoseconds() - startTime, std::memory_order_relaxed );
+    }
+    return config;
+}
+
+// Remembers the config found by a scan that took scanNanoseconds.
+static inline void ovrEglConfigCache_Store( EGLDisplay display, EGLConfig config, const long long scanNanoseconds )
+{
+    eglConfigCacheScans.fetch_add( 1, std::memory_order_relaxed );
+    eglConfigCacheScanNanoseconds.fetch_add( scanNanoseconds, std::memory_order_relaxed );
+    EGLint id = 0;
+    if ( eglGetConfigAttrib( display, config, EGL_CONFIG_ID, &id ) == EGL_FALSE || id <= 0 )
+    {
+        return;
+    }
+    pthread_mutex_lock( &eglConfigCacheMutex );
+    eglConfigCacheId = id;
+    if ( eglConfigCachePath[0] != '\0' )
+    {
+        FILE * file = fopen( eglConfigCachePath, "w" );
+        if ( file != NULL )
+        {
+            char key[EGL_CONFIG_CACHE_KEY_MAX];
+            ovrEglConfigCache_GetKey( display, key );
+            fprintf( file, "%s\n%d\n", key, id );
+            fclose( file );
+        }
+    }
+    pthread_mutex_unlock( &eglConfigCacheMutex );
+}
+
+static inline void ovrEglConfigCache_GetStatistics( float statistics[EGL_CONFIG_CACHE_STATISTICS_FLOAT_COUNT] )
+{
+    const int memoryHits = eglConfigCacheMemoryHits.load( std::memory_order_relaxed );
+    const int diskHits = eglConfigCacheDiskHits.load( std::memory_order_relaxed );
+    const int scans = eglConfigCacheScans.load( std::memory_order_relaxed );
+    statistics[0] = (float)memoryHits;
+    statistics[1] = (float)diskHits;
+    statistics[2] = (float)scans;
+    statistics[3] = (float)eglConfigCacheInvalidations.load( std::memory_order_relaxed );
+    statistics[4] = memoryHits + diskHits > 0 ? (float)( eglConfigCacheHitNanoseconds.load( std::memory_order_relaxed ) / ( memoryHits + diskHits ) ) * 0.001f : 0.0f;
+    statistics[5] = scans > 0 ? (float)( eglConfigCacheScanNanoseconds.load( std::memory_order_relaxed ) / scans ) * 0.001f : 0.0f;
+}
+
+#endif // EGL_CONFIG_CACHE_H
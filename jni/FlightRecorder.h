@@ -0,0 +1,474 @@
+#ifndef FLIGHT_RECORDER_H
+#define FLIGHT_RECORDER_H
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <atomic>
+#include <vector>
+
+#include "VrApi_Types.h"
+
+#include "Clock.h"
+#include "WorkerPool.h"
+
+// ================================================================================================
+// FlightRecorder
+// Always on history of what the session went through recently, to see what led to a
+// problem without anything but logcat: the last POSE_CAPACITY poses the session handed out or
+// sampled (getData, the push deliveries and the sampler: about 8 seconds with the sampler at 1 kHz,
+// over a minute at the display refresh without it) and, apart so the poses can not push them out, the
+// last EVENT_CAPACITY events (lifecycle messages and VR mode transitions, system status changes, errors).
+// Appending does not lock nor allocate: a pose or an event, from any thread, claims its slot with an
+// atomic increment and is published with the slot sequence like in SampleRing (as long as fewer than
+// the capacity are being appended at the same time, which the handful of threads of the session never
+// get close to).
+// dump writes both histories merged in time order to a text file, while they keep being appended to;
+// dumpAsync does it on a worker so the tracking thread does not wait for the file.
+// With a dump path prefix set, the histories live in a shared mapping of <prefix>.flight instead of
+// the heap, so what a process that died without stopping its session (a crash, a kill) went through is
+// still in the file: the next recorder that sets the same prefix writes it to <prefix>.previous.txt
+// before taking the file over. The file is deleted when the recorder is destroyed.
+// ================================================================================================
+#define FLIGHT_RECORDER_MAGIC "OVRFLIT"
+#define FLIGHT_RECORDER_VERSION 1
+#define FLIGHT_RECORDER_FILE_EXTENSION ".flight"
+
+typedef enum
+{
+    FLIGHT_POSE_SAMPLED,
+    FLIGHT_POSE_QUERIED,
+    FLIGHT_POSE_DELIVERED,
+    FLIGHT_POSE_SOURCE_COUNT
+} ovrFlightPoseSource;
+
+typedef enum
+{
+    FLIGHT_EVENT_LIFECYCLE,
+    FLIGHT_EVENT_STATUS,
+    FLIGHT_EVENT_ERROR,
+    FLIGHT_EVENT_TYPE_COUNT
+} ovrFlightEventType;
+
+class FlightRecorder
+{
+public:
+    // Must be powers of 2.
+    static const unsigned int POSE_CAPACITY = 8192;
+    static const unsigned int EVENT_CAPACITY = 1024;
+    static const int EVENT_TEXT_SIZE = 48;
+    static const int PATH_SIZE = 256;
+    // poses recorded, events recorded, dumps written, dumps failed
+    static const int STATISTICS_FLOAT_COUNT = 4;
+
+private:
+    struct Pose
+    {
+        long long timeInNanoseconds;
+        double poseTimeInSeconds;
+        float orientation[4];
+        float position[3];
+        unsigned int trackingStatus;
+        int source;
+    };
+
+    struct PoseSlot
+    {
+        std::atomic<unsigned int> sequence;
+        Pose value;
+    };
+
+    struct Event
+    {
+        long long timeInNanoseconds;
+        int type;
+        int tid;
+        char text[EVENT_TEXT_SIZE];
+    };
+
+    struct EventSlot
+    {
+        std::atomic<unsigned int> sequence;
+        Event value;
+    };
+
+    // Both histories, as they are in memory and in the file.
+    struct History
+    {
+        char magic[8];
+        unsigned int version;
+        unsigned int size;
+        std::atomic<unsigned int> poseWriteCount;
+        std::atomic<unsigned int> eventWriteCount;
+        PoseSlot poses[POSE_CAPACITY];
+        EventSlot events[EVENT_CAPACITY];
+    };
+
+    static_assert((POSE_CAPACITY & (POSE_CAPACITY - 1)) == 0, "The FlightRecorder pose capacity must be a power of 2");
+    static_assert((EVENT_CAPACITY & (EVENT_CAPACITY - 1)) == 0, "The FlightRecorder event capacity must be a power of 2");
+
+    // Used until a dump path prefix is set.
+    History memoryHistory;
+    // The one appended to: memoryHistory or the mapping of the file.
+    std::atomic<History*> history;
+    // Where dumpAsync writes, empty to not dump automatically. Both are protected by dumpPathMutex.
+    char dumpPathPrefix[PATH_SIZE];
+    // The file mappings used so far. Only unmapped by the destructor: a thread may still be appending to the
+    // previous one right after a switch.
+    std::vector<History*> mappedHistories;
+    pthread_mutex_t dumpPathMutex;
+    std::atomic<unsigned int> dumpCount;
+    std::atomic<unsigned int> dumpFailedCount;
+
+    FlightRecorder(const FlightRecorder&);
+    FlightRecorder& operator=(const FlightRecorder&);
+
+    static const char* getPoseSourceName(const int source)
+    {
+        static const char* NAMES[FLIGHT_POSE_SOURCE_COUNT] = { "sampled", "queried", "delivered" };
+        return source >= 0 && source < FLIGHT_POSE_SOURCE_COUNT ? NAMES[source] : "unknown";
+    }
+
+    static const char* getEventTypeName(const int type)
+    {
+        static const char* NAMES[FLIGHT_EVENT_TYPE_COUNT] = { "lifecycle", "status", "error" };
+        return type >= 0 && type < FLIGHT_EVENT_TYPE_COUNT ? NAMES[type] : "unknown";
+    }
+
+    static bool readPose(const History& source, const unsigned int index, Pose& result)
+    {
+        const PoseSlot& slot = source.poses[index & (POSE_CAPACITY - 1)];
+        const unsigned int expected = 2 * index + 2;
+        if (slot.sequence.load(std::memory_order_acquire) != expected)
+        {
+            return false;
+        }
+        memcpy(&result, &slot.value, sizeof(Pose));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return slot.sequence.load(std::memory_order_relaxed) == expected;
+    }
+
+    static bool readEvent(const History& source, const unsigned int index, Event& result)
+    {
+        const EventSlot& slot = source.events[index & (EVENT_CAPACITY - 1)];
+        const unsigned int expected = 2 * index + 2;
+        if (slot.sequence.load(std::memory_order_acquire) != expected)
+        {
+            return false;
+        }
+        memcpy(&result, &slot.value, sizeof(Event));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return slot.sequence.load(std::memory_order_relaxed) == expected;
+    }
+
+    static void initHistory(History& target)
+    {
+        memcpy(target.magic, FLIGHT_RECORDER_MAGIC, sizeof(FLIGHT_RECORDER_MAGIC));
+        target.version = FLIGHT_RECORDER_VERSION;
+        target.size = sizeof(History);
+        target.poseWriteCount.store(0);
+        target.eventWriteCount.store(0);
+        for (unsigned int i = 0; i < POSE_CAPACITY; i++)
+        {
+            target.poses[i].sequence.store(0);
+        }
+        for (unsigned int i = 0; i < EVENT_CAPACITY; i++)
+        {
+            target.events[i].sequence.store(0);
+        }
+    }
+
+    static void getFilePath(const char* pathPrefix, const char* suffix, char* path, const size_t size)
+    {
+        snprintf(path, size, "%s%s", pathPrefix, suffix);
+    }
+
+    // Writes the history a previous process left in the file, if any, to <pathPrefix>.previous.txt.
+    void dumpPreviousFile(const char* pathPrefix)
+    {
+        char path[PATH_SIZE + 16];
+        getFilePath(pathPrefix, FLIGHT_RECORDER_FILE_EXTENSION, path, sizeof(path));
+        const int fd = open(path, O_RDONLY);
+        if (fd < 0)
+        {
+            return;
+        }
+        struct stat fileStat;
+        void* mapping = fstat(fd, &fileStat) == 0 && (size_t)fileStat.st_size == sizeof(History) ? mmap(NULL, sizeof(History), PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+        close(fd);
+        if (mapping == MAP_FAILED)
+        {
+            return;
+        }
+        const History* previous = (const History*)mapping;
+        if (memcmp(previous->magic, FLIGHT_RECORDER_MAGIC, sizeof(FLIGHT_RECORDER_MAGIC)) == 0 && previous->version == FLIGHT_RECORDER_VERSION && previous->size == sizeof(History))
+        {
+            getFilePath(pathPrefix, ".previous.txt", path, sizeof(path));
+            dump(*previous, path, "previous", 0);
+        }
+        munmap(mapping, sizeof(History));
+    }
+
+    // A shared mapping of <pathPrefix>.flight holding a copy of the current history, NULL if it could not be created.
+    History* mapFile(const char* pathPrefix)
+    {
+        char path[PATH_SIZE + 16];
+        getFilePath(pathPrefix, FLIGHT_RECORDER_FILE_EXTENSION, path, sizeof(path));
+        const int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0)
+        {
+            return NULL;
+        }
+        if (ftruncate(fd, (off_t)sizeof(History)) != 0)
+        {
+            close(fd);
+            unlink(path);
+            return NULL;
+        }
+        void* mapping = mmap(NULL, sizeof(History), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (mapping == MAP_FAILED)
+        {
+            unlink(path);
+            return NULL;
+        }
+        // Writing every page makes the file system allocate the blocks now, not while appending. What is appended
+        // to the current history during the copy may be missed.
+        memcpy(mapping, history.load(std::memory_order_acquire), sizeof(History));
+        return (History*)mapping;
+    }
+
+    static void dumpTask(const ovrWorkerTask* task)
+    {
+        FlightRecorder* flightRecorder = (FlightRecorder*)task->Context;
+        char path[PATH_SIZE + WORKER_TASK_TEXT_SIZE + 8];
+        pthread_mutex_lock(&flightRecorder->dumpPathMutex);
+        snprintf(path, sizeof(path), "%s.%s.txt", flightRecorder->dumpPathPrefix, task->Text);
+        pthread_mutex_unlock(&flightRecorder->dumpPathMutex);
+        flightRecorder->dump(path, task->Text);
+    }
+
+public:
+    FlightRecorder(): history(&memoryHistory), dumpCount(0), dumpFailedCount(0)
+    {
+        initHistory(memoryHistory);
+        dumpPathPrefix[0] = '\0';
+        pthread_mutex_init(&dumpPathMutex, NULL);
+    }
+
+    // Nothing may be appending anymore.
+    ~FlightRecorder()
+    {
+        if (dumpPathPrefix[0] != '\0')
+        {
+            // Stopped cleanly, there is nothing for the next process to recover
+            char path[PATH_SIZE + 16];
+            getFilePath(dumpPathPrefix, FLIGHT_RECORDER_FILE_EXTENSION, path, sizeof(path));
+            unlink(path);
+        }
+        for (size_t i = 0; i < mappedHistories.size(); i++)
+        {
+            munmap(mappedHistories[i], sizeof(History));
+        }
+        pthread_mutex_destroy(&dumpPathMutex);
+    }
+
+    // Any thread.
+    inline void recordPose(const ovrTracking& tracking, const long long timeInNanoseconds, const ovrFlightPoseSource source)
+    {
+        History* target = history.load(std::memory_order_acquire);
+        const unsigned int index = target->poseWriteCount.fetch_add(1, std::memory_order_relaxed);
+        PoseSlot& slot = target->poses[index & (POSE_CAPACITY - 1)];
+        slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        Pose& pose = slot.value;
+        pose.timeInNanoseconds = timeInNanoseconds;
+        pose.poseTimeInSeconds = tracking.HeadPose.TimeInSeconds;
+        pose.orientation[0] = tracking.HeadPose.Pose.Orientation.x;
+        pose.orientation[1] = tracking.HeadPose.Pose.Orientation.y;
+        pose.orientation[2] = tracking.HeadPose.Pose.Orientation.z;
+        pose.orientation[3] = tracking.HeadPose.Pose.Orientation.w;
+        pose.position[0] = tracking.HeadPose.Pose.Position.x;
+        pose.position[1] = tracking.HeadPose.Pose.Position.y;
+        pose.position[2] = tracking.HeadPose.Pose.Position.z;
+        pose.trackingStatus = tracking.Status;
+        pose.source = source;
+        slot.sequence.store(2 * index + 2, std::memory_order_release);
+    }
+
+    // Any thread. The text is truncated to EVENT_TEXT_SIZE.
+    __attribute__((format(printf, 3, 4))) void recordEvent(const int type, const char* format, ...)
+    {
+        History* target = history.load(std::memory_order_acquire);
+        const unsigned int index = target->eventWriteCount.fetch_add(1, std::memory_order_relaxed);
+        EventSlot& slot = target->events[index & (EVENT_CAPACITY - 1)];
+        slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.value.timeInNanoseconds = GetTimeInNanoseconds();
+        slot.value.type = type;
+        slot.value.tid = gettid();
+        va_list args;
+        va_start(args, format);
+        vsnprintf(slot.value.text, EVENT_TEXT_SIZE, format, args);
+        va_end(args);
+        slot.sequence.store(2 * index + 2, std::memory_order_release);
+    }
+
+    // Any thread (it may write the previous history file, so not the UI thread). NULL or empty to not dump
+    // automatically, the histories then go back to memory.
+    void setDumpPathPrefix(const char* pathPrefix)
+    {
+        pathPrefix = pathPrefix != NULL ? pathPrefix : "";
+        pthread_mutex_lock(&dumpPathMutex);
+        if (strncmp(dumpPathPrefix, pathPrefix, PATH_SIZE) == 0)
+        {
+            pthread_mutex_unlock(&dumpPathMutex);
+            return;
+        }
+        if (dumpPathPrefix[0] != '\0')
+        {
+            char path[PATH_SIZE + 16];
+            getFilePath(dumpPathPrefix, FLIGHT_RECORDER_FILE_EXTENSION, path, sizeof(path));
+            unlink(path);
+        }
+        snprintf(dumpPathPrefix, PATH_SIZE, "%s", pathPrefix);
+        History* target = &memoryHistory;
+        if (dumpPathPrefix[0] != '\0')
+        {
+            dumpPreviousFile(dumpPathPrefix);
+            History* mapped = mapFile(dumpPathPrefix);
+            if (mapped != NULL)
+            {
+                mappedHistories.push_back(mapped);
+                target = mapped;
+            }
+            else
+            {
+                dumpFailedCount.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        if (target != history.load(std::memory_order_relaxed))
+        {
+            if (target == &memoryHistory)
+            {
+                memcpy((void*)&memoryHistory, history.load(std::memory_order_relaxed), sizeof(History));
+            }
+            history.store(target, std::memory_order_release);
+        }
+        pthread_mutex_unlock(&dumpPathMutex);
+    }
+
+    // Writes the histories to <dump path prefix>.<reason>.txt from a worker, if a dump path prefix is set.
+    // The reason is a short word (error, stop...). Any thread.
+    void dumpAsync(WorkerPool* workers, const char* reason)
+    {
+        pthread_mutex_lock(&dumpPathMutex);
+        const bool enabled = dumpPathPrefix[0] != '\0';
+        pthread_mutex_unlock(&dumpPathMutex);
+        if (!enabled)
+        {
+            return;
+        }
+        ovrWorkerTask task;
+        task.Function = dumpTask;
+        task.Context = this;
+        snprintf(task.Text, WORKER_TASK_TEXT_SIZE, "%s", reason);
+        if (!workers->submit(task))
+        {
+            dumpFailedCount.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // Writes the histories, oldest first, to the file: one line per pose or event with its time relative to
+    // the dump. Any thread. Returns false if the file could not be written.
+    bool dump(const char* path, const char* reason)
+    {
+        return dump(*history.load(std::memory_order_acquire), path, reason, GetTimeInNanoseconds());
+    }
+
+    // The same for the given history, relative to the dump time (0 for its last pose or event).
+    bool dump(const History& source, const char* path, const char* reason, long long dumpTime)
+    {
+        // Copy what is there now, the histories keep moving while the file is written
+        std::vector<Pose> poseCopies;
+        poseCopies.reserve(POSE_CAPACITY);
+        const unsigned int poseCount = source.poseWriteCount.load(std::memory_order_acquire);
+        for (unsigned int index = poseCount > POSE_CAPACITY ? poseCount - POSE_CAPACITY : 0; index != poseCount; index++)
+        {
+            Pose pose;
+            if (readPose(source, index, pose))
+            {
+                poseCopies.push_back(pose);
+            }
+        }
+        std::vector<Event> eventCopies;
+        eventCopies.reserve(EVENT_CAPACITY);
+        const unsigned int eventCount = source.eventWriteCount.load(std::memory_order_acquire);
+        for (unsigned int index = eventCount > EVENT_CAPACITY ? eventCount - EVENT_CAPACITY : 0; index != eventCount; index++)
+        {
+            Event event;
+            if (readEvent(source, index, event))
+            {
+                eventCopies.push_back(event);
+            }
+        }
+        const char* timeReference = dumpTime == 0 ? "last entry" : "dump";
+        if (dumpTime == 0)
+        {
+            dumpTime = !poseCopies.empty() ? poseCopies.back().timeInNanoseconds : 0;
+            dumpTime = !eventCopies.empty() && eventCopies.back().timeInNanoseconds > dumpTime ? eventCopies.back().timeInNanoseconds : dumpTime;
+        }
+
+        FILE* file = fopen(path, "w");
+        if (file == NULL)
+        {
+            dumpFailedCount.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        fprintf(file, "# Flight recorder dump (%s): %u poses, %u events\n", reason != NULL ? reason : "", (unsigned int)poseCopies.size(), (unsigned int)eventCopies.size());
+        fprintf(file, "# seconds before the %s, pose, source, pose time, orientation x y z w, position x y z, tracking status\n", timeReference);
+        fprintf(file, "# seconds before the %s, event type, thread id, event\n", timeReference);
+        // Both are in time order except for the events appended concurrently, which are close enough
+        size_t p = 0, e = 0;
+        while (p < poseCopies.size() || e < eventCopies.size())
+        {
+            if (e == eventCopies.size() || (p < poseCopies.size() && poseCopies[p].timeInNanoseconds <= eventCopies[e].timeInNanoseconds))
+            {
+                const Pose& pose = poseCopies[p++];
+                fprintf(file, "%.6f pose %s %.6f %.6f %.6f %.6f %.6f %.4f %.4f %.4f 0x%x\n", (pose.timeInNanoseconds - dumpTime) * 1e-9, getPoseSourceName(pose.source), pose.poseTimeInSeconds,
+                    pose.orientation[0], pose.orientation[1], pose.orientation[2], pose.orientation[3], pose.position[0], pose.position[1], pose.position[2], pose.trackingStatus);
+            }
+            else
+            {
+                const Event& event = eventCopies[e++];
+                fprintf(file, "%.6f %s %d %s\n", (event.timeInNanoseconds - dumpTime) * 1e-9, getEventTypeName(event.type), event.tid, event.text);
+            }
+        }
+        const bool written = !ferror(file);
+        if (fclose(file) != 0 || !written)
+        {
+            dumpFailedCount.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        dumpCount.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Any thread.
+    void getStatistics(float statistics[STATISTICS_FLOAT_COUNT]) const
+    {
+        const History* current = history.load(std::memory_order_acquire);
+        statistics[0] = (float)current->poseWriteCount.load(std::memory_order_relaxed);
+        statistics[1] = (float)current->eventWriteCount.load(std::memory_order_relaxed);
+        statistics[2] = (float)dumpCount.load(std::memory_order_relaxed);
+        statistics[3] = (float)dumpFailedCount.load(std::memory_order_relaxed);
+    }
+};
+
+#endif // FLIGHT_RECORDER_H
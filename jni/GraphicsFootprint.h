@@ -0,0 +1,79 @@
+#ifndef GRAPHICS_FOOTPRINT_H
+#define GRAPHICS_FOOTPRINT_H
+
+#include <atomic>
+
+// ================================================================================================
+// GraphicsFootprint
+// What the graphics state of the session costs, to compare the tracking-only mode with the default
+// one: the size of the surfaces (the window one is what vrapi composites to, so it is also what the
+// timewarp draws every vsync), the clock levels handed to vrapi and how long submitting the black
+// frames that carry them takes (the driver overhead of a session that does not render anything).
+// Only recorded by the tracking thread, can be read from any thread.
+// ================================================================================================
+class GraphicsFootprint
+{
+public:
+    // tracking only, window surface width, window surface height, window surface KB per buffer, offscreen surface
+    // width, offscreen surface height, CPU level, GPU level, black frames submitted, mean black frame submit (us)
+    static const int STATISTICS_FLOAT_COUNT = 10;
+
+private:
+    // RGBA8, see ovrEglConfig_IsSuitable
+    static const int BYTES_PER_PIXEL = 4;
+
+    const bool trackingOnly;
+    std::atomic<int> windowSurfaceWidth;
+    std::atomic<int> windowSurfaceHeight;
+    std::atomic<int> offscreenSurfaceWidth;
+    std::atomic<int> offscreenSurfaceHeight;
+    std::atomic<int> cpuLevel;
+    std::atomic<int> gpuLevel;
+    std::atomic<unsigned int> blackFrames;
+    std::atomic<long long> blackFrameNanoseconds;
+
+public:
+    explicit GraphicsFootprint(const bool trackingOnly): trackingOnly(trackingOnly), windowSurfaceWidth(0), windowSurfaceHeight(0), offscreenSurfaceWidth(0), offscreenSurfaceHeight(0), cpuLevel(0), gpuLevel(0), blackFrames(0), blackFrameNanoseconds(0)
+    {
+    }
+
+    // 0 x 0 once destroyed.
+    void setWindowSurfaceSize(const int width, const int height)
+    {
+        windowSurfaceWidth.store(width, std::memory_order_relaxed);
+        windowSurfaceHeight.store(height, std::memory_order_relaxed);
+    }
+
+    void setOffscreenSurfaceSize(const int width, const int height)
+    {
+        offscreenSurfaceWidth.store(width, std::memory_order_relaxed);
+        offscreenSurfaceHeight.store(height, std::memory_order_relaxed);
+    }
+
+    void recordBlackFrame(const int cpuLevel, const int gpuLevel, const long long submitNanoseconds)
+    {
+        this->cpuLevel.store(cpuLevel, std::memory_order_relaxed);
+        this->gpuLevel.store(gpuLevel, std::memory_order_relaxed);
+        blackFrameNanoseconds.store(blackFrameNanoseconds.load(std::memory_order_relaxed) + submitNanoseconds, std::memory_order_relaxed);
+        blackFrames.store(blackFrames.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    void getStatistics(float statistics[STATISTICS_FLOAT_COUNT]) const
+    {
+        const unsigned int frames = blackFrames.load(std::memory_order_acquire);
+        const int width = windowSurfaceWidth.load(std::memory_order_relaxed);
+        const int height = windowSurfaceHeight.load(std::memory_order_relaxed);
+        statistics[0] = trackingOnly ? 1.0f : 0.0f;
+        statistics[1] = (float)width;
+        statistics[2] = (float)height;
+        statistics[3] = (float)width * height * BYTES_PER_PIXEL / 1024.0f;
+        statistics[4] = (float)offscreenSurfaceWidth.load(std::memory_order_relaxed);
+        statistics[5] = (float)offscreenSurfaceHeight.load(std::memory_order_relaxed);
+        statistics[6] = (float)cpuLevel.load(std::memory_order_relaxed);
+        statistics[7] = (float)gpuLevel.load(std::memory_order_relaxed);
+        statistics[8] = (float)frames;
+        statistics[9] = frames > 0 ? (float)(blackFrameNanoseconds.load(std::memory_order_relaxed) / frames) * 0.001f : 0.0f;
+    }
+};
+
+#endif // GRAPHICS_FOOTPRINT_H
@@ -0,0 +1,95 @@
+#ifndef GUARDED_POINTER_H
+#define GUARDED_POINTER_H
+
+#include <sched.h>
+
+#include <atomic>
+
+// ================================================================================================
+// GuardedPointer
+// A pointer that any thread can read without locks while one owner thread publishes and retires it
+// (RCU style). Readers announce themselves in the counter of the current epoch (and retry if the
+// epoch changed meanwhile) before loading the pointer. Retiring clears the pointer, flips the epoch and waits until the counter of the previous
+// epoch drains, so:
+// - a reader either sees NULL or a pointer that stays valid until its ReadScope ends,
+// - the owner only waits for the readers that were already in flight, never for new ones (they use
+//   the other counter and can only see NULL).
+// All the operations are sequentially consistent: the reader's counter increment and pointer load
+// must not be reordered with the owner's pointer store and counter check.
+// ================================================================================================
+template<typename T>
+class GuardedPointer
+{
+private:
+    std::atomic<T*> pointer;
+    std::atomic<unsigned int> epoch;
+    std::atomic<int> readers[2];
+
+public:
+    // Keeps the pointer alive while in scope.
+    class ReadScope
+    {
+    private:
+        GuardedPointer& guardedPointer;
+        unsigned int readerEpoch;
+        T* value;
+
+        ReadScope(const ReadScope&);
+        ReadScope& operator=(const ReadScope&);
+
+    public:
+        explicit ReadScope(GuardedPointer& guardedPointer): guardedPointer(guardedPointer)
+        {
+            for ( ; ; )
+            {
+                const unsigned int currentEpoch = guardedPointer.epoch.load();
+                readerEpoch = currentEpoch & 1;
+                guardedPointer.readers[readerEpoch].fetch_add(1);
+                // If the epoch flipped in between, the owner may have already checked this counter.
+                if (guardedPointer.epoch.load() == currentEpoch)
+                {
+                    break;
+                }
+                guardedPointer.readers[readerEpoch].fetch_sub(1);
+            }
+            value = guardedPointer.pointer.load();
+        }
+
+        ~ReadScope()
+        {
+            guardedPointer.readers[readerEpoch].fetch_sub(1, std::memory_order_release);
+        }
+
+        // NULL if the pointer has been retired (or never published).
+        inline T* get() const
+        {
+            return value;
+        }
+    };
+
+    GuardedPointer(): pointer(NULL), epoch(0)
+    {
+        readers[0].store(0);
+        readers[1].store(0);
+    }
+
+    // Only from the owner thread.
+    void publish(T* value)
+    {
+        pointer.store(value);
+    }
+
+    // Only from the owner thread. Returns the previous pointer once no reader can be using it anymore.
+    T* retire()
+    {
+        T* value = pointer.exchange(NULL);
+        const unsigned int previousEpoch = epoch.fetch_add(1) & 1;
+        while (readers[previousEpoch].load(std::memory_order_acquire) != 0)
+        {
+            sched_yield();
+        }
+        return value;
+    }
+};
+
+#endif // GUARDED_POINTER_H
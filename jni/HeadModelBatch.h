@@ -0,0 +1,100 @@
+#ifndef HEAD_MODEL_BATCH_H
+#define HEAD_MODEL_BATCH_H
+
+#include "VrApi_Types.h"
+
+#if defined( __ARM_NEON__ )
+#include <arm_neon.h>
+#endif
+
+// ================================================================================================
+// Batched head model
+// Same head-on-a-stick model as vrapi_ApplyHeadModel (VrApi_Helpers.h) but applied to whole
+// structure-of-arrays pose buffers at once: history rebuilds, recordings, batch predictions...
+// Positions are only replaced for the samples whose status does not include
+// VRAPI_TRACKING_STATUS_POSITION_TRACKED, exactly like the single sample version. The arithmetic
+// follows the same expressions as ovrMatrix4f_CreateFromQuaternion so the results match.
+// ================================================================================================
+typedef struct
+{
+    int count;
+    const unsigned int* status;
+    const float* orientationX;
+    const float* orientationY;
+    const float* orientationZ;
+    const float* orientationW;
+    // In/out: only overwritten for the samples without position tracking.
+    float* positionX;
+    float* positionY;
+    float* positionZ;
+} ovrHeadModelBatch;
+
+static inline void ovrHeadModelBatch_ApplyScalar( const ovrHeadModelParms * p, const ovrHeadModelBatch * batch, const int begin, const int end )
+{
+    for ( int i = begin; i < end; i++ )
+    {
+        if ( ( batch->status[i] & VRAPI_TRACKING_STATUS_POSITION_TRACKED ) != 0 )
+        {
+            continue;
+        }
+        const float x = batch->orientationX[i];
+        const float y = batch->orientationY[i];
+        const float z = batch->orientationZ[i];
+        const float w = batch->orientationW[i];
+        const float ww = w * w;
+        const float xx = x * x;
+        const float yy = y * y;
+        const float zz = z * z;
+        const float m01 = 2 * ( x * y - w * z );
+        const float m02 = 2 * ( x * z + w * y );
+        const float m11 = ww - xx + yy - zz;
+        const float m12 = 2 * ( y * z - w * x );
+        const float m21 = 2 * ( y * z + w * x );
+        const float m22 = ww - xx - yy + zz;
+        batch->positionX[i] = m01 * p->HeadModelHeight - m02 * p->HeadModelDepth;
+        batch->positionY[i] = m11 * p->HeadModelHeight - m12 * p->HeadModelDepth - p->HeadModelHeight;
+        batch->positionZ[i] = m21 * p->HeadModelHeight - m22 * p->HeadModelDepth;
+    }
+}
+
+static inline void ovrHeadModelBatch_Apply( const ovrHeadModelParms * p, const ovrHeadModelBatch * batch )
+{
+    int i = 0;
+#if defined( __ARM_NEON__ )
+    const float32x4_t two = vdupq_n_f32( 2.0f );
+    const float32x4_t height = vdupq_n_f32( p->HeadModelHeight );
+    const float32x4_t depth = vdupq_n_f32( p->HeadModelDepth );
+    const uint32x4_t positionTracked = vdupq_n_u32( VRAPI_TRACKING_STATUS_POSITION_TRACKED );
+    for ( ; i + 4 <= batch->count; i += 4 )
+    {
+        const float32x4_t x = vld1q_f32( batch->orientationX + i );
+        const float32x4_t y = vld1q_f32( batch->orientationY + i );
+        const float32x4_t z = vld1q_f32( batch->orientationZ + i );
+        const float32x4_t w = vld1q_f32( batch->orientationW + i );
+        // Lanes with position tracking keep their current position.
+        const uint32x4_t keep = vtstq_u32( vld1q_u32( batch->status + i ), positionTracked );
+
+        const float32x4_t ww = vmulq_f32( w, w );
+        const float32x4_t xx = vmulq_f32( x, x );
+        const float32x4_t yy = vmulq_f32( y, y );
+        const float32x4_t zz = vmulq_f32( z, z );
+        const float32x4_t m01 = vmulq_f32( two, vsubq_f32( vmulq_f32( x, y ), vmulq_f32( w, z ) ) );
+        const float32x4_t m02 = vmulq_f32( two, vaddq_f32( vmulq_f32( x, z ), vmulq_f32( w, y ) ) );
+        const float32x4_t m11 = vsubq_f32( vaddq_f32( vsubq_f32( ww, xx ), yy ), zz );
+        const float32x4_t m12 = vmulq_f32( two, vsubq_f32( vmulq_f32( y, z ), vmulq_f32( w, x ) ) );
+        const float32x4_t m21 = vmulq_f32( two, vaddq_f32( vmulq_f32( y, z ), vmulq_f32( w, x ) ) );
+        const float32x4_t m22 = vaddq_f32( vsubq_f32( vsubq_f32( ww, xx ), yy ), zz );
+
+        const float32x4_t px = vsubq_f32( vmulq_f32( m01, height ), vmulq_f32( m02, depth ) );
+        const float32x4_t py = vsubq_f32( vsubq_f32( vmulq_f32( m11, height ), vmulq_f32( m12, depth ) ), height );
+        const float32x4_t pz = vsubq_f32( vmulq_f32( m21, height ), vmulq_f32( m22, depth ) );
+
+        vst1q_f32( batch->positionX + i, vbslq_f32( keep, vld1q_f32( batch->positionX + i ), px ) );
+        vst1q_f32( batch->positionY + i, vbslq_f32( keep, vld1q_f32( batch->positionY + i ), py ) );
+        vst1q_f32( batch->positionZ + i, vbslq_f32( keep, vld1q_f32( batch->positionZ + i ), pz ) );
+    }
+#endif
+    ovrHeadModelBatch_ApplyScalar( p, batch, i, batch->count );
+}
+
+#endif // HEAD_MODEL_BATCH_H
@@ -0,0 +1,630 @@
+// Only part of the host build (see HostBackend.h), never of Android.mk.
+#ifndef OVR_HEAD_TRACKING_HOST_BACKEND
+#define OVR_HEAD_TRACKING_HOST_BACKEND 1
+#endif
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include <atomic>
+
+#include "Backend.h"
+#include "Clock.h"
+#include "SeqLock.h"
+
+#if OVR_HEAD_TRACKING_HOST_BACKEND == 1
+
+// ================================================================================================
+// Simulation state
+// ================================================================================================
+// Never written means the default parms (see ovrHostBackend_GetParms).
+static SeqLock<ovrHostBackendParms> hostParms;
+
+static std::atomic<int> hostInitializeCount( 0 );
+static std::atomic<int> hostEnterVrModeCount( 0 );
+static std::atomic<int> hostLeaveVrModeCount( 0 );
+static std::atomic<int> hostSubmitFrameCount( 0 );
+static std::atomic<long long> hostPredictedTrackingCount( 0 );
+static std::atomic<int> hostContextsCreated( 0 );
+static std::atomic<int> hostWindowSurfacesCreated( 0 );
+static std::atomic<int> hostLiveContexts( 0 );
+static std::atomic<int> hostLiveSurfaces( 0 );
+static std::atomic<int> hostLiveWindows( 0 );
+static std::atomic<int> hostLiveVrModes( 0 );
+
+// Takes the given time, spinning for the short ones so they are accurate.
+static void HostBackend_Spend( const double seconds )
+{
+    if ( seconds <= 0.0 )
+    {
+        return;
+    }
+    if ( seconds < 0.002 )
+    {
+        const long long endTime = GetTimeInNanoseconds() + (long long)( seconds * 1e9 );
+        while ( GetTimeInNanoseconds() < endTime )
+        {
+        }
+        return;
+    }
+    struct timespec duration;
+    duration.tv_sec = (time_t)seconds;
+    duration.tv_nsec = (long)( ( seconds - (double)duration.tv_sec ) * 1e9 );
+    while ( nanosleep( &duration, &duration ) != 0 )
+    {
+    }
+}
+
+extern "C" {
+
+ovrHostBackendParms ovrHostBackend_DefaultParms()
+{
+    ovrHostBackendParms parms;
+    memset( &parms, 0, sizeof( parms ) );
+    parms.YawAmplitude = 0.8f;
+    parms.YawFrequency = 0.25f;
+    parms.PitchAmplitude = 0.3f;
+    parms.PitchFrequency = 0.4f;
+    parms.DisplayRefreshRate = 60;
+    parms.EyeFovDegreesX = 90.0f;
+    parms.EyeFovDegreesY = 90.0f;
+    parms.Mounted = 1;
+    parms.Docked = 1;
+    parms.RenderLatencyMilliseconds = 27.0f;
+    parms.TimeWarpLatencyMilliseconds = 13.0f;
+    parms.EnterVrModeSeconds = 0.25;
+    parms.LeaveVrModeSeconds = 0.05;
+    parms.CreateContextSeconds = 0.02;
+    parms.SubmitFrameSeconds = 0.001;
+    parms.PredictedTrackingSeconds = 0.000002;
+    parms.WindowWidth = 2560;
+    parms.WindowHeight = 1440;
+    parms.PrintLog = false;
+    return parms;
+}
+
+void ovrHostBackend_SetParms( const ovrHostBackendParms * parms )
+{
+    hostParms.write( *parms );
+}
+
+ovrHostBackendParms ovrHostBackend_GetParms()
+{
+    ovrHostBackendParms parms;
+    if ( hostParms.read( parms ) == 0 )
+    {
+        parms = ovrHostBackend_DefaultParms();
+    }
+    return parms;
+}
+
+ovrHostBackendCounters ovrHostBackend_GetCounters()
+{
+    ovrHostBackendCounters counters;
+    counters.Initialize = hostInitializeCount.load( std::memory_order_relaxed );
+    counters.EnterVrMode = hostEnterVrModeCount.load( std::memory_order_relaxed );
+    counters.LeaveVrMode = hostLeaveVrModeCount.load( std::memory_order_relaxed );
+    counters.SubmitFrame = hostSubmitFrameCount.load( std::memory_order_relaxed );
+    counters.PredictedTracking = hostPredictedTrackingCount.load( std::memory_order_relaxed );
+    counters.ContextsCreated = hostContextsCreated.load( std::memory_order_relaxed );
+    counters.WindowSurfacesCreated = hostWindowSurfacesCreated.load( std::memory_order_relaxed );
+    counters.LiveContexts = hostLiveContexts.load( std::memory_order_relaxed );
+    counters.LiveSurfaces = hostLiveSurfaces.load( std::memory_order_relaxed );
+    counters.LiveWindows = hostLiveWindows.load( std::memory_order_relaxed );
+    counters.LiveVrModes = hostLiveVrModes.load( std::memory_order_relaxed );
+    return counters;
+}
+
+// Yaw about Y followed by pitch about X, with the exact derivatives. The angular velocity and
+// acceleration are in world space.
+ovrTracking ovrHostBackend_GetTracking( double absTimeInSeconds )
+{
+    const ovrHostBackendParms parms = ovrHostBackend_GetParms();
+    const double yawOmega = 2.0 * M_PI * parms.YawFrequency;
+    const double pitchOmega = 2.0 * M_PI * parms.PitchFrequency;
+    const double yaw = parms.YawAmplitude * sin( yawOmega * absTimeInSeconds );
+    const double yawVelocity = parms.YawAmplitude * yawOmega * cos( yawOmega * absTimeInSeconds );
+    const double yawAcceleration = -yawOmega * yawOmega * yaw;
+    const double pitch = parms.PitchAmplitude * sin( pitchOmega * absTimeInSeconds );
+    const double pitchVelocity = parms.PitchAmplitude * pitchOmega * cos( pitchOmega * absTimeInSeconds );
+    const double pitchAcceleration = -pitchOmega * pitchOmega * pitch;
+
+    const double sy = sin( yaw * 0.5 ), cy = cos( yaw * 0.5 );
+    const double sp = sin( pitch * 0.5 ), cp = cos( pitch * 0.5 );
+
+    ovrTracking tracking;
+    memset( &tracking, 0, sizeof( tracking ) );
+    tracking.Status = VRAPI_TRACKING_STATUS_ORIENTATION_TRACKED | VRAPI_TRACKING_STATUS_HMD_CONNECTED;
+    tracking.HeadPose.Pose.Orientation.x = (float)( cy * sp );
+    tracking.HeadPose.Pose.Orientation.y = (float)( sy * cp );
+    tracking.HeadPose.Pose.Orientation.z = (float)( -sy * sp );
+    tracking.HeadPose.Pose.Orientation.w = (float)( cy * cp );
+    // The pitch axis is X rotated by the yaw
+    const double cosYaw = cos( yaw ), sinYaw = sin( yaw );
+    tracking.HeadPose.AngularVelocity.x = (float)( pitchVelocity * cosYaw );
+    tracking.HeadPose.AngularVelocity.y = (float)yawVelocity;
+    tracking.HeadPose.AngularVelocity.z = (float)( -pitchVelocity * sinYaw );
+    tracking.HeadPose.AngularAcceleration.x = (float)( pitchAcceleration * cosYaw - pitchVelocity * yawVelocity * sinYaw );
+    tracking.HeadPose.AngularAcceleration.y = (float)yawAcceleration;
+    tracking.HeadPose.AngularAcceleration.z = (float)( -pitchAcceleration * sinYaw - pitchVelocity * yawVelocity * cosYaw );
+    tracking.HeadPose.TimeInSeconds = absTimeInSeconds;
+    return tracking;
+}
+
+// ================================================================================================
+// <android/log.h>
+// ================================================================================================
+int __android_log_write( int prio, const char * tag, const char * text )
+{
+    static const char PRIORITY_LETTERS[] = "??VDIWEFS";
+    if ( !ovrHostBackend_GetParms().PrintLog )
+    {
+        return 0;
+    }
+    return fprintf( stderr, "%c/%s: %s\n", PRIORITY_LETTERS[prio >= 0 && prio <= ANDROID_LOG_SILENT ? prio : 0], tag, text );
+}
+
+int __android_log_print( int prio, const char * tag, const char * fmt, ... )
+{
+    char text[1024];
+    va_list args;
+    va_start( args, fmt );
+    vsnprintf( text, sizeof( text ), fmt, args );
+    va_end( args );
+    return __android_log_write( prio, tag, text );
+}
+
+// ================================================================================================
+// <android/native_window_jni.h>
+// A new window for every call (a device returns the same one for the same Surface).
+// ================================================================================================
+struct ANativeWindow
+{
+    std::atomic<int> References;
+    int Width;
+    int Height;
+};
+
+ANativeWindow * ANativeWindow_fromSurface( JNIEnv * env, jobject surface )
+{
+    if ( surface == NULL )
+    {
+        return NULL;
+    }
+    const ovrHostBackendParms parms = ovrHostBackend_GetParms();
+    ANativeWindow * window = new ANativeWindow;
+    window->References.store( 1 );
+    window->Width = parms.WindowWidth;
+    window->Height = parms.WindowHeight;
+    hostLiveWindows.fetch_add( 1, std::memory_order_relaxed );
+    return window;
+}
+
+void ANativeWindow_acquire( ANativeWindow * window )
+{
+    window->References.fetch_add( 1, std::memory_order_relaxed );
+}
+
+void ANativeWindow_release( ANativeWindow * window )
+{
+    if ( window->References.fetch_sub( 1, std::memory_order_acq_rel ) == 1 )
+    {
+        delete window;
+        hostLiveWindows.fetch_sub( 1, std::memory_order_relaxed );
+    }
+}
+
+int32_t ANativeWindow_getWidth( ANativeWindow * window )
+{
+    return window->Width;
+}
+
+int32_t ANativeWindow_getHeight( ANativeWindow * window )
+{
+    return window->Height;
+}
+
+// ================================================================================================
+// <sys/system_properties.h>
+// ================================================================================================
+int __system_property_get( const char * name, char * value )
+{
+    const char * property = strcmp( name, "ro.build.fingerprint" ) == 0 ? "host/OculusMobileSDKHeadTracking/simulation" : "";
+    strncpy( value, property, PROP_VALUE_MAX - 1 );
+    value[PROP_VALUE_MAX - 1] = '\0';
+    return (int)strlen( value );
+}
+
+// ================================================================================================
+// EGL
+// HOST_EGL_CONFIG_COUNT configs, of which only the last ones are suitable for the tracking context
+// (see ovrEglConfig_IsSuitable) so the config scan does some work. Every object is a heap allocated
+// handle, counted so leaks show in ovrHostBackend_GetCounters.
+// ================================================================================================
+#define HOST_EGL_CONFIG_COUNT			64
+#define HOST_EGL_FIRST_SUITABLE_CONFIG	47
+
+struct HostEglSurface
+{
+    ANativeWindow * Window;
+    EGLint Width;
+    EGLint Height;
+};
+
+static int hostEglDisplay = 0;
+static std::atomic<int> hostEglContext( 0 );
+static thread_local EGLint hostEglError = EGL_SUCCESS;
+static thread_local EGLSurface hostEglCurrentSurface = EGL_NO_SURFACE;
+static thread_local EGLContext hostEglCurrentContext = EGL_NO_CONTEXT;
+
+static inline EGLBoolean HostEgl_Fail( const EGLint error )
+{
+    hostEglError = error;
+    return EGL_FALSE;
+}
+
+static inline int HostEgl_ConfigIndex( EGLConfig config )
+{
+    return (int)( (intptr_t)config - 1 );
+}
+
+EGLint eglGetError( void )
+{
+    const EGLint error = hostEglError;
+    hostEglError = EGL_SUCCESS;
+    return error;
+}
+
+EGLDisplay eglGetDisplay( EGLNativeDisplayType display_id )
+{
+    return (EGLDisplay)&hostEglDisplay;
+}
+
+EGLBoolean eglInitialize( EGLDisplay dpy, EGLint * major, EGLint * minor )
+{
+    if ( major != NULL )
+    {
+        *major = 1;
+    }
+    if ( minor != NULL )
+    {
+        *minor = 4;
+    }
+    return EGL_TRUE;
+}
+
+EGLBoolean eglTerminate( EGLDisplay dpy )
+{
+    return EGL_TRUE;
+}
+
+const char * eglQueryString( EGLDisplay dpy, EGLint name )
+{
+    switch ( name )
+    {
+        case EGL_VENDOR:	return "OculusMobileSDKHeadTracking host";
+        case EGL_VERSION:	return "1.4 host";
+        default:			return "";
+    }
+}
+
+EGLBoolean eglGetConfigs( EGLDisplay dpy, EGLConfig * configs, EGLint config_size, EGLint * num_config )
+{
+    EGLint count = 0;
+    for ( ; count < HOST_EGL_CONFIG_COUNT && ( configs == NULL || count < config_size ); count++ )
+    {
+        if ( configs != NULL )
+        {
+            configs[count] = (EGLConfig)(intptr_t)( count + 1 );
+        }
+    }
+    *num_config = count;
+    return EGL_TRUE;
+}
+
+EGLBoolean eglGetConfigAttrib( EGLDisplay dpy, EGLConfig config, EGLint attribute, EGLint * value )
+{
+    const int index = HostEgl_ConfigIndex( config );
+    if ( index < 0 || index >= HOST_EGL_CONFIG_COUNT )
+    {
+        return HostEgl_Fail( EGL_BAD_CONFIG );
+    }
+    switch ( attribute )
+    {
+        case EGL_CONFIG_ID:			*value = index + 1; break;
+        case EGL_RENDERABLE_TYPE:	*value = EGL_OPENGL_ES2_BIT | 0x0040 /* EGL_OPENGL_ES3_BIT_KHR */; break;
+        case EGL_SURFACE_TYPE:		*value = EGL_WINDOW_BIT | EGL_PBUFFER_BIT; break;
+        case EGL_RED_SIZE:
+        case EGL_GREEN_SIZE:
+        case EGL_BLUE_SIZE:
+        case EGL_ALPHA_SIZE:		*value = 8; break;
+        case EGL_DEPTH_SIZE:		*value = index < HOST_EGL_FIRST_SUITABLE_CONFIG ? 24 : 0; break;
+        case EGL_SAMPLES:			*value = 0; break;
+        default:					*value = 0; break;
+    }
+    return EGL_TRUE;
+}
+
+// Only EGL_CONFIG_ID is supported (the only attribute the library chooses by).
+EGLBoolean eglChooseConfig( EGLDisplay dpy, const EGLint * attrib_list, EGLConfig * configs, EGLint config_size, EGLint * num_config )
+{
+    *num_config = 0;
+    for ( int i = 0; attrib_list != NULL && attrib_list[i] != EGL_NONE; i += 2 )
+    {
+        if ( attrib_list[i] == EGL_CONFIG_ID && attrib_list[i + 1] >= 1 && attrib_list[i + 1] <= HOST_EGL_CONFIG_COUNT && config_size > 0 )
+        {
+            configs[0] = (EGLConfig)(intptr_t)attrib_list[i + 1];
+            *num_config = 1;
+        }
+    }
+    return EGL_TRUE;
+}
+
+EGLContext eglCreateContext( EGLDisplay dpy, EGLConfig config, EGLContext share_context, const EGLint * attrib_list )
+{
+    if ( HostEgl_ConfigIndex( config ) < 0 || HostEgl_ConfigIndex( config ) >= HOST_EGL_CONFIG_COUNT )
+    {
+        HostEgl_Fail( EGL_BAD_CONFIG );
+        return EGL_NO_CONTEXT;
+    }
+    HostBackend_Spend( ovrHostBackend_GetParms().CreateContextSeconds );
+    hostContextsCreated.fetch_add( 1, std::memory_order_relaxed );
+    hostLiveContexts.fetch_add( 1, std::memory_order_relaxed );
+    return (EGLContext)new int( hostEglContext.fetch_add( 1, std::memory_order_relaxed ) );
+}
+
+EGLBoolean eglDestroyContext( EGLDisplay dpy, EGLContext ctx )
+{
+    if ( ctx == EGL_NO_CONTEXT )
+    {
+        return HostEgl_Fail( EGL_BAD_CONTEXT );
+    }
+    delete (int *)ctx;
+    hostLiveContexts.fetch_sub( 1, std::memory_order_relaxed );
+    return EGL_TRUE;
+}
+
+EGLSurface eglCreatePbufferSurface( EGLDisplay dpy, EGLConfig config, const EGLint * attrib_list )
+{
+    HostEglSurface * surface = new HostEglSurface;
+    surface->Window = NULL;
+    surface->Width = 0;
+    surface->Height = 0;
+    for ( int i = 0; attrib_list != NULL && attrib_list[i] != EGL_NONE; i += 2 )
+    {
+        if ( attrib_list[i] == EGL_WIDTH )
+        {
+            surface->Width = attrib_list[i + 1];
+        }
+        else if ( attrib_list[i] == EGL_HEIGHT )
+        {
+            surface->Height = attrib_list[i + 1];
+        }
+    }
+    hostLiveSurfaces.fetch_add( 1, std::memory_order_relaxed );
+    return (EGLSurface)surface;
+}
+
+EGLSurface eglCreateWindowSurface( EGLDisplay dpy, EGLConfig config, EGLNativeWindowType win, const EGLint * attrib_list )
+{
+    ANativeWindow * window = (ANativeWindow *)win;
+    if ( window == NULL )
+    {
+        HostEgl_Fail( EGL_BAD_NATIVE_WINDOW );
+        return EGL_NO_SURFACE;
+    }
+    ANativeWindow_acquire( window );
+    HostEglSurface * surface = new HostEglSurface;
+    surface->Window = window;
+    surface->Width = window->Width;
+    surface->Height = window->Height;
+    hostWindowSurfacesCreated.fetch_add( 1, std::memory_order_relaxed );
+    hostLiveSurfaces.fetch_add( 1, std::memory_order_relaxed );
+    return (EGLSurface)surface;
+}
+
+EGLBoolean eglDestroySurface( EGLDisplay dpy, EGLSurface surface )
+{
+    if ( surface == EGL_NO_SURFACE )
+    {
+        return HostEgl_Fail( EGL_BAD_SURFACE );
+    }
+    HostEglSurface * hostSurface = (HostEglSurface *)surface;
+    if ( hostSurface->Window != NULL )
+    {
+        ANativeWindow_release( hostSurface->Window );
+    }
+    delete hostSurface;
+    hostLiveSurfaces.fetch_sub( 1, std::memory_order_relaxed );
+    return EGL_TRUE;
+}
+
+EGLBoolean eglQuerySurface( EGLDisplay dpy, EGLSurface surface, EGLint attribute, EGLint * value )
+{
+    if ( surface == EGL_NO_SURFACE )
+    {
+        return HostEgl_Fail( EGL_BAD_SURFACE );
+    }
+    const HostEglSurface * hostSurface = (const HostEglSurface *)surface;
+    switch ( attribute )
+    {
+        case EGL_WIDTH:		*value = hostSurface->Width; return EGL_TRUE;
+        case EGL_HEIGHT:	*value = hostSurface->Height; return EGL_TRUE;
+        default:			return HostEgl_Fail( EGL_BAD_ATTRIBUTE );
+    }
+}
+
+EGLBoolean eglMakeCurrent( EGLDisplay dpy, EGLSurface draw, EGLSurface read, EGLContext ctx )
+{
+    if ( ctx == EGL_NO_CONTEXT && draw != EGL_NO_SURFACE )
+    {
+        return HostEgl_Fail( EGL_BAD_MATCH );
+    }
+    hostEglCurrentSurface = draw;
+    hostEglCurrentContext = ctx;
+    return EGL_TRUE;
+}
+
+EGLSurface eglGetCurrentSurface( EGLint readdraw )
+{
+    return hostEglCurrentSurface;
+}
+
+// ================================================================================================
+// vrapi
+// ================================================================================================
+struct ovrMobile
+{
+    ovrJava Java;
+};
+
+const char * vrapi_GetVersionString()
+{
+    return "OculusMobileSDKHeadTracking host simulation";
+}
+
+double vrapi_GetTimeInSeconds()
+{
+    return (double)GetTimeInNanoseconds() * 1e-9;
+}
+
+ovrInitializeStatus vrapi_Initialize( const ovrInitParms * initParms )
+{
+    hostInitializeCount.fetch_add( 1, std::memory_order_relaxed );
+    return VRAPI_INITIALIZE_SUCCESS;
+}
+
+void vrapi_Shutdown()
+{
+}
+
+int vrapi_GetSystemPropertyInt( const ovrJava * java, const ovrSystemProperty propType )
+{
+    switch ( propType )
+    {
+        case VRAPI_SYS_PROP_DEVICE_TYPE:			return VRAPI_DEVICE_TYPE_S6;
+        case VRAPI_SYS_PROP_DISPLAY_PIXELS_WIDE:	return 2560;
+        case VRAPI_SYS_PROP_DISPLAY_PIXELS_HIGH:	return 1440;
+        case VRAPI_SYS_PROP_DISPLAY_REFRESH_RATE:	return ovrHostBackend_GetParms().DisplayRefreshRate;
+        default:									return 0;
+    }
+}
+
+float vrapi_GetSystemPropertyFloat( const ovrJava * java, const ovrSystemProperty propType )
+{
+    switch ( propType )
+    {
+        case VRAPI_SYS_PROP_SUGGESTED_EYE_FOV_DEGREES_X:	return ovrHostBackend_GetParms().EyeFovDegreesX;
+        case VRAPI_SYS_PROP_SUGGESTED_EYE_FOV_DEGREES_Y:	return ovrHostBackend_GetParms().EyeFovDegreesY;
+        default:											return (float)vrapi_GetSystemPropertyInt( java, propType );
+    }
+}
+
+const char * vrapi_GetSystemPropertyString( const ovrJava * java, const ovrSystemProperty propType )
+{
+    return "";
+}
+
+int vrapi_GetSystemStatusInt( const ovrJava * java, const ovrSystemStatus statusType )
+{
+    const ovrHostBackendParms parms = ovrHostBackend_GetParms();
+    switch ( statusType )
+    {
+        case VRAPI_SYS_STATUS_DOCKED:					return parms.Docked;
+        case VRAPI_SYS_STATUS_MOUNTED:					return parms.Mounted;
+        case VRAPI_SYS_STATUS_THROTTLED:				return parms.Throttled;
+        case VRAPI_SYS_STATUS_THROTTLED2:				return parms.Throttled2;
+        case VRAPI_SYS_STATUS_THROTTLED_WARNING_LEVEL:	return parms.ThrottledWarningLevel;
+        default:										return (int)vrapi_GetSystemStatusFloat( java, statusType );
+    }
+}
+
+float vrapi_GetSystemStatusFloat( const ovrJava * java, const ovrSystemStatus statusType )
+{
+    const ovrHostBackendParms parms = ovrHostBackend_GetParms();
+    switch ( statusType )
+    {
+        case VRAPI_SYS_STATUS_RENDER_LATENCY_MILLISECONDS:		return parms.RenderLatencyMilliseconds;
+        case VRAPI_SYS_STATUS_TIMEWARP_LATENCY_MILLISECONDS:	return parms.TimeWarpLatencyMilliseconds;
+        case VRAPI_SYS_STATUS_APP_FRAMES_PER_SECOND:			return (float)parms.DisplayRefreshRate;
+        default:												return 0.0f;
+    }
+}
+
+// Like on a device, fails without a window surface (given or current).
+ovrMobile * vrapi_EnterVrMode( const ovrModeParms * parms )
+{
+    HostBackend_Spend( ovrHostBackend_GetParms().EnterVrModeSeconds );
+    const HostEglSurface * surface = (const HostEglSurface *)( parms->WindowSurface != 0 ? (EGLSurface)(size_t)parms->WindowSurface : hostEglCurrentSurface );
+    if ( surface == NULL || surface->Window == NULL )
+    {
+        return NULL;
+    }
+    ovrMobile * ovr = new ovrMobile;
+    ovr->Java = parms->Java;
+    hostEnterVrModeCount.fetch_add( 1, std::memory_order_relaxed );
+    hostLiveVrModes.fetch_add( 1, std::memory_order_relaxed );
+    return ovr;
+}
+
+void vrapi_LeaveVrMode( ovrMobile * ovr )
+{
+    HostBackend_Spend( ovrHostBackend_GetParms().LeaveVrModeSeconds );
+    delete ovr;
+    hostLeaveVrModeCount.fetch_add( 1, std::memory_order_relaxed );
+    hostLiveVrModes.fetch_sub( 1, std::memory_order_relaxed );
+}
+
+// The vsync after the next one, as a device does for a frame that is about to be rendered.
+double vrapi_GetPredictedDisplayTime( ovrMobile * ovr, long long frameIndex )
+{
+    const double period = 1.0 / ovrHostBackend_GetParms().DisplayRefreshRate;
+    return ( floor( vrapi_GetTimeInSeconds() / period ) + 2.0 ) * period;
+}
+
+ovrTracking vrapi_GetPredictedTracking( ovrMobile * ovr, double absTimeInSeconds )
+{
+    HostBackend_Spend( ovrHostBackend_GetParms().PredictedTrackingSeconds );
+    ovrTracking tracking = ovrHostBackend_GetTracking( absTimeInSeconds );
+    tracking.HeadPose.PredictionInSeconds = absTimeInSeconds - vrapi_GetTimeInSeconds();
+    hostPredictedTrackingCount.fetch_add( 1, std::memory_order_relaxed );
+    return tracking;
+}
+
+void vrapi_RecenterPose( ovrMobile * ovr )
+{
+}
+
+void vrapi_SubmitFrame( ovrMobile * ovr, const ovrFrameParms * parms )
+{
+    HostBackend_Spend( ovrHostBackend_GetParms().SubmitFrameSeconds );
+    hostSubmitFrameCount.fetch_add( 1, std::memory_order_relaxed );
+}
+
+// ================================================================================================
+// SystemActivities
+// ================================================================================================
+void SystemActivities_Init( ovrJava * java )
+{
+}
+
+void SystemActivities_Shutdown( ovrJava * java )
+{
+}
+
+void SystemActivities_DisplayError( const ovrJava * java, const ovrSystemActivitiesFatalError error, const char * fileName, const char * messageFormat, ... )
+{
+    char text[1024];
+    va_list args;
+    va_start( args, messageFormat );
+    vsnprintf( text, sizeof( text ), messageFormat, args );
+    va_end( args );
+    __android_log_print( ANDROID_LOG_ERROR, "SystemActivities", "Fatal error %d (%s): %s", (int)error, fileName, text );
+}
+
+}	// extern "C"
+
+#endif // OVR_HEAD_TRACKING_HOST_BACKEND == 1
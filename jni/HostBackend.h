@@ -0,0 +1,164 @@
+#ifndef HOST_BACKEND_H
+#define HOST_BACKEND_H
+
+#include <stdint.h>
+
+#include <jni.h>
+
+// The JNIEnv * JavaVM::AttachCurrentThread stores (a JNIEnv ** on Android, a void ** in the JDK).
+#define BACKEND_JNI_ENV_OUT( env ) ( (void **)( env ) )
+
+// The window types as void * instead of the X11 or the plain unix ones (needs the Khronos headers from 2019
+// on), so an ANativeWindow can be passed to eglCreateWindowSurface as on Android.
+#define EGL_NO_PLATFORM_SPECIFIC_TYPES
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <GLES3/gl3.h>
+#include <GLES3/gl3ext.h>
+
+// VrApi_Types.h only takes the JNI types from jni.h on Android, its own declarations of them clash with
+// the ones of the JDK.
+#if !defined( ANDROID )
+#define ANDROID
+#define HOST_BACKEND_UNDEFINE_ANDROID
+#endif
+#include "VrApi.h"
+#include "VrApi_Helpers.h"
+#include "SystemActivities.h"
+#if defined( HOST_BACKEND_UNDEFINE_ANDROID )
+#undef ANDROID
+#undef HOST_BACKEND_UNDEFINE_ANDROID
+#endif
+
+// ================================================================================================
+// HostBackend
+// The platform functions the library calls, for Linux, so the whole native side (message queue,
+// lifecycle, sampling, export through JNI) can be compiled, tested and benchmarked off-device (see
+// Backend.h). HostBackend.cpp implements the subset of vrapi, SystemActivities, EGL and the Android
+// NDK the library uses as a deterministic simulation:
+// - the head pose is a pure function of the time it is predicted for (yaw and pitch sinusoids, with
+//   their exact velocities and accelerations), so two runs sample the same motion;
+// - the calls that are slow on a device (entering and leaving VR mode, creating the EGL context,
+//   submitting a frame, predicting the tracking) take a configurable time;
+// - the system status values (mounted, docked, throttling) are whatever is configured.
+// EGL does nothing but keep track of the objects it hands out, so no GPU or display is needed.
+// Build everything with -DOVR_HEAD_TRACKING_HOST_BACKEND=1 and HostBackend.cpp (which is not part of
+// Android.mk), with the flags ndk-build uses (-fno-strict-aliasing), for example:
+//   g++ -std=c++11 -O2 -fno-strict-aliasing -shared -fPIC -DOVR_HEAD_TRACKING_HOST_BACKEND=1 -Ijni
+//       -I3rdparty/ovr_sdk_mobile_1.0.3.1/include -I$JAVA_HOME/include -I$JAVA_HOME/include/linux
+//       jni/OculusMobileSDKHeadTracking.cpp jni/OculusMobileSDKHeadTrackingBenchmarks.cpp
+//       jni/HostBackend.cpp -lpthread -o libOculusMobileSDKHeadTracking.so
+// The Java objects (activity, surface) can be any object: ANativeWindow_fromSurface returns a window
+// of the configured size for any of them.
+// HostDriver.cpp builds the same sources into a program instead, which starts, samples and stops a
+// session through the JNI entry points without a Java VM and fails if anything went wrong or leaked:
+// BuildAndRunHost.sh builds and runs it.
+// ================================================================================================
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+// ------------------------------------------------------------------------------------------------
+// <android/log.h>
+// ------------------------------------------------------------------------------------------------
+typedef enum android_LogPriority
+{
+    ANDROID_LOG_UNKNOWN = 0,
+    ANDROID_LOG_DEFAULT,
+    ANDROID_LOG_VERBOSE,
+    ANDROID_LOG_DEBUG,
+    ANDROID_LOG_INFO,
+    ANDROID_LOG_WARN,
+    ANDROID_LOG_ERROR,
+    ANDROID_LOG_FATAL,
+    ANDROID_LOG_SILENT
+} android_LogPriority;
+
+int __android_log_write( int prio, const char * tag, const char * text );
+int __android_log_print( int prio, const char * tag, const char * fmt, ... ) __attribute__(( format( printf, 3, 4 ) ));
+
+// ------------------------------------------------------------------------------------------------
+// <android/native_window.h> and <android/native_window_jni.h>
+// ------------------------------------------------------------------------------------------------
+typedef struct ANativeWindow ANativeWindow;
+
+ANativeWindow * ANativeWindow_fromSurface( JNIEnv * env, jobject surface );
+void ANativeWindow_acquire( ANativeWindow * window );
+void ANativeWindow_release( ANativeWindow * window );
+int32_t ANativeWindow_getWidth( ANativeWindow * window );
+int32_t ANativeWindow_getHeight( ANativeWindow * window );
+
+// ------------------------------------------------------------------------------------------------
+// <sys/system_properties.h>
+// ------------------------------------------------------------------------------------------------
+#define PROP_VALUE_MAX	92
+
+int __system_property_get( const char * name, char * value );
+
+// ------------------------------------------------------------------------------------------------
+// Simulation
+// ------------------------------------------------------------------------------------------------
+typedef struct
+{
+    // The head motion: yaw and pitch sinusoids of the given amplitude (radians) and frequency (Hz).
+    float	YawAmplitude;
+    float	YawFrequency;
+    float	PitchAmplitude;
+    float	PitchFrequency;
+    // vrapi_GetSystemPropertyInt/Float.
+    int		DisplayRefreshRate;
+    float	EyeFovDegreesX;
+    float	EyeFovDegreesY;
+    // vrapi_GetSystemStatusInt/Float.
+    int		Mounted;
+    int		Docked;
+    int		Throttled;
+    int		Throttled2;
+    int		ThrottledWarningLevel;
+    float	RenderLatencyMilliseconds;
+    float	TimeWarpLatencyMilliseconds;
+    // How long the calls take (seconds).
+    double	EnterVrModeSeconds;
+    double	LeaveVrModeSeconds;
+    double	CreateContextSeconds;
+    double	SubmitFrameSeconds;
+    double	PredictedTrackingSeconds;
+    // The size of the windows ANativeWindow_fromSurface returns.
+    int		WindowWidth;
+    int		WindowHeight;
+    // Every log line goes to stderr if set (they are dropped otherwise).
+    bool	PrintLog;
+} ovrHostBackendParms;
+
+// How many times the simulated calls were made, to check what a benchmark or a test went through.
+typedef struct
+{
+    int		Initialize;
+    int		EnterVrMode;
+    int		LeaveVrMode;
+    int		SubmitFrame;
+    long long	PredictedTracking;
+    int		ContextsCreated;
+    int		WindowSurfacesCreated;
+    // Objects that are still alive (leaks).
+    int		LiveContexts;
+    int		LiveSurfaces;
+    int		LiveWindows;
+    int		LiveVrModes;
+} ovrHostBackendCounters;
+
+// The Gear VR values (S6, 60 Hz), a slow look around and device-like latencies.
+ovrHostBackendParms ovrHostBackend_DefaultParms();
+// Any thread, any time. Takes effect on the next call.
+void ovrHostBackend_SetParms( const ovrHostBackendParms * parms );
+ovrHostBackendParms ovrHostBackend_GetParms();
+ovrHostBackendCounters ovrHostBackend_GetCounters();
+// The pose vrapi_GetPredictedTracking returns for the absolute time, without the latency.
+ovrTracking ovrHostBackend_GetTracking( double absTimeInSeconds );
+
+#if defined( __cplusplus )
+}	// extern "C"
+#endif
+
+#endif // HOST_BACKEND_H
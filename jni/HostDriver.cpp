@@ -0,0 +1,431 @@
+// Only part of the host build (see HostBackend.h), never of Android.mk.
+#ifndef OVR_HEAD_TRACKING_HOST_BACKEND
+#define OVR_HEAD_TRACKING_HOST_BACKEND 1
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include <atomic>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "Backend.h"
+#include "Clock.h"
+
+#if OVR_HEAD_TRACKING_HOST_BACKEND == 1
+
+// ================================================================================================
+// HostDriver
+// A program that runs the library on Linux through the same JNI entry points the Java class calls:
+// it starts a session, lets it enter VR mode on a surface, samples it with getData and the sampling
+// thread, then stops it and checks nothing leaked. It exits with 0 if everything went as expected,
+// so the host build can be checked with a single run (see HostBackend.h for how to build it).
+// No Java VM is needed: the JNIEnv and JavaVM the library gets are implemented here, for the JNI
+// functions the library calls only, with Java objects that hold their fields by name.
+// ================================================================================================
+
+// The state of the simulated VR mode (see VrModeStateMachine).
+#define HOST_DRIVER_STATE_VR_MODE	2
+#define HOST_DRIVER_SAMPLE_DOUBLE_COUNT	5
+
+// ================================================================================================
+// JNI
+// Every object lives until the program exits. The functions lock a single mutex, so any thread
+// (the tracking thread, the delivery thread, the sampler) can use the one JNIEnv there is.
+// ================================================================================================
+struct HostJavaObject
+{
+    std::string ClassName;
+    std::map<std::string, double> Fields;
+    std::vector<double> Values;
+    std::vector<HostJavaObject *> Elements;
+    std::string Chars;
+};
+
+static pthread_mutex_t hostJniMutex = PTHREAD_MUTEX_INITIALIZER;
+static std::vector<HostJavaObject *> hostJniObjects;
+static std::set<std::string> hostJniNames;
+static JNINativeInterface_ hostJniFunctions;
+static JNIEnv hostJniEnv;
+static JNIInvokeInterface_ hostJavaVMFunctions;
+static JavaVM hostJavaVM;
+
+// headTrackingStartedFromNative and headTrackingErrorFromNative.
+static std::atomic<int> hostStartedCount( 0 );
+static std::atomic<int> hostErrorCount( 0 );
+
+static HostJavaObject * HostJni_NewObject( const char * className )
+{
+    HostJavaObject * object = new HostJavaObject;
+    object->ClassName = className;
+    pthread_mutex_lock( &hostJniMutex );
+    hostJniObjects.push_back( object );
+    pthread_mutex_unlock( &hostJniMutex );
+    return object;
+}
+
+// Method and field IDs are their names.
+static const std::string * HostJni_Intern( const char * name )
+{
+    pthread_mutex_lock( &hostJniMutex );
+    const std::string * interned = &*hostJniNames.insert( name ).first;
+    pthread_mutex_unlock( &hostJniMutex );
+    return interned;
+}
+
+static double HostJni_GetField( jobject obj, const char * name )
+{
+    pthread_mutex_lock( &hostJniMutex );
+    const double value = ( (HostJavaObject *)obj )->Fields[name];
+    pthread_mutex_unlock( &hostJniMutex );
+    return value;
+}
+
+static void HostJni_SetField( jobject obj, jfieldID fieldID, const double value )
+{
+    pthread_mutex_lock( &hostJniMutex );
+    ( (HostJavaObject *)obj )->Fields[*(const std::string *)fieldID] = value;
+    pthread_mutex_unlock( &hostJniMutex );
+}
+
+static void HostJni_SetArrayRegion( jarray array, jsize start, jsize len, const double * buf )
+{
+    pthread_mutex_lock( &hostJniMutex );
+    std::vector<double> & values = ( (HostJavaObject *)array )->Values;
+    for ( jsize i = 0; i < len && start + i < (jsize)values.size(); i++ )
+    {
+        values[start + i] = buf[i];
+    }
+    pthread_mutex_unlock( &hostJniMutex );
+}
+
+static void JNICALL HostJni_ExceptionDescribe( JNIEnv * env )
+{
+}
+
+static void JNICALL HostJni_ExceptionClear( JNIEnv * env )
+{
+}
+
+static jboolean JNICALL HostJni_ExceptionCheck( JNIEnv * env )
+{
+    return JNI_FALSE;
+}
+
+static jobject JNICALL HostJni_NewGlobalRef( JNIEnv * env, jobject lobj )
+{
+    return lobj;
+}
+
+static void JNICALL HostJni_DeleteRef( JNIEnv * env, jobject obj )
+{
+}
+
+static jboolean JNICALL HostJni_IsSameObject( JNIEnv * env, jobject obj1, jobject obj2 )
+{
+    return obj1 == obj2 ? JNI_TRUE : JNI_FALSE;
+}
+
+// An object is its own class: the IDs are names, they do not depend on it.
+static jclass JNICALL HostJni_GetObjectClass( JNIEnv * env, jobject obj )
+{
+    return (jclass)obj;
+}
+
+static jmethodID JNICALL HostJni_GetMethodID( JNIEnv * env, jclass clazz, const char * name, const char * sig )
+{
+    return (jmethodID)HostJni_Intern( name );
+}
+
+static jfieldID JNICALL HostJni_GetFieldID( JNIEnv * env, jclass clazz, const char * name, const char * sig )
+{
+    return (jfieldID)HostJni_Intern( name );
+}
+
+static void JNICALL HostJni_CallVoidMethodV( JNIEnv * env, jobject obj, jmethodID methodID, va_list args )
+{
+    const std::string & name = *(const std::string *)methodID;
+    if ( name == "headTrackingStartedFromNative" )
+    {
+        // The floats are promoted to double
+        const double eyeFOVX = va_arg( args, double );
+        const double eyeFOVY = va_arg( args, double );
+        const double interpupillaryDistance = va_arg( args, double );
+        printf( "Started: eye FOV %.1f x %.1f, IPD %.4f\n", eyeFOVX, eyeFOVY, interpupillaryDistance );
+        hostStartedCount.fetch_add( 1, std::memory_order_relaxed );
+    }
+    else if ( name == "headTrackingErrorFromNative" )
+    {
+        printf( "Error: %s\n", ( (HostJavaObject *)va_arg( args, jstring ) )->Chars.c_str() );
+        hostErrorCount.fetch_add( 1, std::memory_order_relaxed );
+    }
+}
+
+static void JNICALL HostJni_SetIntField( JNIEnv * env, jobject obj, jfieldID fieldID, jint val )
+{
+    HostJni_SetField( obj, fieldID, val );
+}
+
+static void JNICALL HostJni_SetFloatField( JNIEnv * env, jobject obj, jfieldID fieldID, jfloat val )
+{
+    HostJni_SetField( obj, fieldID, val );
+}
+
+static void JNICALL HostJni_SetDoubleField( JNIEnv * env, jobject obj, jfieldID fieldID, jdouble val )
+{
+    HostJni_SetField( obj, fieldID, val );
+}
+
+static jstring JNICALL HostJni_NewStringUTF( JNIEnv * env, const char * utf )
+{
+    HostJavaObject * string = HostJni_NewObject( "java/lang/String" );
+    string->Chars = utf;
+    return (jstring)string;
+}
+
+static const char * JNICALL HostJni_GetStringUTFChars( JNIEnv * env, jstring str, jboolean * isCopy )
+{
+    if ( isCopy != NULL )
+    {
+        *isCopy = JNI_FALSE;
+    }
+    return ( (HostJavaObject *)str )->Chars.c_str();
+}
+
+static void JNICALL HostJni_ReleaseStringUTFChars( JNIEnv * env, jstring str, const char * chars )
+{
+}
+
+static jsize JNICALL HostJni_GetArrayLength( JNIEnv * env, jarray array )
+{
+    const HostJavaObject * object = (const HostJavaObject *)array;
+    return (jsize)( object->Elements.empty() ? object->Values.size() : object->Elements.size() );
+}
+
+static jobject JNICALL HostJni_GetObjectArrayElement( JNIEnv * env, jobjectArray array, jsize index )
+{
+    return (jobject)( (HostJavaObject *)array )->Elements[index];
+}
+
+static jfloatArray JNICALL HostJni_NewFloatArray( JNIEnv * env, jsize len )
+{
+    HostJavaObject * array = HostJni_NewObject( "[F" );
+    array->Values.resize( len );
+    return (jfloatArray)array;
+}
+
+static jdoubleArray JNICALL HostJni_NewDoubleArray( JNIEnv * env, jsize len )
+{
+    HostJavaObject * array = HostJni_NewObject( "[D" );
+    array->Values.resize( len );
+    return (jdoubleArray)array;
+}
+
+static void JNICALL HostJni_SetIntArrayRegion( JNIEnv * env, jintArray array, jsize start, jsize len, const jint * buf )
+{
+    std::vector<double> values( buf, buf + len );
+    HostJni_SetArrayRegion( array, start, len, values.empty() ? NULL : &values[0] );
+}
+
+static void JNICALL HostJni_SetFloatArrayRegion( JNIEnv * env, jfloatArray array, jsize start, jsize len, const jfloat * buf )
+{
+    std::vector<double> values( buf, buf + len );
+    HostJni_SetArrayRegion( array, start, len, values.empty() ? NULL : &values[0] );
+}
+
+static void JNICALL HostJni_SetDoubleArrayRegion( JNIEnv * env, jdoubleArray array, jsize start, jsize len, const jdouble * buf )
+{
+    HostJni_SetArrayRegion( array, start, len, buf );
+}
+
+static jint JNICALL HostJni_GetJavaVM( JNIEnv * env, JavaVM ** vm )
+{
+    *vm = &hostJavaVM;
+    return JNI_OK;
+}
+
+// Every thread is attached to the one JNIEnv.
+static jint JNICALL HostJavaVM_AttachCurrentThread( JavaVM * vm, void ** penv, void * args )
+{
+    *penv = &hostJniEnv;
+    return JNI_OK;
+}
+
+static jint JNICALL HostJavaVM_DetachCurrentThread( JavaVM * vm )
+{
+    return JNI_OK;
+}
+
+static jint JNICALL HostJavaVM_GetEnv( JavaVM * vm, void ** penv, jint version )
+{
+    *penv = &hostJniEnv;
+    return JNI_OK;
+}
+
+// Any other JNI function is NULL (the library does not call it).
+static void HostJni_Init()
+{
+    memset( &hostJniFunctions, 0, sizeof( hostJniFunctions ) );
+    hostJniFunctions.ExceptionDescribe = HostJni_ExceptionDescribe;
+    hostJniFunctions.ExceptionClear = HostJni_ExceptionClear;
+    hostJniFunctions.ExceptionCheck = HostJni_ExceptionCheck;
+    hostJniFunctions.NewGlobalRef = HostJni_NewGlobalRef;
+    hostJniFunctions.DeleteGlobalRef = HostJni_DeleteRef;
+    hostJniFunctions.DeleteLocalRef = HostJni_DeleteRef;
+    hostJniFunctions.IsSameObject = HostJni_IsSameObject;
+    hostJniFunctions.GetObjectClass = HostJni_GetObjectClass;
+    hostJniFunctions.GetMethodID = HostJni_GetMethodID;
+    hostJniFunctions.GetFieldID = HostJni_GetFieldID;
+    hostJniFunctions.CallVoidMethodV = HostJni_CallVoidMethodV;
+    hostJniFunctions.SetIntField = HostJni_SetIntField;
+    hostJniFunctions.SetFloatField = HostJni_SetFloatField;
+    hostJniFunctions.SetDoubleField = HostJni_SetDoubleField;
+    hostJniFunctions.NewStringUTF = HostJni_NewStringUTF;
+    hostJniFunctions.GetStringUTFChars = HostJni_GetStringUTFChars;
+    hostJniFunctions.ReleaseStringUTFChars = HostJni_ReleaseStringUTFChars;
+    hostJniFunctions.GetArrayLength = HostJni_GetArrayLength;
+    hostJniFunctions.GetObjectArrayElement = HostJni_GetObjectArrayElement;
+    hostJniFunctions.NewFloatArray = HostJni_NewFloatArray;
+    hostJniFunctions.NewDoubleArray = HostJni_NewDoubleArray;
+    hostJniFunctions.SetIntArrayRegion = HostJni_SetIntArrayRegion;
+    hostJniFunctions.SetFloatArrayRegion = HostJni_SetFloatArrayRegion;
+    hostJniFunctions.SetDoubleArrayRegion = HostJni_SetDoubleArrayRegion;
+    hostJniFunctions.GetJavaVM = HostJni_GetJavaVM;
+    hostJniEnv.functions = &hostJniFunctions;
+
+    memset( &hostJavaVMFunctions, 0, sizeof( hostJavaVMFunctions ) );
+    hostJavaVMFunctions.AttachCurrentThread = HostJavaVM_AttachCurrentThread;
+    hostJavaVMFunctions.DetachCurrentThread = HostJavaVM_DetachCurrentThread;
+    hostJavaVMFunctions.GetEnv = HostJavaVM_GetEnv;
+    hostJavaVM.functions = &hostJavaVMFunctions;
+}
+
+static void HostJni_Shutdown()
+{
+    for ( size_t i = 0; i < hostJniObjects.size(); i++ )
+    {
+        delete hostJniObjects[i];
+    }
+    hostJniObjects.clear();
+}
+
+// ================================================================================================
+// The JNI entry points of OculusMobileSDKHeadTracking.cpp the driver calls.
+// ================================================================================================
+extern "C"
+{
+    JNIEXPORT jlong JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeStart(JNIEnv* jniEnv, jobject obj, jobject activityJObject, jobject oculusMobileSDKHeadTrackingJObject, jobject dataJObject, jboolean trackingOnly);
+    JNIEXPORT void JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeResume(JNIEnv* jniEnv, jobject obj, jlong objectPtr);
+    JNIEXPORT void JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativePause(JNIEnv* jniEnv, jobject obj, jlong objectPtr);
+    JNIEXPORT void JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeStop(JNIEnv* jniEnv, jobject obj, jlong objectPtr);
+    JNIEXPORT void JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeSurfaceCreated(JNIEnv* jniEnv, jobject obj, jlong objectPtr, jobject surfaceJObject);
+    JNIEXPORT void JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeSurfaceDestroyed(JNIEnv* jniEnv, jobject obj, jlong objectPtr);
+    JNIEXPORT void JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeGetData(JNIEnv* jniEnv, jobject obj, jlong objectPtr);
+    JNIEXPORT void JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeSetSamplingRate(JNIEnv* jniEnv, jobject obj, jlong objectPtr, jint samplesPerSecond);
+    JNIEXPORT jint JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeReadSamples(JNIEnv* jniEnv, jobject obj, jlong objectPtr, jdoubleArray samplesJDoubleArray);
+    JNIEXPORT jint JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeGetVrModeState(JNIEnv* jniEnv, jobject obj, jlong objectPtr);
+    JNIEXPORT jboolean JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeReleaseEglResources(JNIEnv* jniEnv, jclass clazz);
+}
+
+// ================================================================================================
+// Driver
+// ================================================================================================
+static bool HostDriver_Check( const bool condition, const char * what )
+{
+    printf( "%s: %s\n", condition ? "OK  " : "FAIL", what );
+    return condition;
+}
+
+static bool HostDriver_WaitForVrMode( JNIEnv * env, const jlong objectPtr, const double timeoutInSeconds )
+{
+    const long long deadline = GetTimeInNanoseconds() + (long long)( timeoutInSeconds * 1e9 );
+    while ( GetTimeInNanoseconds() < deadline )
+    {
+        if ( hostStartedCount.load( std::memory_order_relaxed ) > 0 &&
+             Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeGetVrModeState( env, NULL, objectPtr ) == HOST_DRIVER_STATE_VR_MODE )
+        {
+            return true;
+        }
+        usleep( 1000 );
+    }
+    return false;
+}
+
+int main( int argc, char ** argv )
+{
+    const int queries = argc > 1 ? atoi( argv[1] ) : 120;
+
+    ovrHostBackendParms parms = ovrHostBackend_DefaultParms();
+    parms.PrintLog = getenv( "OVR_HOST_LOG" ) != NULL;
+    ovrHostBackend_SetParms( &parms );
+
+    HostJni_Init();
+    JNIEnv * env = &hostJniEnv;
+    jobject activity = (jobject)HostJni_NewObject( "android/app/Activity" );
+    jobject headTracking = (jobject)HostJni_NewObject( "com/judax/oculusmobilesdkheadtracking/OculusMobileSDKHeadTracking" );
+    jobject data = (jobject)HostJni_NewObject( "com/judax/oculusmobilesdkheadtracking/OculusMobileSDKHeadTrackingData" );
+    jobject surface = (jobject)HostJni_NewObject( "android/view/Surface" );
+    bool passed = true;
+
+    // Start, resume and create the surface as the Java class does, then wait for the VR mode
+    const jlong objectPtr = Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeStart( env, headTracking, activity, headTracking, data, JNI_FALSE );
+    if ( !HostDriver_Check( objectPtr != 0, "start" ) )
+    {
+        HostJni_Shutdown();
+        return 1;
+    }
+    Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeResume( env, headTracking, objectPtr );
+    Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeSurfaceCreated( env, headTracking, objectPtr, surface );
+    passed = HostDriver_Check( HostDriver_WaitForVrMode( env, objectPtr, 5.0 ), "entered VR mode" ) && passed;
+
+    // getData at the display rate and the sampling thread alongside
+    Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeSetSamplingRate( env, headTracking, objectPtr, 500 );
+    int validQueries = 0;
+    double lastTimeStamp = 0.0;
+    for ( int i = 0; i < queries; i++ )
+    {
+        Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeGetData( env, headTracking, objectPtr );
+        const double timeStamp = HostJni_GetField( data, "timeStamp" );
+        const double x = HostJni_GetField( data, "orientationX" );
+        const double y = HostJni_GetField( data, "orientationY" );
+        const double z = HostJni_GetField( data, "orientationZ" );
+        const double w = HostJni_GetField( data, "orientationW" );
+        if ( timeStamp >= lastTimeStamp && fabs( x * x + y * y + z * z + w * w - 1.0 ) < 1e-3 )
+        {
+            validQueries++;
+        }
+        lastTimeStamp = timeStamp;
+        usleep( 1000000 / parms.DisplayRefreshRate );
+    }
+    passed = HostDriver_Check( validQueries == queries, "getData returned unit orientations in time order" ) && passed;
+    jdoubleArray samples = HostJni_NewDoubleArray( env, 1024 * HOST_DRIVER_SAMPLE_DOUBLE_COUNT );
+    const int sampleCount = Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeReadSamples( env, headTracking, objectPtr, samples );
+    printf( "%d queries, %d samples\n", queries, sampleCount );
+    passed = HostDriver_Check( sampleCount > 0, "the sampling thread sampled" ) && passed;
+    Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeSetSamplingRate( env, headTracking, objectPtr, 0 );
+
+    // Pause, destroy the surface and stop as the Java class does
+    Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativePause( env, headTracking, objectPtr );
+    Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeSurfaceDestroyed( env, headTracking, objectPtr );
+    Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeStop( env, headTracking, objectPtr );
+    Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeReleaseEglResources( env, NULL );
+
+    const ovrHostBackendCounters counters = ovrHostBackend_GetCounters();
+    passed = HostDriver_Check( hostErrorCount.load() == 0, "no error reported" ) && passed;
+    passed = HostDriver_Check( counters.EnterVrMode == counters.LeaveVrMode && counters.LiveVrModes == 0, "left VR mode" ) && passed;
+    passed = HostDriver_Check( counters.LiveContexts == 0 && counters.LiveSurfaces == 0 && counters.LiveWindows == 0, "no EGL object or window leaked" ) && passed;
+
+    HostJni_Shutdown();
+    printf( "%s\n", passed ? "PASSED" : "FAILED" );
+    return passed ? 0 : 1;
+}
+
+#endif // OVR_HEAD_TRACKING_HOST_BACKEND == 1
@@ -0,0 +1,50 @@
+#ifndef JAVA_THREAD_H
+#define JAVA_THREAD_H
+
+#include <pthread.h>
+
+#include "Backend.h"
+
+// ================================================================================================
+// Java thread attachment
+// Attaches the calling native thread to the Java VM the first time it needs a JNIEnv and keeps it
+// attached for the rest of its life, so threads that call into Java on every tick do not pay an
+// AttachCurrentThread/DetachCurrentThread pair each time. The detach is done by the destructor of a
+// thread specific key, which runs when the thread exits (the VM aborts if a thread exits attached).
+// ================================================================================================
+static pthread_key_t javaThreadKey;
+static pthread_once_t javaThreadKeyOnce = PTHREAD_ONCE_INIT;
+
+static inline void JavaThread_Detach( void * javaVM )
+{
+    ( (JavaVM *)javaVM )->DetachCurrentThread();
+}
+
+static inline void JavaThread_CreateKey()
+{
+    pthread_key_create( &javaThreadKey, JavaThread_Detach );
+}
+
+// Returns the JNIEnv of the calling thread, attaching it (as name) if needed. NULL on failure.
+static inline JNIEnv * JavaThread_GetEnv( JavaVM * javaVM, const char * name )
+{
+    JNIEnv * env = NULL;
+    if ( javaVM->GetEnv( (void **)&env, JNI_VERSION_1_6 ) == JNI_OK )
+    {
+        return env;
+    }
+    pthread_once( &javaThreadKeyOnce, JavaThread_CreateKey );
+    JavaVMAttachArgs attachArgs;
+    attachArgs.version = JNI_VERSION_1_6;
+    // char * in the JDK
+    attachArgs.name = (char *)name;
+    attachArgs.group = NULL;
+    if ( javaVM->AttachCurrentThread( BACKEND_JNI_ENV_OUT( &env ), &attachArgs ) != JNI_OK )
+    {
+        return NULL;
+    }
+    pthread_setspecific( javaThreadKey, javaVM );
+    return env;
+}
+
+#endif // JAVA_THREAD_H
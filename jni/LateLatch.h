@@ -0,0 +1,105 @@
+#ifndef LATE_LATCH_H
+#define LATE_LATCH_H
+
+#include "VrApi_Types.h"
+#include "VrApi_Helpers.h"
+#include "PoseMath.h"
+#include "SeqLock.h"
+
+// ================================================================================================
+// LateLatch
+// Re-predicts the newest cached tracking sample to a later target time using the sample's own
+// angular/linear velocities and accelerations instead of a new (slow) vrapi_GetPredictedTracking
+// call. It only reads a SeqLock and does some quaternion math, so it can be called from the render
+// thread right before submission.
+// The VrApi velocities and accelerations are expressed in world space, so the delta rotation is
+// applied on the left of the cached orientation.
+// The cached sample is the raw tracking (no head model). The head model is only applied here, to the
+// re-predicted orientation, when a position is requested and the sample has no position tracking.
+// ================================================================================================
+class LateLatch
+{
+private:
+    // Extrapolating further than this is more harmful than helpful.
+    static constexpr double MAX_EXTRAPOLATION_SECONDS = 0.1;
+
+    SeqLock<ovrTracking> latestTracking;
+    ovrHeadModelParms headModelParms;
+
+    // Moves the tracking forward to targetTime in place. Returns the applied world space delta rotation.
+    static ovrQuatf extrapolate(ovrTracking& tracking, const double targetTime)
+    {
+        ovrRigidBodyPosef& headPose = tracking.HeadPose;
+        double dt = targetTime - headPose.TimeInSeconds;
+        dt = dt > MAX_EXTRAPOLATION_SECONDS ? MAX_EXTRAPOLATION_SECONDS : (dt < -MAX_EXTRAPOLATION_SECONDS ? -MAX_EXTRAPOLATION_SECONDS : dt);
+        const float t = (float)dt;
+        const float halfT2 = 0.5f * t * t;
+
+        const ovrQuatf delta = ovrQuatf_CreateFromRotationVector(
+            headPose.AngularVelocity.x * t + headPose.AngularAcceleration.x * halfT2,
+            headPose.AngularVelocity.y * t + headPose.AngularAcceleration.y * halfT2,
+            headPose.AngularVelocity.z * t + headPose.AngularAcceleration.z * halfT2);
+        headPose.Pose.Orientation = ovrQuatf_Multiply(&delta, &headPose.Pose.Orientation);
+        headPose.Pose.Position.x += headPose.LinearVelocity.x * t + headPose.LinearAcceleration.x * halfT2;
+        headPose.Pose.Position.y += headPose.LinearVelocity.y * t + headPose.LinearAcceleration.y * halfT2;
+        headPose.Pose.Position.z += headPose.LinearVelocity.z * t + headPose.LinearAcceleration.z * halfT2;
+        headPose.AngularVelocity.x += headPose.AngularAcceleration.x * t;
+        headPose.AngularVelocity.y += headPose.AngularAcceleration.y * t;
+        headPose.AngularVelocity.z += headPose.AngularAcceleration.z * t;
+        headPose.LinearVelocity.x += headPose.LinearAcceleration.x * t;
+        headPose.LinearVelocity.y += headPose.LinearAcceleration.y * t;
+        headPose.LinearVelocity.z += headPose.LinearAcceleration.z * t;
+        headPose.TimeInSeconds += dt;
+        headPose.PredictionInSeconds += dt;
+        return delta;
+    }
+
+public:
+    LateLatch(): headModelParms(vrapi_DefaultHeadModelParms())
+    {
+    }
+
+    // Called by whoever samples the tracking.
+    void update(const ovrTracking& tracking)
+    {
+        latestTracking.write(tracking);
+    }
+
+    // Re-predicts the whole cached tracking (raw, no head model) to the absolute time targetTime.
+    // Returns false if there is no sample yet.
+    bool predictTracking(const double targetTime, ovrTracking* result) const
+    {
+        if (latestTracking.read(*result) == 0)
+        {
+            return false;
+        }
+        extrapolate(*result, targetTime);
+        return true;
+    }
+
+    // Predicts the cached sample to the absolute time targetTime (same time base as
+    // ovrRigidBodyPosef::TimeInSeconds). Either output can be NULL. deltaRotation is the world
+    // space rotation to apply on the left of the cached orientation.
+    // Returns false if there is no sample yet.
+    bool predict(const double targetTime, ovrPosef* pose, ovrQuatf* deltaRotation) const
+    {
+        ovrTracking tracking;
+        if (latestTracking.read(tracking) == 0)
+        {
+            return false;
+        }
+        const ovrQuatf delta = extrapolate(tracking, targetTime);
+        if (deltaRotation != NULL)
+        {
+            *deltaRotation = delta;
+        }
+        if (pose != NULL)
+        {
+            // Without position tracking the position comes from the head model.
+            *pose = vrapi_ApplyHeadModel(&headModelParms, &tracking).HeadPose.Pose;
+        }
+        return true;
+    }
+};
+
+#endif // LATE_LATCH_H
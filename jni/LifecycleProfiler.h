@@ -0,0 +1,165 @@
+#ifndef LIFECYCLE_PROFILER_H
+#define LIFECYCLE_PROFILER_H
+
+#include <atomic>
+
+#include "Clock.h"
+
+// ================================================================================================
+// LifecycleProfiler
+// Where the time goes while starting, pausing, resuming and stopping. Scoped timers (PROFILE_PHASE)
+// around the slow calls add their duration to the phase of the current lifecycle (from one session
+// start to its stop). The last LIFECYCLE_HISTORY_SIZE lifecycles are kept, for the whole process, so
+// they can still be read after the session that was profiled is gone.
+// Define LIFECYCLE_PROFILER_ENABLED to 0 (for example in LOCAL_CFLAGS) to build the timers out: the
+// macros then expand to nothing and no lifecycle is recorded.
+// ================================================================================================
+#ifndef LIFECYCLE_PROFILER_ENABLED
+#define LIFECYCLE_PROFILER_ENABLED 1
+#endif
+
+class LifecycleProfiler
+{
+public:
+    enum Phases
+    {
+        PHASE_JNI_CACHING,
+        PHASE_THREAD_CREATE,
+        PHASE_SYSTEM_ACTIVITIES_INIT,
+        PHASE_VRAPI_INITIALIZE,
+        PHASE_EGL_CONTEXT_CREATE,
+        PHASE_EGL_SURFACE_CREATE,
+        PHASE_ENTER_VR_MODE,
+        PHASE_LEAVE_VR_MODE,
+        PHASE_EGL_SURFACE_DESTROY,
+        PHASE_EGL_CONTEXT_RELEASE,
+        PHASE_VRAPI_SHUTDOWN,
+        PHASE_THREAD_JOIN,
+        PHASE_COUNT
+    };
+
+    static const int LIFECYCLE_HISTORY_SIZE = 8;
+    // count, total (ms), max (ms)
+    static const int DOUBLES_PER_PHASE = 3;
+
+private:
+    struct Phase
+    {
+        std::atomic<unsigned int> count;
+        std::atomic<long long> totalNanoseconds;
+        std::atomic<long long> maxNanoseconds;
+    };
+
+    struct Lifecycle
+    {
+        Phase phases[PHASE_COUNT];
+    };
+
+    Lifecycle lifecycles[LIFECYCLE_HISTORY_SIZE];
+    // How many lifecycles have begun. The current one is lifecycleCount - 1.
+    std::atomic<unsigned int> lifecycleCount;
+
+    LifecycleProfiler(): lifecycleCount(0)
+    {
+        for (int i = 0; i < LIFECYCLE_HISTORY_SIZE; i++)
+        {
+            clear(lifecycles[i]);
+        }
+    }
+
+    static void clear(Lifecycle& lifecycle)
+    {
+        for (int phase = 0; phase < PHASE_COUNT; phase++)
+        {
+            lifecycle.phases[phase].count.store(0, std::memory_order_relaxed);
+            lifecycle.phases[phase].totalNanoseconds.store(0, std::memory_order_relaxed);
+            lifecycle.phases[phase].maxNanoseconds.store(0, std::memory_order_relaxed);
+        }
+    }
+
+public:
+    static LifecycleProfiler& get()
+    {
+        static LifecycleProfiler profiler;
+        return profiler;
+    }
+
+    // The phases recorded from now on go to a new lifecycle (the oldest one is forgotten).
+    void beginLifecycle()
+    {
+        const unsigned int count = lifecycleCount.load(std::memory_order_relaxed);
+        clear(lifecycles[count % LIFECYCLE_HISTORY_SIZE]);
+        lifecycleCount.store(count + 1, std::memory_order_release);
+    }
+
+    // Any thread. Dropped if no lifecycle has begun.
+    void record(const int phase, const long long nanoseconds)
+    {
+        const unsigned int count = lifecycleCount.load(std::memory_order_acquire);
+        if (count == 0)
+        {
+            return;
+        }
+        Phase& p = lifecycles[(count - 1) % LIFECYCLE_HISTORY_SIZE].phases[phase];
+        p.totalNanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed);
+        long long max = p.maxNanoseconds.load(std::memory_order_relaxed);
+        while (nanoseconds > max && !p.maxNanoseconds.compare_exchange_weak(max, nanoseconds, std::memory_order_relaxed))
+        {
+        }
+        p.count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Copies the kept lifecycles, oldest first, as PHASE_COUNT * DOUBLES_PER_PHASE doubles each. Returns
+    // how many were copied.
+    int getLifecycles(double values[LIFECYCLE_HISTORY_SIZE * PHASE_COUNT * DOUBLES_PER_PHASE]) const
+    {
+        const unsigned int count = lifecycleCount.load(std::memory_order_acquire);
+        const unsigned int first = count > (unsigned int)LIFECYCLE_HISTORY_SIZE ? count - LIFECYCLE_HISTORY_SIZE : 0;
+        int copied = 0;
+        for (unsigned int index = first; index < count; index++, copied++)
+        {
+            const Lifecycle& lifecycle = lifecycles[index % LIFECYCLE_HISTORY_SIZE];
+            for (int phase = 0; phase < PHASE_COUNT; phase++)
+            {
+                double* phaseValues = values + (copied * PHASE_COUNT + phase) * DOUBLES_PER_PHASE;
+                phaseValues[0] = lifecycle.phases[phase].count.load(std::memory_order_relaxed);
+                phaseValues[1] = lifecycle.phases[phase].totalNanoseconds.load(std::memory_order_relaxed) * 1e-6;
+                phaseValues[2] = lifecycle.phases[phase].maxNanoseconds.load(std::memory_order_relaxed) * 1e-6;
+            }
+        }
+        return copied;
+    }
+
+    // Adds the time until the end of the scope to the phase.
+    class ScopedTimer
+    {
+    private:
+        const int phase;
+        const long long startTime;
+
+        ScopedTimer(const ScopedTimer&);
+        ScopedTimer& operator=(const ScopedTimer&);
+
+    public:
+        explicit ScopedTimer(const int phase): phase(phase), startTime(GetTimeInNanoseconds())
+        {
+        }
+
+        ~ScopedTimer()
+        {
+            LifecycleProfiler::get().record(phase, GetTimeInNanoseconds() - startTime);
+        }
+    };
+};
+
+#if LIFECYCLE_PROFILER_ENABLED == 1
+#define PROFILE_LIFECYCLE_BEGIN()	LifecycleProfiler::get().beginLifecycle()
+#define PROFILE_PHASE_CONCAT( a, b )	a##b
+#define PROFILE_PHASE_NAME( line )	PROFILE_PHASE_CONCAT( phaseTimer, line )
+#define PROFILE_PHASE( phase )		LifecycleProfiler::ScopedTimer PROFILE_PHASE_NAME( __LINE__ )( LifecycleProfiler::phase )
+#else
+#define PROFILE_LIFECYCLE_BEGIN()
+#define PROFILE_PHASE( phase )
+#endif
+
+#endif // LIFECYCLE_PROFILER_H
@@ -2,21 +2,39 @@
 #include <unistd.h> // fot gettid
 
 #include <sched.h> // for sched_yield
+#include <errno.h> // for ETIMEDOUT
+#include <time.h> // for clock_gettime
+#include <stdio.h> // for vsnprintf
+#include <stdarg.h> // for va_list
+#include <math.h> // for floor
 
 #include <pthread.h>
+#include <semaphore.h>
 
-#include <android/native_window_jni.h>	// for native window JNI
-#include <android/input.h>
-#include <android/log.h>
+#include <atomic>
+#include <vector>
 
-#include <EGL/egl.h>
-#include <EGL/eglext.h>
-#include <GLES3/gl3.h>
-#include <GLES3/gl3ext.h>
+// vrapi, SystemActivities, EGL and the Android NDK
+#include "Backend.h"
 
-#include "VrApi.h"
-#include "VrApi_Helpers.h"
-#include "SystemActivities.h"
+#include "PredictionAccuracy.h"
+#include "LateLatch.h"
+#include "AdaptiveHorizon.h"
+#include "PoseSampler.h"
+#include "SampleRing.h"
+#include "ThreadConfiguration.h"
+#include "PerformanceGovernor.h"
+#include "GuardedPointer.h"
+#include "JavaThread.h"
+#include "WorkerPool.h"
+#include "ResumeStatistics.h"
+#include "LifecycleProfiler.h"
+#include "EglConfigCache.h"
+#include "GraphicsFootprint.h"
+#include "VrModeStateMachine.h"
+#include "PoseRecorder.h"
+#include "PoseReplay.h"
+#include "FlightRecorder.h"
 
 #define LOG_TAG "OculusMobileSDKHeadTracking"
 #define LOG_ERROR(...) __android_log_print( ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__ )
@@ -162,6 +180,38 @@ static void ovrMessageQueue_SleepUntilMessage( ovrMessageQueue * messageQueue )
     pthread_mutex_unlock( &messageQueue->Mutex );
 }
 
+// Same as ovrMessageQueue_SleepUntilMessage but gives up after timeoutSeconds so the consumer
+// thread can do some periodic work while no messages arrive.
+static void ovrMessageQueue_SleepUntilMessageOrTimeout( ovrMessageQueue * messageQueue, const double timeoutSeconds )
+{
+    if ( messageQueue->Wait == MQ_WAIT_PROCESSED )
+    {
+        messageQueue->ProcessedFlag = true;
+        pthread_cond_broadcast( &messageQueue->ProcessedCondition );
+        messageQueue->Wait = MQ_WAIT_NONE;
+    }
+    pthread_mutex_lock( &messageQueue->Mutex );
+    if ( messageQueue->Tail > messageQueue->Head )
+    {
+        pthread_mutex_unlock( &messageQueue->Mutex );
+        return;
+    }
+    struct timespec deadline;
+    clock_gettime( CLOCK_REALTIME, &deadline );
+    const long long deadlineNanoseconds = (long long)deadline.tv_nsec + (long long)( timeoutSeconds * 1e9 );
+    deadline.tv_sec += (time_t)( deadlineNanoseconds / 1000000000LL );
+    deadline.tv_nsec = (long)( deadlineNanoseconds % 1000000000LL );
+    while ( !messageQueue->PostedFlag )
+    {
+        if ( pthread_cond_timedwait( &messageQueue->PostedCondition, &messageQueue->Mutex, &deadline ) == ETIMEDOUT )
+        {
+            break;
+        }
+    }
+    messageQueue->PostedFlag = false;
+    pthread_mutex_unlock( &messageQueue->Mutex );
+}
+
 static bool ovrMessageQueue_GetNextMessage( ovrMessageQueue * messageQueue, ovrMessage * message, bool waitForMessages )
 {
     if ( messageQueue->Wait == MQ_WAIT_PROCESSED )
@@ -297,7 +347,7 @@ static void ovrEgl_Clear( ovrEgl * egl )
     egl->Context = EGL_NO_CONTEXT;
 }
 
-static void ovrEgl_CreateContext( ovrEgl * egl, const ovrEgl * shareEgl )
+static void ovrEgl_CreateContext( ovrEgl * egl, const ovrEgl * shareEgl, const int tinySurfaceSize )
 {
     if ( egl->Display != 0 )
     {
@@ -307,60 +357,30 @@ static void ovrEgl_CreateContext( ovrEgl * egl, const ovrEgl * shareEgl )
     egl->Display = eglGetDisplay( EGL_DEFAULT_DISPLAY );
     LOG_MESSAGE( "        eglInitialize( Display, &MajorVersion, &MinorVersion )" );
     eglInitialize( egl->Display, &egl->MajorVersion, &egl->MinorVersion );
-    // Do NOT use eglChooseConfig, because the Android EGL code pushes in multisample
-    // flags in eglChooseConfig if the user has selected the "force 4x MSAA" option in
-    // settings, and that is completely wasted for our warp target.
-    const int MAX_CONFIGS = 1024;
-    EGLConfig configs[MAX_CONFIGS];
-    EGLint numConfigs = 0;
-    if ( eglGetConfigs( egl->Display, configs, MAX_CONFIGS, &numConfigs ) == EGL_FALSE )
-    {
-        LOG_ERROR( "        eglGetConfigs() failed: %s", EglErrorString( eglGetError() ) );
-        return;
-    }
-    const EGLint configAttribs[] =
-    {
-        EGL_ALPHA_SIZE, 8, // need alpha for the multi-pass timewarp compositor
-        EGL_BLUE_SIZE,  8,
-        EGL_GREEN_SIZE, 8,
-        EGL_RED_SIZE,   8,
-        EGL_DEPTH_SIZE, 0,
-        EGL_SAMPLES,	0,
-        EGL_NONE
-    };
-    egl->Config = 0;
-    for ( int i = 0; i < numConfigs; i++ )
+    egl->Config = ovrEglConfigCache_Find( egl->Display );
+    if ( egl->Config == 0 )
     {
-        EGLint value = 0;
-        
-        eglGetConfigAttrib( egl->Display, configs[i], EGL_RENDERABLE_TYPE, &value );
-        if ( ( value & EGL_OPENGL_ES3_BIT_KHR ) != EGL_OPENGL_ES3_BIT_KHR )
-        {
-            continue;
-        }
-        
-        // The pbuffer config also needs to be compatible with normal window rendering
-        // so it can share textures with the window context.
-        eglGetConfigAttrib( egl->Display, configs[i], EGL_SURFACE_TYPE, &value );
-        if ( ( value & ( EGL_WINDOW_BIT | EGL_PBUFFER_BIT ) ) != ( EGL_WINDOW_BIT | EGL_PBUFFER_BIT ) )
+        const long long scanStartTime = GetTimeInNanoseconds();
+        // Do NOT use eglChooseConfig, because the Android EGL code pushes in multisample
+        // flags in eglChooseConfig if the user has selected the "force 4x MSAA" option in
+        // settings, and that is completely wasted for our warp target.
+        const int MAX_CONFIGS = 1024;
+        EGLConfig configs[MAX_CONFIGS];
+        EGLint numConfigs = 0;
+        if ( eglGetConfigs( egl->Display, configs, MAX_CONFIGS, &numConfigs ) == EGL_FALSE )
         {
-            continue;
+            LOG_ERROR( "        eglGetConfigs() failed: %s", EglErrorString( eglGetError() ) );
+            return;
         }
-        
-        int	j = 0;
-        for ( ; configAttribs[j] != EGL_NONE; j += 2 )
+        for ( int i = 0; i < numConfigs; i++ )
         {
-            eglGetConfigAttrib( egl->Display, configs[i], configAttribs[j], &value );
-            if ( value != configAttribs[j + 1] )
+            if ( ovrEglConfig_IsSuitable( egl->Display, configs[i] ) )
             {
+                egl->Config = configs[i];
+                ovrEglConfigCache_Store( egl->Display, egl->Config, GetTimeInNanoseconds() - scanStartTime );
                 break;
             }
         }
-        if ( configAttribs[j] == EGL_NONE )
-        {
-            egl->Config = configs[i];
-            break;
-        }
     }
     if ( egl->Config == 0 )
     {
@@ -381,8 +401,8 @@ static void ovrEgl_CreateContext( ovrEgl * egl, const ovrEgl * shareEgl )
     }
     const EGLint surfaceAttribs[] =
     {
-        EGL_WIDTH, 16,
-        EGL_HEIGHT, 16,
+        EGL_WIDTH, tinySurfaceSize,
+        EGL_HEIGHT, tinySurfaceSize,
         EGL_NONE
     };
     LOG_MESSAGE( "        TinySurface = eglCreatePbufferSurface( Display, Config, surfaceAttribs )" );
@@ -491,16 +511,232 @@ static void ovrEgl_DestroySurface( ovrEgl * egl )
     }
 }
 
+// ================================================================================================
+// Process lifetime EGL resources
+// eglInitialize, the config selection and the context creation are paid once per process instead of
+// once per session: on stop the display, context and TinySurface are kept (MainSurface belongs to the
+// window and is always destroyed) and the next session takes them. A context can only be current on
+// one thread, so one set is kept; a session that starts while another one holds it creates its own.
+// The kept set is only destroyed on memory pressure or an explicit release (ovrEglResources_Trim).
+// ================================================================================================
+static pthread_mutex_t eglResourcesMutex = PTHREAD_MUTEX_INITIALIZER;
+static ovrEgl eglResourcesKept;
+static bool eglResourcesKeptValid = false;
+// Sessions holding a set (kept or their own). The display is only terminated when there are none.
+static int eglResourcesInUse = 0;
+static std::atomic<int> eglResourcesReused( 0 );
+
+// Destroys the context and the TinySurface, and only terminates the display (shared by the whole
+// process) if terminate is set.
+static void ovrEglResources_Destroy( ovrEgl * egl, const bool terminate )
+{
+    if ( terminate )
+    {
+        ovrEgl_DestroyContext( egl );
+        return;
+    }
+    if ( egl->Context != EGL_NO_CONTEXT )
+    {
+        eglDestroyContext( egl->Display, egl->Context );
+    }
+    if ( egl->TinySurface != EGL_NO_SURFACE )
+    {
+        eglDestroySurface( egl->Display, egl->TinySurface );
+    }
+    ovrEgl_Clear( egl );
+}
+
+// Fills egl with the kept resources, not current on any thread. Returns false if there were none (the
+// caller then creates them with ovrEgl_CreateContext). Either way ovrEglResources_Release must follow.
+static bool ovrEglResources_Acquire( ovrEgl * egl )
+{
+    pthread_mutex_lock( &eglResourcesMutex );
+    eglResourcesInUse++;
+    const bool kept = eglResourcesKeptValid;
+    if ( kept )
+    {
+        *egl = eglResourcesKept;
+        eglResourcesKeptValid = false;
+        eglResourcesReused.fetch_add( 1, std::memory_order_relaxed );
+    }
+    pthread_mutex_unlock( &eglResourcesMutex );
+    return kept;
+}
+
+// Gives the resources back to be kept. The MainSurface must have been destroyed and the context must not
+// be current on any thread.
+static void ovrEglResources_Release( ovrEgl * egl )
+{
+    pthread_mutex_lock( &eglResourcesMutex );
+    eglResourcesInUse--;
+    if ( !eglResourcesKeptValid && egl->Context != EGL_NO_CONTEXT )
+    {
+        eglResourcesKept = *egl;
+        eglResourcesKeptValid = true;
+        ovrEgl_Clear( egl );
+    }
+    else
+    {
+        ovrEglResources_Destroy( egl, !eglResourcesKeptValid && eglResourcesInUse == 0 );
+    }
+    pthread_mutex_unlock( &eglResourcesMutex );
+}
+
+// Destroys the kept resources. Returns true if there were any.
+static bool ovrEglResources_Trim()
+{
+    pthread_mutex_lock( &eglResourcesMutex );
+    const bool kept = eglResourcesKeptValid;
+    if ( kept )
+    {
+        ovrEglResources_Destroy( &eglResourcesKept, eglResourcesInUse == 0 );
+        eglResourcesKeptValid = false;
+    }
+    pthread_mutex_unlock( &eglResourcesMutex );
+    return kept;
+}
+
+// ================================================================================================
+// OculusMobileSDKHeadTrackingConsumer
+// One per Java OculusMobileSDKHeadTracking instance. All of them share the same (expensive) session:
+// a single tracking thread, EGL context and VR mode for the whole process. The consumer keeps what
+// is specific to each of them: its Java objects, its lifecycle state, its surface, the sampling rate
+// it asked for and its own cursor in the sample history.
+// ================================================================================================
+class OculusMobileSDKHeadTracking;
+
+class OculusMobileSDKHeadTrackingConsumer
+{
+public:
+    OculusMobileSDKHeadTracking* session;
+    // The activity the consumer was started with, the session uses it if the one it started with goes away.
+    jobject activityJObject;
+    jobject oculusMobileSDKHeadTrackingJObject;
+    jobject dataJObject;
+    // Only used from the session's tracking thread.
+    ANativeWindow* nativeWindow;
+    bool resumed;
+    int samplingRate;
+    // Only used from the consumer's own thread (the one reading the samples).
+    unsigned int sampleCursor;
+    // The window last handed to the session, only used from the thread of the surface callbacks (not owned, the
+    // session releases it). Lets surfaceChanged skip the size and format changes of the same window.
+    ANativeWindow* callbackNativeWindow;
+    
+    // Push delivery (see setDataListener). The delivery thread stays attached to the Java VM and
+    // fills the preallocated data objects in turn so nothing is allocated per delivery.
+    static const int DATA_POOL_SIZE = 4;
+    // Deliver on every display refresh (paced by the predicted display times) instead of at a fixed rate.
+    static const int DELIVERY_DISPLAY_REFRESH = -1;
+    PoseSampler delivery;
+    jobject dataListenerJObject;
+    jmethodID dataListenerMethodID;
+    jobject dataPoolJObjects[DATA_POOL_SIZE];
+    int dataPoolIndex;
+    
+    OculusMobileSDKHeadTrackingConsumer(JNIEnv* jniEnv, jobject activityJObject, jobject oculusMobileSDKHeadTrackingJObject, jobject dataJObject): session(NULL), nativeWindow(NULL), resumed(false), samplingRate(0), sampleCursor(0), callbackNativeWindow(NULL), dataListenerJObject(NULL), dataListenerMethodID(NULL), dataPoolIndex(0)
+    {
+        this->activityJObject = jniEnv->NewGlobalRef(activityJObject);
+        this->oculusMobileSDKHeadTrackingJObject = jniEnv->NewGlobalRef(oculusMobileSDKHeadTrackingJObject);
+        this->dataJObject = jniEnv->NewGlobalRef(dataJObject);
+        memset(dataPoolJObjects, 0, sizeof(dataPoolJObjects));
+    }
+    
+    void destroy(JNIEnv* jniEnv)
+    {
+        setDataListener(jniEnv, NULL, 0, NULL);
+        jniEnv->DeleteGlobalRef(activityJObject);
+        jniEnv->DeleteGlobalRef(oculusMobileSDKHeadTrackingJObject);
+        jniEnv->DeleteGlobalRef(dataJObject);
+    }
+    
+    // A NULL listener (or a deliveriesPerSecond of 0) stops the delivery.
+    void setDataListener(JNIEnv* jniEnv, jobject listenerJObject, int deliveriesPerSecond, jobjectArray dataPoolJObjectArray);
+    
+private:
+    void deliver();
+    
+    static void deliverStatic(void* data)
+    {
+        ((OculusMobileSDKHeadTrackingConsumer*)data)->deliver();
+    }
+    
+    static long long nextDisplayRefreshStatic(void* data, long long periodDeadline);
+};
 
 // ================================================================================================
 // OculudMobileSDKHeadTracking
+// The session shared by all the consumers of the process (see acquireShared). The lifecycle of the
+// consumers is aggregated on the tracking thread: it is resumed while any consumer is resumed, it
+// uses the surface of the first consumer that has one and it samples at the highest requested rate.
+// Everything else (prediction, threads, governor...) is configured for the whole session.
 // ================================================================================================
 class OculusMobileSDKHeadTracking
 {
 private:
+    // The clock levels without any thermal pressure (see PerformanceGovernor).
     static const int CPU_LEVEL = 2;
     static const int GPU_LEVEL = 3;
+    // The same in tracking-only mode: nothing is rendered, the GPU only runs the timewarp of black frames.
+    static const int TRACKING_ONLY_CPU_LEVEL = 1;
+    static const int TRACKING_ONLY_GPU_LEVEL = 0;
+    // The offscreen surface the context is made current with while there is no window surface.
+    static const int TINY_SURFACE_SIZE = 16;
+    static const int TRACKING_ONLY_TINY_SURFACE_SIZE = 1;
+    // How often the tracking thread polls the vrapi status while in VR mode.
+    static constexpr double PERIODIC_TASKS_SECONDS = 0.1;
+    // Must be a power of 2.
+    static const int SAMPLE_HISTORY_SIZE = 1024;
+    
+public:
+    // The fields of OculusMobileSDKHeadTrackingData. getData is instantiated for a few combinations of
+    // them so the fields (and the vrapi calls) a consumer does not need are not even compiled in.
+    enum DataFields
+    {
+        DATA_FIELD_TIME_STAMP           = 1 << 0,
+        DATA_FIELD_ORIENTATION          = 1 << 1,
+        DATA_FIELD_LINEAR_VELOCITY      = 1 << 2,
+        DATA_FIELD_ANGULAR_VELOCITY     = 1 << 3,
+        DATA_FIELD_LINEAR_ACCELERATION  = 1 << 4,
+        DATA_FIELD_ANGULAR_ACCELERATION = 1 << 5,
+        DATA_FIELD_MOUNTED              = 1 << 6,
+        DATA_FIELD_DOCKED               = 1 << 7,
+        
+        DATA_FIELDS_ORIENTATION = DATA_FIELD_TIME_STAMP | DATA_FIELD_ORIENTATION,
+        DATA_FIELDS_ORIENTATION_AND_VELOCITY = DATA_FIELDS_ORIENTATION | DATA_FIELD_LINEAR_VELOCITY | DATA_FIELD_ANGULAR_VELOCITY,
+        DATA_FIELDS_FULL = DATA_FIELDS_ORIENTATION_AND_VELOCITY | DATA_FIELD_LINEAR_ACCELERATION | DATA_FIELD_ANGULAR_ACCELERATION | DATA_FIELD_MOUNTED | DATA_FIELD_DOCKED
+    };
+    
+    // The milestones of start whose time is recorded (see markStartupPhase).
+    enum StartupPhases
+    {
+        STARTUP_PHASE_START,
+        STARTUP_PHASE_TRACKING_THREAD_CREATED,
+        STARTUP_PHASE_JNI_CACHED,
+        STARTUP_PHASE_SYSTEM_ACTIVITIES_INITIALIZED,
+        STARTUP_PHASE_VRAPI_INITIALIZED,
+        STARTUP_PHASE_EGL_CONTEXT_CREATED,
+        STARTUP_PHASE_TRACKING_THREAD_READY,
+        STARTUP_PHASE_VR_MODE_ENTERED,
+        STARTUP_PHASE_FIRST_POSE,
+        STARTUP_PHASE_COUNT
+    };
+    
+    // The native threads whose scheduling can be configured.
+    enum Threads
+    {
+        TRACKING_THREAD,
+        SAMPLER_THREAD,
+        THREAD_COUNT
+    };
+    
+    // tid, requested affinity, granted affinity, requested FIFO priority, granted policy, granted priority, granted nice, requested through vrapi
+    static const int THREAD_TELEMETRY_INT_COUNT = 8;
+    
+    // time, orientation x, y, z, w (see readSamples)
+    static const int SAMPLE_DOUBLE_COUNT = 5;
     
+private:
     enum MessageTypes
     {
         MESSAGE_START,
@@ -508,14 +744,35 @@ private:
         MESSAGE_PAUSE,
         MESSAGE_STOP,
         MESSAGE_SURFACE_CREATED,
-        MESSAGE_SURFACE_DESTROYED
+        MESSAGE_SURFACE_DESTROYED,
+        MESSAGE_SET_SAMPLING_RATE,
+        MESSAGE_SET_THREAD_CONFIGURATION,
+        MESSAGE_SET_PERFORMANCE_GOVERNOR_ENABLED,
+        MESSAGE_ATTACH_CONSUMER,
+        MESSAGE_DETACH_CONSUMER,
+        MESSAGE_SET_WARM_RESUME_GRACE_PERIOD,
+        MESSAGE_SET_POSE_RECORDING,
+        MESSAGE_SET_POSE_REPLAY
     };
     
+    static pthread_mutex_t sharedMutex;
+    static OculusMobileSDKHeadTracking* shared;
+    static int sharedReferenceCount;
+    // A session that is no longer shared but still being stopped (outside of sharedMutex). The next one
+    // waits for it to be gone before initializing vrapi again.
+    static bool sharedStopping;
+    static pthread_cond_t sharedStopped;
+    
     pthread_t thread;
     JavaVM* javaVM;
+    // Set by start, then only changed by the tracking thread (see setActivityFromConsumers).
     jobject activityJObject;
-    jobject oculusMobileSDKHeadTrackingJObject;
-    jobject dataJObject;
+    // Only used from the tracking thread.
+    std::vector<OculusMobileSDKHeadTrackingConsumer*> consumers;
+    const char* errorMessage;
+    float eyeFOVX;
+    float eyeFOVY;
+    float interpupillaryDistance;
     jclass oculusMobileSDKHeadTrackingJClass;
     jclass dataJClass;
     jmethodID headTrackingStartedMethodID;
@@ -539,8 +796,12 @@ private:
     jfieldID dataAngularAccelerationZFieldID;
     jfieldID dataMountedFieldID;
     jfieldID dataDockedFieldID;
+    // Only used by the tracking thread (and the sampler thread, which only runs while it is valid).
     ovrMobile* ovr;
-    long long frameIndex;
+    // The same ovrMobile for the other threads (getData), see GuardedPointer.
+    GuardedPointer<ovrMobile> sharedOvr;
+    // Advanced by each getData, read by the sampler, delivery and tracking threads.
+    std::atomic<long long> frameIndex;
     ANativeWindow* nativeWindow;
     ovrMessageQueue messageQueue;
     bool destroyed;
@@ -548,17 +809,251 @@ private:
     bool started;
     ovrEgl egl;
     ovrJava java;
+    PredictionAccuracy predictionAccuracy;
+    volatile bool predictionAccuracyEnabled;
+    LateLatch lateLatch;
+    AdaptiveHorizon adaptiveHorizon;
+    volatile bool adaptiveHorizonEnabled;
+    volatile float lastHorizon;
+    // Whether getData re-predicts the newest sample of the sampler instead of calling vrapi (opt-in).
+    volatile bool sampledPredictionEnabled;
+    PoseSampler sampler;
+    int samplingRate;
+    SampleRing<ovrTracking, SAMPLE_HISTORY_SIZE> sampleHistory;
+    // Fed by the sampler thread. Only started and stopped by the tracking thread, with the sampler stopped.
+    PoseRecorder poseRecorder;
+    // Replaces the vrapi tracking while playing. The recording is owned by the tracking thread.
+    PoseReplay poseReplay;
+    // The last poses and events (from any thread), dumped on error, on stop or on demand.
+    FlightRecorder flightRecorder;
+    // Only written by the tracking thread. The telemetry is also read from the Java side.
+    ovrThreadConfiguration threadConfigurations[THREAD_COUNT];
+    ovrThreadTelemetry threadTelemetries[THREAD_COUNT];
+    pthread_mutex_t threadTelemetryMutex;
+    // vrapi_GetSystemStatusInt needs the JNIEnv of the calling thread so these are polled by the tracking thread.
+    std::atomic<int> mounted;
+    std::atomic<int> docked;
+    std::atomic<int> displayRefreshRate;
+    // Only used from the tracking thread.
+    PerformanceGovernor governor;
+    bool governorEnabled;
+    // Runs the work that does not need to be done on the tracking or sampler threads (logging).
+    WorkerPool workers;
+    // Absolute times (GetTimeInNanoseconds) of the startup phases, 0 until reached.
+    std::atomic<long long> startupPhaseTimes[STARTUP_PHASE_COUNT];
+    // Posted by the worker that creates the EGL context while the tracking thread initializes vrapi.
+    sem_t eglContextCreated;
+    // Only used from the tracking thread. While paused (with the surface kept) for less than the grace period
+    // the VR mode is only suspended, so resuming does not need to enter it again.
+    double warmResumeGracePeriod;
+    long long suspendTime;
+    // When the pending resume was processed, 0 if none.
+    long long resumeTime;
+    ResumeStatistics resumeStatistics;
+    // Tracking-only mode (see the constructor). Only set on construction.
+    const bool trackingOnly;
+    const int cpuLevel;
+    const int gpuLevel;
+    GraphicsFootprint graphicsFootprint;
+    // Only changed by the tracking thread. The state machine replaces deriving the state from resumed,
+    // nativeWindow and ovr every time (see handleVRModeChanges).
+    VrModeStateMachine vrModeStateMachine;
+    // The window the MainSurface was created for, NULL if none.
+    ANativeWindow* surfaceNativeWindow;
+    // Only used from the tracking thread. The activity changed while in VR mode (see setActivityFromConsumers).
+    bool activityChanged;
     
-    void handleVRModeChanges()
+    // Only from the tracking thread.
+    void resumeCompleted(bool warm)
     {
-        if (nativeWindow != NULL && egl.MainSurface == EGL_NO_SURFACE )
+        if (resumeTime != 0)
         {
-            ovrEgl_CreateSurface(&egl, nativeWindow);
+            resumeStatistics.record(warm, GetTimeInNanoseconds() - resumeTime);
+            resumeTime = 0;
         }
-        
-        if (resumed != false && nativeWindow != NULL )
+    }
+    
+    void markStartupPhase(int phase)
+    {
+        // Only the first time
+        long long notReached = 0;
+        startupPhaseTimes[phase].compare_exchange_strong(notReached, GetTimeInNanoseconds(), std::memory_order_relaxed);
+    }
+    
+    // Scanning the EGL configs takes a while and does not depend on vrapi so it is done by a worker (unless
+    // the resources of a previous session are kept, see ovrEglResources). The context is released so the
+    // tracking thread can make it current once it is done initializing vrapi.
+    // The workers run at a low priority (WorkerPool::WORKER_NICE) but start waits for this one, so it runs at the
+    // default priority and gives the worker its own back afterwards.
+    static void createEglContextTask(const ovrWorkerTask* task)
+    {
+        OculusMobileSDKHeadTracking* _this = (OculusMobileSDKHeadTracking*)task->Context;
+        const int nice = getpriority(PRIO_PROCESS, 0);
+        if (nice > 0)
         {
-            if ( ovr == NULL )
+            setpriority(PRIO_PROCESS, 0, 0);
+        }
+        if (!ovrEglResources_Acquire(&_this->egl))
+        {
+            PROFILE_PHASE(PHASE_EGL_CONTEXT_CREATE);
+            ovrEgl_CreateContext( &_this->egl, NULL, _this->trackingOnly ? TRACKING_ONLY_TINY_SURFACE_SIZE : TINY_SURFACE_SIZE );
+        }
+        if (_this->egl.TinySurface != EGL_NO_SURFACE)
+        {
+            // The kept resources may come from a session in the other mode
+            EGLint width = 0, height = 0;
+            eglQuerySurface( _this->egl.Display, _this->egl.TinySurface, EGL_WIDTH, &width );
+            eglQuerySurface( _this->egl.Display, _this->egl.TinySurface, EGL_HEIGHT, &height );
+            _this->graphicsFootprint.setOffscreenSurfaceSize(width, height);
+        }
+        if (_this->egl.Context != EGL_NO_CONTEXT)
+        {
+            eglMakeCurrent( _this->egl.Display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT );
+        }
+        _this->markStartupPhase(STARTUP_PHASE_EGL_CONTEXT_CREATED);
+        sem_post(&_this->eglContextCreated);
+        if (nice > 0)
+        {
+            setpriority(PRIO_PROCESS, 0, nice);
+        }
+    }
+    
+    void waitForEglContext()
+    {
+        while (sem_wait(&eglContextCreated) != 0)
+        {
+        }
+    }
+    
+    static void logTask(const ovrWorkerTask* task)
+    {
+        __android_log_write(ANDROID_LOG_VERBOSE, LOG_TAG, task->Text);
+    }
+    
+    // Like LOG_MESSAGE but the (slow) write to the log is done by a worker. Any thread.
+    __attribute__((format(printf, 2, 3))) void logMessage(const char* format, ...)
+    {
+        ovrWorkerTask task;
+        task.Function = logTask;
+        task.Context = NULL;
+        va_list args;
+        va_start(args, format);
+        vsnprintf(task.Text, WORKER_TASK_TEXT_SIZE, format, args);
+        va_end(args);
+        // If the queue is full the line is dropped (and counted) rather than blocking
+        workers.submit(task);
+    }
+    
+    // Records the error in the flight recorder and dumps it (if a dump path is set). Any thread.
+    __attribute__((format(printf, 2, 3))) void recordError(const char* format, ...)
+    {
+        char text[FlightRecorder::EVENT_TEXT_SIZE];
+        va_list args;
+        va_start(args, format);
+        vsnprintf(text, sizeof(text), format, args);
+        va_end(args);
+        flightRecorder.recordEvent(FLIGHT_EVENT_ERROR, "%s", text);
+        flightRecorder.dumpAsync(&workers, "error");
+    }
+    
+    static const char* getMessageName(const int id)
+    {
+        static const char* NAMES[] =
+        {
+            "START", "RESUME", "PAUSE", "STOP", "SURFACE_CREATED", "SURFACE_DESTROYED", "SET_SAMPLING_RATE",
+            "SET_THREAD_CONFIGURATION", "SET_PERFORMANCE_GOVERNOR_ENABLED", "ATTACH_CONSUMER", "DETACH_CONSUMER",
+            "SET_WARM_RESUME_GRACE_PERIOD", "SET_POSE_RECORDING", "SET_POSE_REPLAY"
+        };
+        static_assert(sizeof(NAMES) / sizeof(NAMES[0]) == MESSAGE_SET_POSE_REPLAY + 1, "A message has no name");
+        return id >= 0 && id <= MESSAGE_SET_POSE_REPLAY ? NAMES[id] : "UNKNOWN";
+    }
+    
+    // The activity of the session is going away with the detached consumer: use the one of a consumer that
+    // stays. The VR mode was entered with the old one so it is left and entered again. Only from the tracking thread.
+    void setActivityFromConsumers(OculusMobileSDKHeadTrackingConsumer* detachedConsumer)
+    {
+        for (size_t i = 0; i < consumers.size(); i++)
+        {
+            if (!java.Env->IsSameObject(consumers[i]->activityJObject, detachedConsumer->activityJObject))
+            {
+                java.Env->DeleteGlobalRef(activityJObject);
+                activityJObject = java.Env->NewGlobalRef(consumers[i]->activityJObject);
+                java.ActivityObject = activityJObject;
+                const int state = vrModeStateMachine.getState();
+                activityChanged = state == VrModeStateMachine::STATE_VR_MODE || state == VrModeStateMachine::STATE_SUSPENDED;
+                flightRecorder.recordEvent(FLIGHT_EVENT_LIFECYCLE, "activity changed");
+                return;
+            }
+        }
+    }
+    
+    // The state the session should be in. Only from the tracking thread.
+    int getTargetVrModeState() const
+    {
+        const int state = vrModeStateMachine.getState();
+        // Leave the VR mode entered with an activity that is gone (see setActivityFromConsumers)
+        if (activityChanged && (state == VrModeStateMachine::STATE_VR_MODE || state == VrModeStateMachine::STATE_SUSPENDED))
+        {
+            return VrModeStateMachine::STATE_SURFACE;
+        }
+        // The surface of a window that is going away must be destroyed (leaving VR mode first) before using the new one
+        if (nativeWindow == NULL || (state != VrModeStateMachine::STATE_IDLE && surfaceNativeWindow != nativeWindow))
+        {
+            return VrModeStateMachine::STATE_IDLE;
+        }
+        if (resumed)
+        {
+            return VrModeStateMachine::STATE_VR_MODE;
+        }
+        // Only paused, with the surface kept: suspend for the grace period before leaving VR mode
+        if (warmResumeGracePeriod > 0.0)
+        {
+            if (state == VrModeStateMachine::STATE_VR_MODE)
+            {
+                return VrModeStateMachine::STATE_SUSPENDED;
+            }
+            if (state == VrModeStateMachine::STATE_SUSPENDED && (double)(GetTimeInNanoseconds() - suspendTime) * 1e-9 < warmResumeGracePeriod)
+            {
+                return VrModeStateMachine::STATE_SUSPENDED;
+            }
+        }
+        return VrModeStateMachine::STATE_SURFACE;
+    }
+    
+    // The side effects of one edge of the transition table. Returns false if they failed (the state is kept
+    // and the edge is tried again on the next call). Only from the tracking thread.
+    bool runVrModeTransition(const int state, const int nextState)
+    {
+        switch (state * VrModeStateMachine::STATE_COUNT + nextState)
+        {
+            case VrModeStateMachine::STATE_IDLE * VrModeStateMachine::STATE_COUNT + VrModeStateMachine::STATE_SURFACE:
+            {
+                {
+                    PROFILE_PHASE(PHASE_EGL_SURFACE_CREATE);
+                    ovrEgl_CreateSurface(&egl, nativeWindow);
+                }
+                if (egl.MainSurface == EGL_NO_SURFACE)
+                {
+                    return false;
+                }
+                surfaceNativeWindow = nativeWindow;
+                EGLint width = 0, height = 0;
+                eglQuerySurface( egl.Display, egl.MainSurface, EGL_WIDTH, &width );
+                eglQuerySurface( egl.Display, egl.MainSurface, EGL_HEIGHT, &height );
+                graphicsFootprint.setWindowSurfaceSize(width, height);
+                return true;
+            }
+            case VrModeStateMachine::STATE_SURFACE * VrModeStateMachine::STATE_COUNT + VrModeStateMachine::STATE_IDLE:
+            {
+                {
+                    PROFILE_PHASE(PHASE_EGL_SURFACE_DESTROY);
+                    ovrEgl_DestroySurface( &egl );
+                }
+                surfaceNativeWindow = NULL;
+                graphicsFootprint.setWindowSurfaceSize(0, 0);
+                return true;
+            }
+            case VrModeStateMachine::STATE_SURFACE * VrModeStateMachine::STATE_COUNT + VrModeStateMachine::STATE_VR_MODE:
             {
                 ovrModeParms parms = vrapi_DefaultModeParms( &java );
                 
@@ -567,131 +1062,558 @@ private:
                 parms.WindowSurface = (size_t)egl.MainSurface;
                 parms.ShareContext = (size_t)egl.Context;
 #else
-                LOG_MESSAGE( "        eglGetCurrentSurface( EGL_DRAW ) = %p", eglGetCurrentSurface( EGL_DRAW ) );
+                logMessage( "        eglGetCurrentSurface( EGL_DRAW ) = %p", eglGetCurrentSurface( EGL_DRAW ) );
 #endif
                 
-                ovr = vrapi_EnterVrMode( &parms );
+                {
+                    PROFILE_PHASE(PHASE_ENTER_VR_MODE);
+                    ovr = vrapi_EnterVrMode( &parms );
+                }
+                if (ovr == NULL)
+                {
+                    LOG_ERROR("vrapi_EnterVrMode failed.");
+                    return false;
+                }
+                markStartupPhase(STARTUP_PHASE_VR_MODE_ENTERED);
+                resumeCompleted(false);
+                
+                logMessage( "        vrapi_EnterVrMode()" );
                 
-                LOG_MESSAGE( "        vrapi_EnterVrMode()" );
+                pollSystemStatus();
+                displayRefreshRate.store(vrapi_GetSystemPropertyInt(&java, VRAPI_SYS_PROP_DISPLAY_REFRESH_RATE));
+                sharedOvr.publish(ovr);
+                
+                startSampler();
+                applyPerformanceParms();
                 
 #if EXPLICIT_GL_OBJECTS == 0
-                LOG_MESSAGE( "        eglGetCurrentSurface( EGL_DRAW ) = %p", eglGetCurrentSurface( EGL_DRAW ) );
+                logMessage( "        eglGetCurrentSurface( EGL_DRAW ) = %p", eglGetCurrentSurface( EGL_DRAW ) );
 #endif
                 if (!started)
                 {
                     started = true;
                     const ovrHeadModelParms headModelParms = vrapi_DefaultHeadModelParms();
                     
-                    float eyeX = vrapi_GetSystemPropertyFloat(&java, VRAPI_SYS_PROP_SUGGESTED_EYE_FOV_DEGREES_X);
-                    float eyeY = vrapi_GetSystemPropertyFloat(&java, VRAPI_SYS_PROP_SUGGESTED_EYE_FOV_DEGREES_Y);
-                    float interpupillaryDistance = headModelParms.InterpupillaryDistance;
+                    eyeFOVX = vrapi_GetSystemPropertyFloat(&java, VRAPI_SYS_PROP_SUGGESTED_EYE_FOV_DEGREES_X);
+                    eyeFOVY = vrapi_GetSystemPropertyFloat(&java, VRAPI_SYS_PROP_SUGGESTED_EYE_FOV_DEGREES_Y);
+                    interpupillaryDistance = headModelParms.InterpupillaryDistance;
                     
-                    LOG_MESSAGE("JUDAX: mounted = %d", vrapi_GetSystemStatusInt(&java, VRAPI_SYS_STATUS_MOUNTED));
-                    LOG_MESSAGE("JUDAX: docked = %d", vrapi_GetSystemStatusInt(&java, VRAPI_SYS_STATUS_DOCKED));
+                    logMessage("JUDAX: mounted = %d", vrapi_GetSystemStatusInt(&java, VRAPI_SYS_STATUS_MOUNTED));
+                    logMessage("JUDAX: docked = %d", vrapi_GetSystemStatusInt(&java, VRAPI_SYS_STATUS_DOCKED));
                     
-                    java.Env->CallVoidMethod(oculusMobileSDKHeadTrackingJObject, headTrackingStartedMethodID, eyeX, eyeY, interpupillaryDistance);
+                    for (size_t i = 0; i < consumers.size(); i++)
+                    {
+                        notifyStarted(consumers[i]);
+                    }
                 }
+                return true;
             }
-        }
-        else
-        {
-            if ( ovr != NULL )
+            case VrModeStateMachine::STATE_VR_MODE * VrModeStateMachine::STATE_COUNT + VrModeStateMachine::STATE_SUSPENDED:
             {
-                LOG_MESSAGE( "        eglGetCurrentSurface( EGL_DRAW ) = %p", eglGetCurrentSurface( EGL_DRAW ) );
+                suspendTime = GetTimeInNanoseconds();
+                // Nobody is sampling while paused
+                sampler.stop();
+                return true;
+            }
+            case VrModeStateMachine::STATE_SUSPENDED * VrModeStateMachine::STATE_COUNT + VrModeStateMachine::STATE_VR_MODE:
+            {
+                // Warm resume: still in VR mode with the same surface (a new one would have left it)
+                startSampler();
+                applyPerformanceParms();
+                resumeCompleted(true);
+                logMessage("Warm resume");
+                return true;
+            }
+            case VrModeStateMachine::STATE_VR_MODE * VrModeStateMachine::STATE_COUNT + VrModeStateMachine::STATE_SURFACE:
+            case VrModeStateMachine::STATE_SUSPENDED * VrModeStateMachine::STATE_COUNT + VrModeStateMachine::STATE_SURFACE:
+            {
+                logMessage( "        eglGetCurrentSurface( EGL_DRAW ) = %p", eglGetCurrentSurface( EGL_DRAW ) );
                 
-                vrapi_LeaveVrMode( ovr );
+                // The sampler uses ovr so it must be done before leaving VR mode
+                sampler.stop();
+                // Waits for any getData that is still using it
+                sharedOvr.retire();
+                
+                {
+                    PROFILE_PHASE(PHASE_LEAVE_VR_MODE);
+                    vrapi_LeaveVrMode( ovr );
+                }
                 ovr = NULL;
                 
-                LOG_MESSAGE( "        vrapi_LeaveVrMode()" );
-                LOG_MESSAGE( "        eglGetCurrentSurface( EGL_DRAW ) = %p", eglGetCurrentSurface( EGL_DRAW ) );
+                logMessage( "        vrapi_LeaveVrMode()" );
+                logMessage( "        eglGetCurrentSurface( EGL_DRAW ) = %p", eglGetCurrentSurface( EGL_DRAW ) );
+                return true;
             }
         }
-        
-        if ( nativeWindow == NULL && egl.MainSurface != EGL_NO_SURFACE )
+        // Not an edge of the table
+        return false;
+    }
+    
+    // Walks the transition table towards the target state. Only from the tracking thread.
+    void handleVRModeChanges()
+    {
+        for (int targetState = getTargetVrModeState(); vrModeStateMachine.getState() != targetState; targetState = getTargetVrModeState())
         {
-            ovrEgl_DestroySurface( &egl );
+            const int state = vrModeStateMachine.getState();
+            const int nextState = VrModeStateMachine::getNextState(state, targetState);
+            const long long startTime = GetTimeInNanoseconds();
+            if (!runVrModeTransition(state, nextState))
+            {
+                recordError("VR mode transition %d -> %d failed", state, nextState);
+                return;
+            }
+            const long long duration = GetTimeInNanoseconds() - startTime;
+            vrModeStateMachine.transitioned(nextState, duration);
+            if (nextState == VrModeStateMachine::STATE_SURFACE || nextState == VrModeStateMachine::STATE_IDLE)
+            {
+                activityChanged = false;
+            }
+            flightRecorder.recordEvent(FLIGHT_EVENT_LIFECYCLE, "vr mode %d -> %d %.1f ms", state, nextState, duration * 1e-6);
         }
     }
     
-    void threadFunction()
+    // Only from the tracking thread.
+    void notifyStarted(OculusMobileSDKHeadTrackingConsumer* consumer)
     {
-        java.Vm = javaVM;
-        java.Vm->AttachCurrentThread(&java.Env, NULL);
-        java.ActivityObject = activityJObject;
-        
-        SystemActivities_Init( &java );
-        
-        const ovrInitParms initParms = vrapi_DefaultInitParms(&java);
-        int32_t initResult = vrapi_Initialize(&initParms);
-        if (initResult != VRAPI_INITIALIZE_SUCCESS)
+        java.Env->CallVoidMethod(consumer->oculusMobileSDKHeadTrackingJObject, headTrackingStartedMethodID, eyeFOVX, eyeFOVY, interpupillaryDistance);
+    }
+    
+    // Only from the tracking thread.
+    void notifyError(OculusMobileSDKHeadTrackingConsumer* consumer)
+    {
+        java.Env->CallVoidMethod(consumer->oculusMobileSDKHeadTrackingJObject, headTrackingErrorMethodID, java.Env->NewStringUTF(errorMessage));
+    }
+    
+    // Recomputes the session state from all the consumers. Only from the tracking thread.
+    void updateFromConsumers()
+    {
+        const bool wasResumed = resumed;
+        resumed = false;
+        int highestSamplingRate = 0;
+        ANativeWindow* consumersNativeWindow = NULL;
+        for (size_t i = 0; i < consumers.size(); i++)
         {
-            char const * msg = initResult == VRAPI_INITIALIZE_PERMISSIONS_ERROR ?
-            "Thread priority security exception. Make sure the APK is signed." :
-            "VrApi initialization error.";
-            
-            java.Env->CallVoidMethod(oculusMobileSDKHeadTrackingJObject, headTrackingErrorMethodID, java.Env->NewStringUTF(msg));
-            
-            SystemActivities_DisplayError(&java, SYSTEM_ACTIVITIES_FATAL_ERROR_OSIG, __FILE__, msg);
+            resumed = resumed || consumers[i]->resumed;
+            highestSamplingRate = consumers[i]->samplingRate > highestSamplingRate ? consumers[i]->samplingRate : highestSamplingRate;
+            if (consumersNativeWindow == NULL)
+            {
+                consumersNativeWindow = consumers[i]->nativeWindow;
+            }
         }
         
-        ovrEgl_CreateContext( &egl, NULL );
-        
-        ovrPerformanceParms perfParms = vrapi_DefaultPerformanceParms();
-        perfParms.CpuLevel = CPU_LEVEL;
-        perfParms.GpuLevel = GPU_LEVEL;
-        perfParms.MainThreadTid = gettid();
-        
-        LOG_MESSAGE("OculusMobileSDKHeadTracking thread running...");
-        
-        frameIndex = 0;
+        if (resumed && !wasResumed)
+        {
+            resumeTime = GetTimeInNanoseconds();
+        }
         
-        const ovrHeadModelParms headModelParms = vrapi_DefaultHeadModelParms();
+        nativeWindow = consumersNativeWindow;
+        if (surfaceNativeWindow != NULL && surfaceNativeWindow != nativeWindow)
+        {
+            // Leave VR mode and destroy the surface of the window that is going away before it is released
+            handleVRModeChanges();
+        }
         
-        for (destroyed = false; !destroyed ;)
+        if (highestSamplingRate != samplingRate)
         {
-            for ( ; ; )
+            samplingRate = highestSamplingRate;
+            sampler.stop();
+            sampler.resetStatistics();
+            if (vrModeStateMachine.getState() != VrModeStateMachine::STATE_SUSPENDED)
             {
-                ovrMessage message;
-                const bool waitForMessages = !destroyed;
-                if (!ovrMessageQueue_GetNextMessage(&messageQueue, &message, waitForMessages))
-                {
-                    break;
-                }
-                
-                LOG_MESSAGE("Message received. message.Id = %d", message.Id);
+                startSampler();
+            }
+            applyPerformanceParms();
+        }
+    }
+    
+    // Takes ownership of the (acquired) newNativeWindow. Only from the tracking thread.
+    void setConsumerNativeWindow(OculusMobileSDKHeadTrackingConsumer* consumer, ANativeWindow* newNativeWindow)
+    {
+        if (consumer->nativeWindow == newNativeWindow)
+        {
+            if (newNativeWindow != NULL)
+            {
+                // The same window again, acquired outside of this call
+                ANativeWindow_release(newNativeWindow);
+            }
+            return;
+        }
+        ANativeWindow* oldNativeWindow = consumer->nativeWindow;
+        consumer->nativeWindow = newNativeWindow;
+        updateFromConsumers();
+        // The session does not use it anymore
+        if (oldNativeWindow != NULL)
+        {
+            ANativeWindow_release(oldNativeWindow);
+        }
+    }
+    
+    // The absolute time poses are predicted for when queried at 'now' for the given frame.
+    inline double getPredictionTargetTime(ovrMobile* ovr, double now, long long frame)
+    {
+        const float horizon = adaptiveHorizonEnabled ? adaptiveHorizon.getHorizon() : 0.0f;
+        // Until some latency has been measured, use the vrapi display time prediction
+        return horizon > 0.0f ? now + horizon : vrapi_GetPredictedDisplayTime(ovr, frame);
+    }
+    
+    // vrapi_GetPredictedTracking, or the pose replayed for that time while a recording is playing. Only the
+    // sampler and getData step a replay played as fast as possible.
+    inline ovrTracking getPredictedTracking(ovrMobile* ovr, const double absTimeInSeconds, const bool stepReplay)
+    {
+        ovrTracking tracking;
+        if (poseReplay.getTracking(absTimeInSeconds > 0.0 ? absTimeInSeconds : vrapi_GetTimeInSeconds(), stepReplay, &tracking))
+        {
+            return tracking;
+        }
+        return vrapi_GetPredictedTracking(ovr, absTimeInSeconds);
+    }
+    
+    // Called from the sampler thread at samplingRate while in VR mode.
+    void sample()
+    {
+        // Predict for the frame getData will be queried for next.
+        const ovrTracking tracking = getPredictedTracking(ovr, getPredictionTargetTime(ovr, vrapi_GetTimeInSeconds(), frameIndex.load(std::memory_order_relaxed) + 1), true);
+        lateLatch.update(tracking);
+        sampleHistory.push(tracking);
+        const long long sampleTime = GetTimeInNanoseconds();
+        flightRecorder.recordPose(tracking, sampleTime, FLIGHT_POSE_SAMPLED);
+        if (poseRecorder.isRecording())
+        {
+            const unsigned int flags = (mounted.load(std::memory_order_relaxed) != 0 ? POSE_RECORD_FLAG_MOUNTED : 0) | (docked.load(std::memory_order_relaxed) != 0 ? POSE_RECORD_FLAG_DOCKED : 0);
+            poseRecorder.record(tracking, flags, sampleTime);
+        }
+    }
+    
+    static void sampleStatic(void* data)
+    {
+        ((OculusMobileSDKHeadTracking*)data)->sample();
+    }
+    
+    inline int getEffectiveSamplingRate() const
+    {
+        return governorEnabled ? governor.getSamplingRate(samplingRate) : samplingRate;
+    }
+    
+    // Only from the tracking thread.
+    void startSampler()
+    {
+        if (ovr != NULL && samplingRate > 0 && !sampler.isRunning())
+        {
+            if (!sampler.start(getEffectiveSamplingRate(), sampleStatic, this, threadConfigurations[SAMPLER_THREAD]))
+            {
+                LOG_ERROR("Could not create the sampler thread.");
+                recordError("Could not create the sampler thread.");
+                return;
+            }
+            pthread_mutex_lock(&threadTelemetryMutex);
+            threadTelemetries[SAMPLER_THREAD] = sampler.getTelemetry();
+            pthread_mutex_unlock(&threadTelemetryMutex);
+        }
+    }
+    
+    // Only from the tracking thread.
+    void applyTrackingThreadConfiguration()
+    {
+        ovrThreadTelemetry telemetry;
+        ovrThreadConfiguration_ApplyToCurrentThread(&threadConfigurations[TRACKING_THREAD], &telemetry);
+        pthread_mutex_lock(&threadTelemetryMutex);
+        threadTelemetries[TRACKING_THREAD] = telemetry;
+        pthread_mutex_unlock(&threadTelemetryMutex);
+    }
+    
+    // The clock levels and the threads that should get SCHED_FIFO can only be handed to vrapi with a
+    // frame, so a black one is submitted. Only from the tracking thread (it owns the GL context) in VR mode.
+    void applyPerformanceParms()
+    {
+        if (ovr == NULL)
+        {
+            return;
+        }
+        ovrPerformanceParms perfParms = vrapi_DefaultPerformanceParms();
+        perfParms.CpuLevel = governorEnabled ? governor.getCpuLevel() : cpuLevel;
+        perfParms.GpuLevel = governorEnabled ? governor.getGpuLevel() : gpuLevel;
+        pthread_mutex_lock(&threadTelemetryMutex);
+        // Only the threads that could not get SCHED_FIFO on their own
+        perfParms.MainThreadTid = threadTelemetries[TRACKING_THREAD].VrapiFifoRequested ? threadTelemetries[TRACKING_THREAD].Tid : 0;
+        perfParms.RenderThreadTid = sampler.isRunning() && threadTelemetries[SAMPLER_THREAD].VrapiFifoRequested ? threadTelemetries[SAMPLER_THREAD].Tid : 0;
+        pthread_mutex_unlock(&threadTelemetryMutex);
+        
+        ovrFrameParms frameParms = vrapi_DefaultFrameParms(&java, VRAPI_FRAME_INIT_BLACK, vrapi_GetTimeInSeconds(), NULL);
+        frameParms.FrameIndex = frameIndex.load(std::memory_order_relaxed);
+        frameParms.PerformanceParms = perfParms;
+        const long long submitStartTime = GetTimeInNanoseconds();
+        vrapi_SubmitFrame(ovr, &frameParms);
+        graphicsFootprint.recordBlackFrame(perfParms.CpuLevel, perfParms.GpuLevel, GetTimeInNanoseconds() - submitStartTime);
+    }
+    
+    // Only from the tracking thread in VR mode.
+    void pollSystemStatus()
+    {
+        const int newMounted = vrapi_GetSystemStatusInt(&java, VRAPI_SYS_STATUS_MOUNTED);
+        const int newDocked = vrapi_GetSystemStatusInt(&java, VRAPI_SYS_STATUS_DOCKED);
+        if (mounted.exchange(newMounted, std::memory_order_relaxed) != newMounted)
+        {
+            flightRecorder.recordEvent(FLIGHT_EVENT_STATUS, "mounted %d", newMounted);
+        }
+        if (docked.exchange(newDocked, std::memory_order_relaxed) != newDocked)
+        {
+            flightRecorder.recordEvent(FLIGHT_EVENT_STATUS, "docked %d", newDocked);
+        }
+    }
+    
+    // Called from the tracking thread every PERIODIC_TASKS_SECONDS while in VR mode.
+    void runPeriodicTasks()
+    {
+        pollSystemStatus();
+        if (adaptiveHorizonEnabled)
+        {
+            adaptiveHorizon.update(vrapi_GetSystemStatusFloat(&java, VRAPI_SYS_STATUS_RENDER_LATENCY_MILLISECONDS), vrapi_GetSystemStatusFloat(&java, VRAPI_SYS_STATUS_TIMEWARP_LATENCY_MILLISECONDS));
+        }
+        if (governorEnabled)
+        {
+            const bool throttled = vrapi_GetSystemStatusInt(&java, VRAPI_SYS_STATUS_THROTTLED) != 0;
+            const bool throttled2 = vrapi_GetSystemStatusInt(&java, VRAPI_SYS_STATUS_THROTTLED2) != 0;
+            const int warningLevel = vrapi_GetSystemStatusInt(&java, VRAPI_SYS_STATUS_THROTTLED_WARNING_LEVEL);
+            if (governor.update(vrapi_GetTimeInSeconds(), throttled, throttled2, warningLevel, samplingRate))
+            {
+                logMessage("Performance governor state %d: CPU level %d, GPU level %d, sampling rate %d", governor.getState(), governor.getCpuLevel(), governor.getGpuLevel(), getEffectiveSamplingRate());
+                flightRecorder.recordEvent(FLIGHT_EVENT_STATUS, "governor %d warning %d cpu %d gpu %d rate %d", governor.getState(), warningLevel, governor.getCpuLevel(), governor.getGpuLevel(), getEffectiveSamplingRate());
+                applyGovernorDecision();
+            }
+        }
+    }
+    
+    // Restarts the sampler at the governed rate and hands the new clock levels to vrapi.
+    void applyGovernorDecision()
+    {
+        if (sampler.isRunning())
+        {
+            sampler.stop();
+            startSampler();
+        }
+        applyPerformanceParms();
+    }
+    
+    void threadFunction()
+    {
+        java.Vm = javaVM;
+        java.Vm->AttachCurrentThread(BACKEND_JNI_ENV_OUT(&java.Env), NULL);
+        java.ActivityObject = activityJObject;
+        
+        {
+            PROFILE_PHASE(PHASE_SYSTEM_ACTIVITIES_INIT);
+            SystemActivities_Init( &java );
+        }
+        markStartupPhase(STARTUP_PHASE_SYSTEM_ACTIVITIES_INITIALIZED);
+        
+        const ovrInitParms initParms = vrapi_DefaultInitParms(&java);
+        int32_t initResult;
+        {
+            PROFILE_PHASE(PHASE_VRAPI_INITIALIZE);
+            initResult = vrapi_Initialize(&initParms);
+        }
+        markStartupPhase(STARTUP_PHASE_VRAPI_INITIALIZED);
+        if (initResult != VRAPI_INITIALIZE_SUCCESS)
+        {
+            char const * msg = initResult == VRAPI_INITIALIZE_PERMISSIONS_ERROR ?
+            "Thread priority security exception. Make sure the APK is signed." :
+            "VrApi initialization error.";
+            
+            // The consumers are told as they attach
+            errorMessage = msg;
+            recordError(msg);
+            
+            SystemActivities_DisplayError(&java, SYSTEM_ACTIVITIES_FATAL_ERROR_OSIG, __FILE__, msg);
+        }
+        
+        // Created by a worker in the meantime (see start)
+        waitForEglContext();
+        if (egl.Context != EGL_NO_CONTEXT && eglMakeCurrent( egl.Display, egl.TinySurface, egl.TinySurface, egl.Context ) == EGL_FALSE)
+        {
+            LOG_ERROR( "        eglMakeCurrent() failed: %s", EglErrorString( eglGetError() ) );
+        }
+        
+        applyTrackingThreadConfiguration();
+        
+        markStartupPhase(STARTUP_PHASE_TRACKING_THREAD_READY);
+        LOG_MESSAGE("OculusMobileSDKHeadTracking thread running...");
+        
+        frameIndex.store(0);
+        
+        const ovrHeadModelParms headModelParms = vrapi_DefaultHeadModelParms();
+        
+        for (destroyed = false; !destroyed ;)
+        {
+            for ( ; ; )
+            {
+                ovrMessage message;
+                // In VR mode there is periodic work to do so do not block on the queue
+                const bool waitForMessages = !destroyed && ovr == NULL;
+                if (!ovrMessageQueue_GetNextMessage(&messageQueue, &message, waitForMessages))
+                {
+                    break;
+                }
+                
+                logMessage("Message received. message.Id = %d", message.Id);
+                flightRecorder.recordEvent(FLIGHT_EVENT_LIFECYCLE, "message %s", getMessageName(message.Id));
                 
                 switch (message.Id)
                 {
                     case MESSAGE_START:
                         break;
                     case MESSAGE_RESUME:
-                        resumed = true;
+                        ((OculusMobileSDKHeadTrackingConsumer*)ovrMessage_GetPointerParm(&message, 0))->resumed = true;
+                        updateFromConsumers();
                         break;
                     case MESSAGE_PAUSE:
-                        resumed = false;
+                        ((OculusMobileSDKHeadTrackingConsumer*)ovrMessage_GetPointerParm(&message, 0))->resumed = false;
+                        updateFromConsumers();
                         break;
                     case MESSAGE_STOP:
                         destroyed = true;
                         break;
                     case MESSAGE_SURFACE_CREATED:
+                        setConsumerNativeWindow((OculusMobileSDKHeadTrackingConsumer*)ovrMessage_GetPointerParm(&message, 0), (ANativeWindow*)ovrMessage_GetPointerParm(&message, 1));
                         break;
                     case MESSAGE_SURFACE_DESTROYED:
+                        setConsumerNativeWindow((OculusMobileSDKHeadTrackingConsumer*)ovrMessage_GetPointerParm(&message, 0), NULL);
+                        break;
+                    case MESSAGE_SET_SAMPLING_RATE:
+                        ((OculusMobileSDKHeadTrackingConsumer*)ovrMessage_GetPointerParm(&message, 0))->samplingRate = ovrMessage_GetIntegerParm(&message, 1);
+                        updateFromConsumers();
                         break;
+                    case MESSAGE_ATTACH_CONSUMER:
+                    {
+                        OculusMobileSDKHeadTrackingConsumer* consumer = (OculusMobileSDKHeadTrackingConsumer*)ovrMessage_GetPointerParm(&message, 0);
+                        consumers.push_back(consumer);
+                        consumer->sampleCursor = sampleHistory.getWriteCount();
+                        // Catch up with what the session already went through
+                        if (errorMessage != NULL)
+                        {
+                            notifyError(consumer);
+                        }
+                        if (started)
+                        {
+                            notifyStarted(consumer);
+                        }
+                        break;
+                    }
+                    case MESSAGE_DETACH_CONSUMER:
+                    {
+                        OculusMobileSDKHeadTrackingConsumer* consumer = (OculusMobileSDKHeadTrackingConsumer*)ovrMessage_GetPointerParm(&message, 0);
+                        consumer->resumed = false;
+                        consumer->samplingRate = 0;
+                        setConsumerNativeWindow(consumer, NULL);
+                        for (size_t i = 0; i < consumers.size(); i++)
+                        {
+                            if (consumers[i] == consumer)
+                            {
+                                consumers.erase(consumers.begin() + i);
+                                break;
+                            }
+                        }
+                        if (java.Env->IsSameObject(consumer->activityJObject, activityJObject))
+                        {
+                            setActivityFromConsumers(consumer);
+                        }
+                        updateFromConsumers();
+                        break;
+                    }
+                    case MESSAGE_SET_THREAD_CONFIGURATION:
+                    {
+                        const int configuredThread = ovrMessage_GetIntegerParm(&message, 0);
+                        threadConfigurations[configuredThread].AffinityMask = (unsigned int)ovrMessage_GetIntegerParm(&message, 1);
+                        threadConfigurations[configuredThread].FifoPriority = ovrMessage_GetIntegerParm(&message, 2);
+                        if (configuredThread == TRACKING_THREAD)
+                        {
+                            applyTrackingThreadConfiguration();
+                        }
+                        else if (sampler.isRunning())
+                        {
+                            // The sampler thread applies its configuration when it starts
+                            sampler.stop();
+                            startSampler();
+                        }
+                        applyPerformanceParms();
+                        break;
+                    }
+                    case MESSAGE_SET_WARM_RESUME_GRACE_PERIOD:
+                        warmResumeGracePeriod = ovrMessage_GetFloatParm(&message, 0);
+                        break;
+                    case MESSAGE_SET_PERFORMANCE_GOVERNOR_ENABLED:
+                        governorEnabled = ovrMessage_GetIntegerParm(&message, 0) != 0;
+                        governor.reset();
+                        applyGovernorDecision();
+                        break;
+                    case MESSAGE_SET_POSE_RECORDING:
+                    {
+                        // The sampler thread is the only producer of the recorder
+                        const bool samplerWasRunning = sampler.isRunning();
+                        sampler.stop();
+                        poseRecorder.stop();
+                        const char* pathPrefix = (const char*)ovrMessage_GetPointerParm(&message, 0);
+                        bool* recordingStarted = (bool*)ovrMessage_GetPointerParm(&message, 3);
+                        if (pathPrefix != NULL)
+                        {
+                            *recordingStarted = poseRecorder.start(&workers, pathPrefix, ovrMessage_GetIntegerParm(&message, 1), ovrMessage_GetIntegerParm(&message, 2));
+                            if (!*recordingStarted)
+                            {
+                                LOG_ERROR("Could not start the pose recording to %s.", pathPrefix);
+                                recordError("Could not start the pose recording.");
+                            }
+                        }
+                        if (samplerWasRunning)
+                        {
+                            startSampler();
+                        }
+                        break;
+                    }
+                    case MESSAGE_SET_POSE_REPLAY:
+                    {
+                        // Waits for the readers of the previous recording
+                        poseReplay.setRecording((ovrPoseRecording*)ovrMessage_GetPointerParm(&message, 0));
+                        *(bool*)ovrMessage_GetPointerParm(&message, 1) = true;
+                        break;
+                    }
                 }
                 
                 handleVRModeChanges();
             }
+            
+            if (ovr != NULL && !destroyed)
+            {
+                if (vrModeStateMachine.getState() == VrModeStateMachine::STATE_SUSPENDED)
+                {
+                    // Leaves VR mode once the grace period is over
+                    handleVRModeChanges();
+                }
+                runPeriodicTasks();
+                ovrMessageQueue_SleepUntilMessageOrTimeout(&messageQueue, PERIODIC_TASKS_SECONDS);
+            }
         }
         
-        if (ovr != NULL)
+        // Leave VR mode and destroy the window surface through the usual transitions
+        nativeWindow = NULL;
+        handleVRModeChanges();
+        // The sampler is stopped, the workers are still running
+        poseRecorder.stop();
+        flightRecorder.recordEvent(FLIGHT_EVENT_LIFECYCLE, "tracking thread stopped");
+        flightRecorder.dumpAsync(&workers, "stop");
+    
         {
-            vrapi_LeaveVrMode(ovr);
-            ovr = NULL;
+            PROFILE_PHASE(PHASE_EGL_CONTEXT_RELEASE);
+            // The window surface is destroyed, the rest is kept for the next session
+            if (egl.Context != EGL_NO_CONTEXT)
+            {
+                eglMakeCurrent( egl.Display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT );
+            }
+            ovrEglResources_Release( &egl );
         }
-    
-        ovrEgl_DestroyContext( &egl );
         
-        vrapi_Shutdown();
+        {
+            PROFILE_PHASE(PHASE_VRAPI_SHUTDOWN);
+            vrapi_Shutdown();
+        }
         
         SystemActivities_Shutdown( &java );
         
@@ -710,80 +1632,201 @@ private:
     }
     
 public:
-    OculusMobileSDKHeadTracking(): javaVM(NULL), resumed(false), destroyed(false), started(false), ovr(NULL), frameIndex(0), nativeWindow(NULL)
+    // In tracking-only mode the graphics state is kept to what vrapi needs to enter VR mode (a context
+    // current on a window surface): the offscreen surface is 1x1 and the lowest clock levels are used.
+    // The window surface comes from the consumers, see OculusMobileSDKHeadTracking.start(Activity, boolean).
+    explicit OculusMobileSDKHeadTracking(const bool trackingOnly = false): javaVM(NULL), errorMessage(NULL), eyeFOVX(0.0f), eyeFOVY(0.0f), interpupillaryDistance(0.0f), ovr(NULL), frameIndex(0), nativeWindow(NULL), destroyed(false), resumed(false), started(false), predictionAccuracyEnabled(false), adaptiveHorizonEnabled(false), lastHorizon(0.0f), sampledPredictionEnabled(false), samplingRate(0), mounted(0), docked(0), displayRefreshRate(60), governor(trackingOnly ? TRACKING_ONLY_CPU_LEVEL : CPU_LEVEL, trackingOnly ? TRACKING_ONLY_GPU_LEVEL : GPU_LEVEL), governorEnabled(false), warmResumeGracePeriod(0.0), suspendTime(0), resumeTime(0), trackingOnly(trackingOnly), cpuLevel(trackingOnly ? TRACKING_ONLY_CPU_LEVEL : CPU_LEVEL), gpuLevel(trackingOnly ? TRACKING_ONLY_GPU_LEVEL : GPU_LEVEL), graphicsFootprint(trackingOnly), surfaceNativeWindow(NULL), activityChanged(false)
     {
         ovrEgl_Clear(&egl);
+        for (int i = 0; i < STARTUP_PHASE_COUNT; i++)
+        {
+            startupPhaseTimes[i].store(0);
+        }
+        sem_init(&eglContextCreated, 0, 0);
+        ovrThreadConfiguration_Init(&threadConfigurations[TRACKING_THREAD], "OVRHeadTracking");
+        ovrThreadConfiguration_Init(&threadConfigurations[SAMPLER_THREAD], "OVRHeadSampler");
+        memset(threadTelemetries, 0, sizeof(threadTelemetries));
+        pthread_mutex_init(&threadTelemetryMutex, NULL);
+    }
+    
+    ~OculusMobileSDKHeadTracking()
+    {
+        pthread_mutex_destroy(&threadTelemetryMutex);
+        sem_destroy(&eglContextCreated);
     }
 
-    void start(JNIEnv* jniEnv, jobject activityJObject, jobject oculusMobileSDKHeadTrackingJObject, jobject dataJObject)
+    // The Java objects are only used to cache their classes. Returns false if the thread could not be created.
+    // The startup is overlapped: the EGL context is created by a worker and the JNI caching is done here
+    // while the tracking thread initializes vrapi, and this does not wait for the tracking thread to be ready
+    // (the messages posted meanwhile are simply processed once it is).
+    bool start(JNIEnv* jniEnv, jobject activityJObject, jobject oculusMobileSDKHeadTrackingJObject, jobject dataJObject)
     {
+        markStartupPhase(STARTUP_PHASE_START);
+        flightRecorder.recordEvent(FLIGHT_EVENT_LIFECYCLE, "start");
+        PROFILE_LIFECYCLE_BEGIN();
         jniEnv->GetJavaVM(&javaVM);
         // Keep some references alive
         this->activityJObject = jniEnv->NewGlobalRef(activityJObject);
-        this->oculusMobileSDKHeadTrackingJObject = jniEnv->NewGlobalRef(oculusMobileSDKHeadTrackingJObject);
-        this->dataJObject = jniEnv->NewGlobalRef(dataJObject);
-        
-        // Cache some JNI methods and classes
-        oculusMobileSDKHeadTrackingJClass = jniEnv->GetObjectClass(oculusMobileSDKHeadTrackingJObject);
-        headTrackingStartedMethodID = jniEnv->GetMethodID(oculusMobileSDKHeadTrackingJClass, "headTrackingStartedFromNative", "(FFF)V");
-        headTrackingErrorMethodID = jniEnv->GetMethodID(oculusMobileSDKHeadTrackingJClass, "headTrackingErrorFromNative", "(Ljava/lang/String;)V");
-        
-        // Cache OculudMobileSDKHeadTrackingData properties
-        dataJClass = jniEnv->GetObjectClass(dataJObject);
-        dataTimeStampFieldID = jniEnv->GetFieldID(dataJClass, "timeStamp", "D");
-        dataOrientationXFieldID = jniEnv->GetFieldID(dataJClass, "orientationX", "F");
-        dataOrientationYFieldID = jniEnv->GetFieldID(dataJClass, "orientationY", "F");
-        dataOrientationZFieldID = jniEnv->GetFieldID(dataJClass, "orientationZ", "F");
-        dataOrientationWFieldID = jniEnv->GetFieldID(dataJClass, "orientationW", "F");
-        dataLinearVelocityXFieldID = jniEnv->GetFieldID(dataJClass, "linearVelocityX", "F");
-        dataLinearVelocityYFieldID = jniEnv->GetFieldID(dataJClass, "linearVelocityY", "F");
-        dataLinearVelocityZFieldID = jniEnv->GetFieldID(dataJClass, "linearVelocityZ", "F");
-        dataAngularVelocityXFieldID = jniEnv->GetFieldID(dataJClass, "angularVelocityX", "F");
-        dataAngularVelocityYFieldID = jniEnv->GetFieldID(dataJClass, "angularVelocityY", "F");
-        dataAngularVelocityZFieldID = jniEnv->GetFieldID(dataJClass, "angularVelocityZ", "F");
-        dataLinearAccelerationXFieldID = jniEnv->GetFieldID(dataJClass, "linearAccelerationX", "F");
-        dataLinearAccelerationYFieldID = jniEnv->GetFieldID(dataJClass, "linearAccelerationY", "F");
-        dataLinearAccelerationZFieldID = jniEnv->GetFieldID(dataJClass, "linearAccelerationZ", "F");
-        dataAngularAccelerationXFieldID = jniEnv->GetFieldID(dataJClass, "angularAccelerationX", "F");
-        dataAngularAccelerationYFieldID = jniEnv->GetFieldID(dataJClass, "angularAccelerationY", "F");
-        dataAngularAccelerationZFieldID = jniEnv->GetFieldID(dataJClass, "angularAccelerationZ", "F");
-        dataMountedFieldID = jniEnv->GetFieldID(dataJClass, "mounted", "I");
-        dataDockedFieldID = jniEnv->GetFieldID(dataJClass, "docked", "I");
         
         ovrMessageQueue_Create(&messageQueue);
         
-        const int createErr = pthread_create( &thread, NULL, threadFunctionStatic, this);
+        if (!workers.start())
+        {
+            // Not fatal: the tasks are run by whoever submits them
+            LOG_ERROR("Could not create the worker threads.");
+        }
+        
+        ovrWorkerTask createEglContext;
+        createEglContext.Function = createEglContextTask;
+        createEglContext.Context = this;
+        if (!workers.submit(createEglContext))
+        {
+            // The queue is empty at this point so this should never happen
+            createEglContextTask(&createEglContext);
+        }
+        
+        int createErr;
+        {
+            PROFILE_PHASE(PHASE_THREAD_CREATE);
+            createErr = pthread_create( &thread, NULL, threadFunctionStatic, this);
+        }
         if ( createErr != 0 )
         {
-            jniEnv->CallVoidMethod(oculusMobileSDKHeadTrackingJObject, headTrackingErrorMethodID, java.Env->NewStringUTF("Could not create native head tracking thread."));
             LOG_ERROR("pthread_create returned %i", createErr);
+            waitForEglContext();
+            ovrEglResources_Release( &egl );
+            jniEnv->DeleteGlobalRef(this->activityJObject);
+            ovrMessageQueue_Destroy(&messageQueue);
+            workers.stop();
+            jclass oculusMobileSDKHeadTrackingJClass = jniEnv->GetObjectClass(oculusMobileSDKHeadTrackingJObject);
+            jmethodID headTrackingErrorMethodID = jniEnv->GetMethodID(oculusMobileSDKHeadTrackingJClass, "headTrackingErrorFromNative", "(Ljava/lang/String;)V");
+            jniEnv->CallVoidMethod(oculusMobileSDKHeadTrackingJObject, headTrackingErrorMethodID, jniEnv->NewStringUTF("Could not create native head tracking thread."));
+            jniEnv->DeleteLocalRef(oculusMobileSDKHeadTrackingJClass);
+            return false;
+        }
+        markStartupPhase(STARTUP_PHASE_TRACKING_THREAD_CREATED);
+        
+        {
+            PROFILE_PHASE(PHASE_JNI_CACHING);
+            // Cache some JNI methods and classes. The tracking thread only uses them to process messages, which are posted after this.
+            oculusMobileSDKHeadTrackingJClass = jniEnv->GetObjectClass(oculusMobileSDKHeadTrackingJObject);
+            headTrackingStartedMethodID = jniEnv->GetMethodID(oculusMobileSDKHeadTrackingJClass, "headTrackingStartedFromNative", "(FFF)V");
+            headTrackingErrorMethodID = jniEnv->GetMethodID(oculusMobileSDKHeadTrackingJClass, "headTrackingErrorFromNative", "(Ljava/lang/String;)V");
+            
+            // Cache OculudMobileSDKHeadTrackingData properties
+            dataJClass = jniEnv->GetObjectClass(dataJObject);
+            dataTimeStampFieldID = jniEnv->GetFieldID(dataJClass, "timeStamp", "D");
+            dataOrientationXFieldID = jniEnv->GetFieldID(dataJClass, "orientationX", "F");
+            dataOrientationYFieldID = jniEnv->GetFieldID(dataJClass, "orientationY", "F");
+            dataOrientationZFieldID = jniEnv->GetFieldID(dataJClass, "orientationZ", "F");
+            dataOrientationWFieldID = jniEnv->GetFieldID(dataJClass, "orientationW", "F");
+            dataLinearVelocityXFieldID = jniEnv->GetFieldID(dataJClass, "linearVelocityX", "F");
+            dataLinearVelocityYFieldID = jniEnv->GetFieldID(dataJClass, "linearVelocityY", "F");
+            dataLinearVelocityZFieldID = jniEnv->GetFieldID(dataJClass, "linearVelocityZ", "F");
+            dataAngularVelocityXFieldID = jniEnv->GetFieldID(dataJClass, "angularVelocityX", "F");
+            dataAngularVelocityYFieldID = jniEnv->GetFieldID(dataJClass, "angularVelocityY", "F");
+            dataAngularVelocityZFieldID = jniEnv->GetFieldID(dataJClass, "angularVelocityZ", "F");
+            dataLinearAccelerationXFieldID = jniEnv->GetFieldID(dataJClass, "linearAccelerationX", "F");
+            dataLinearAccelerationYFieldID = jniEnv->GetFieldID(dataJClass, "linearAccelerationY", "F");
+            dataLinearAccelerationZFieldID = jniEnv->GetFieldID(dataJClass, "linearAccelerationZ", "F");
+            dataAngularAccelerationXFieldID = jniEnv->GetFieldID(dataJClass, "angularAccelerationX", "F");
+            dataAngularAccelerationYFieldID = jniEnv->GetFieldID(dataJClass, "angularAccelerationY", "F");
+            dataAngularAccelerationZFieldID = jniEnv->GetFieldID(dataJClass, "angularAccelerationZ", "F");
+            dataMountedFieldID = jniEnv->GetFieldID(dataJClass, "mounted", "I");
+            dataDockedFieldID = jniEnv->GetFieldID(dataJClass, "docked", "I");
         }
         
+        markStartupPhase(STARTUP_PHASE_JNI_CACHED);
+        
         // Post MESSAGE_START
         ovrMessageQueue_Enable(&messageQueue, true);
         ovrMessage message;
-        ovrMessage_Init(&message, MESSAGE_START, MQ_WAIT_PROCESSED);
+        ovrMessage_Init(&message, MESSAGE_START, MQ_WAIT_NONE);
         ovrMessageQueue_PostMessage(&messageQueue, &message);
+        return true;
     }
     
-    void resume()
+    // Returns the session shared by the whole process, starting it for the first consumer, and
+    // attaches the consumer to it. Returns NULL if the session could not be started. trackingOnly only
+    // matters for the first consumer, the others get the session as it is.
+    static OculusMobileSDKHeadTracking* acquireShared(JNIEnv* jniEnv, jobject activityJObject, OculusMobileSDKHeadTrackingConsumer* consumer, bool trackingOnly)
+    {
+        pthread_mutex_lock(&sharedMutex);
+        while (shared == NULL && sharedStopping)
+        {
+            pthread_cond_wait(&sharedStopped, &sharedMutex);
+        }
+        if (shared == NULL)
+        {
+            OculusMobileSDKHeadTracking* session = new OculusMobileSDKHeadTracking(trackingOnly);
+            if (!session->start(jniEnv, activityJObject, consumer->oculusMobileSDKHeadTrackingJObject, consumer->dataJObject))
+            {
+                delete session;
+                pthread_mutex_unlock(&sharedMutex);
+                return NULL;
+            }
+            shared = session;
+        }
+        sharedReferenceCount++;
+        OculusMobileSDKHeadTracking* session = shared;
+        pthread_mutex_unlock(&sharedMutex);
+        
+        consumer->session = session;
+        // Do not wait for a session that is still starting, the consumer is attached once it is ready
+        session->postConsumerMessage(MESSAGE_ATTACH_CONSUMER, consumer, MQ_WAIT_NONE);
+        return session;
+    }
+    
+    // Detaches the consumer and stops the shared session if it was the last one. The session is stopped
+    // outside of sharedMutex so the other consumers do not wait for the whole teardown.
+    static void releaseShared(JNIEnv* jniEnv, OculusMobileSDKHeadTrackingConsumer* consumer)
+    {
+        OculusMobileSDKHeadTracking* session = consumer->session;
+        // The reference of the consumer keeps the session alive meanwhile
+        session->postConsumerMessage(MESSAGE_DETACH_CONSUMER, consumer);
+        consumer->session = NULL;
+        pthread_mutex_lock(&sharedMutex);
+        const bool last = --sharedReferenceCount == 0;
+        if (last)
+        {
+            shared = NULL;
+            sharedStopping = true;
+        }
+        pthread_mutex_unlock(&sharedMutex);
+        if (last)
+        {
+            session->stop(jniEnv);
+            delete session;
+            pthread_mutex_lock(&sharedMutex);
+            sharedStopping = false;
+            pthread_cond_broadcast(&sharedStopped);
+            pthread_mutex_unlock(&sharedMutex);
+        }
+    }
+    
+    void postConsumerMessage(int id, OculusMobileSDKHeadTrackingConsumer* consumer, ovrMQWait wait = MQ_WAIT_PROCESSED)
     {
-        // Post MESSAGE_RESUME
         ovrMessage message;
-        ovrMessage_Init(&message, MESSAGE_RESUME, MQ_WAIT_PROCESSED);
+        ovrMessage_Init(&message, id, wait);
+        ovrMessage_SetPointerParm(&message, 0, consumer);
         ovrMessageQueue_PostMessage(&messageQueue, &message);
     }
     
-    void pause()
+    void resume(OculusMobileSDKHeadTrackingConsumer* consumer)
+    {
+        // Post MESSAGE_RESUME
+        postConsumerMessage(MESSAGE_RESUME, consumer);
+    }
+    
+    void pause(OculusMobileSDKHeadTrackingConsumer* consumer)
     {
         // Post MESSAGE_PAUSE
-        ovrMessage message;
-        ovrMessage_Init( &message, MESSAGE_PAUSE, MQ_WAIT_PROCESSED );
-        ovrMessageQueue_PostMessage( &messageQueue, &message );
+        postConsumerMessage(MESSAGE_PAUSE, consumer);
     }
     
     void stop(JNIEnv* jniEnv)
     {
+        flightRecorder.recordEvent(FLIGHT_EVENT_LIFECYCLE, "stop");
         // Post MESSAGE_STOP
         ovrMessage message;
         ovrMessage_Init(&message, MESSAGE_STOP, MQ_WAIT_PROCESSED);
@@ -791,54 +1834,154 @@ public:
         ovrMessageQueue_Enable(&messageQueue, false);
         
         // Wait for the thread and free resources
-        pthread_join(thread, NULL);
+        {
+            PROFILE_PHASE(PHASE_THREAD_JOIN);
+            pthread_join(thread, NULL);
+        }
+        // Runs whatever the tracking thread left queued
+        workers.stop();
         
         // Free some references
         jniEnv->DeleteGlobalRef(activityJObject);
-        jniEnv->DeleteGlobalRef(oculusMobileSDKHeadTrackingJObject);
-        jniEnv->DeleteGlobalRef(dataJObject);
         
         ovrMessageQueue_Destroy(&messageQueue);
     }
     
-    inline void setNativeWindow(ANativeWindow* nativeWindow)
+    // Takes ownership of the (acquired) nativeWindow, NULL when the consumer's surface is destroyed.
+    void setNativeWindow(OculusMobileSDKHeadTrackingConsumer* consumer, ANativeWindow* nativeWindow)
+    {
+        // Post MESSAGE_SURFACE_CREATED or MESSAGE_SURFACE_DESTROYED. The tracking thread decides which window the session uses.
+        ovrMessage message;
+        ovrMessage_Init(&message, nativeWindow != NULL ? MESSAGE_SURFACE_CREATED : MESSAGE_SURFACE_DESTROYED, MQ_WAIT_PROCESSED);
+        ovrMessage_SetPointerParm(&message, 0, consumer);
+        ovrMessage_SetPointerParm(&message, 1, nativeWindow);
+        ovrMessageQueue_PostMessage(&messageQueue, &message);
+    }
+    
+    inline JavaVM* getJavaVM() const
+    {
+        return javaVM;
+    }
+    
+    inline int getDisplayRefreshRate() const
+    {
+        return displayRefreshRate.load(std::memory_order_relaxed);
+    }
+    
+    // The next display refresh (vsync) in GetTimeInNanoseconds time, stepped from the predicted display time of the
+    // next frame, or the given fallback time if not in VR mode. Any thread.
+    long long getNextDisplayRefreshTime(const long long fallbackTime)
+    {
+        GuardedPointer<ovrMobile>::ReadScope ovrScope(sharedOvr);
+        ovrMobile* ovr = ovrScope.get();
+        const int rate = displayRefreshRate.load(std::memory_order_relaxed);
+        if (ovr == NULL || rate <= 0)
+        {
+            return fallbackTime;
+        }
+        const double period = 1.0 / rate;
+        const long long nowInNanoseconds = GetTimeInNanoseconds();
+        const double now = vrapi_GetTimeInSeconds();
+        // The prediction may be for a frame that is already past (nobody queried for a while) or a few refreshes ahead
+        const double displayTime = vrapi_GetPredictedDisplayTime(ovr, frameIndex.load(std::memory_order_relaxed) + 1);
+        const double nextDisplayTime = displayTime + (floor((now - displayTime) / period) + 1.0) * period;
+        return nowInNanoseconds + (long long)((nextDisplayTime - now) * 1e9);
+    }
+    
+    // Copies the samples of the history the consumer has not read yet, oldest first, as
+    // SAMPLE_DOUBLE_COUNT doubles each (time, orientation x, y, z, w). The samples the consumer fell
+    // too far behind for are skipped. Returns how many were copied.
+    int readSamples(OculusMobileSDKHeadTrackingConsumer* consumer, double* values, int maxSamples)
     {
-        // Is the new nativeWindow is different from the current one?
-        if ( this->nativeWindow != nativeWindow )
+        const unsigned int writeCount = sampleHistory.getWriteCount();
+        if (writeCount - consumer->sampleCursor > (unsigned int)SAMPLE_HISTORY_SIZE)
+        {
+            consumer->sampleCursor = writeCount - SAMPLE_HISTORY_SIZE;
+        }
+        int count = 0;
+        for ( ; consumer->sampleCursor != writeCount && count < maxSamples; consumer->sampleCursor++)
         {
-            if (this->nativeWindow != NULL)
+            ovrTracking tracking;
+            if (!sampleHistory.read(consumer->sampleCursor, tracking))
             {
-                // There is a current native window so post MESSAGE_ON_SURFACE_DESTROYED
-                ovrMessage message;
-                ovrMessage_Init( &message, MESSAGE_SURFACE_DESTROYED, MQ_WAIT_PROCESSED );
-                ovrMessageQueue_PostMessage(&messageQueue, &message);
-                ANativeWindow_release(this->nativeWindow);
-                this->nativeWindow = NULL;
+                continue;
             }
-            if (nativeWindow != NULL)
+            double* sampleValues = values + count * SAMPLE_DOUBLE_COUNT;
+            sampleValues[0] = tracking.HeadPose.TimeInSeconds;
+            sampleValues[1] = tracking.HeadPose.Pose.Orientation.x;
+            sampleValues[2] = tracking.HeadPose.Pose.Orientation.y;
+            sampleValues[3] = tracking.HeadPose.Pose.Orientation.z;
+            sampleValues[4] = tracking.HeadPose.Pose.Orientation.w;
+            count++;
+        }
+        return count;
+    }
+    
+    // Predicts the tracking for the next frame. Returns false if not in VR mode. Any thread.
+    // A frame query (getData) advances the frame and is what the adaptive horizon measures and the late latch follows;
+    // the push deliveries only read the prediction for the next frame and leave all that untouched.
+    bool predictTracking(ovrTracking& tracking, const bool frameQuery = true)
+    {
+        // Keeps the tracking thread from leaving VR mode until we are done with ovr
+        GuardedPointer<ovrMobile>::ReadScope ovrScope(sharedOvr);
+        ovrMobile* ovr = ovrScope.get();
+        if (ovr == NULL)
+        {
+            return false;
+        }
+        if (startupPhaseTimes[STARTUP_PHASE_FIRST_POSE].load(std::memory_order_relaxed) == 0)
+        {
+            markStartupPhase(STARTUP_PHASE_FIRST_POSE);
+        }
+        const long long frame = frameQuery ? frameIndex.fetch_add(1, std::memory_order_relaxed) + 1 : frameIndex.load(std::memory_order_relaxed) + 1;
+        const double now = vrapi_GetTimeInSeconds();
+        const double predictedDisplayTime = getPredictionTargetTime(ovr, now, frame);
+        if (frameQuery)
+        {
+            lastHorizon = (float)(predictedDisplayTime - now);
+            if (adaptiveHorizonEnabled)
             {
-                // A new native window has been provided so post MESSAGE_ON_SURFACE_CREATED
-                this->nativeWindow = nativeWindow;
-                ovrMessage message;
-                ovrMessage_Init(&message, MESSAGE_SURFACE_CREATED, MQ_WAIT_PROCESSED);
-                ovrMessageQueue_PostMessage(&messageQueue, &message);
+                adaptiveHorizon.queried(now);
+            }
+        }
+        // When asked for and with the sampler running, the newest sample is at most one sampling period old
+        // so it is just re-predicted to our target time instead of calling vrapi.
+        if (!sampledPredictionEnabled || !sampler.isRunning() || !lateLatch.predictTracking(predictedDisplayTime, &tracking))
+        {
+            tracking = getPredictedTracking(ovr, predictedDisplayTime, frameQuery);
+            // No position is exported so the head model is only applied if a late latched pose is requested.
+            if (frameQuery)
+            {
+                lateLatch.update(tracking);
             }
         }
-        else if ( nativeWindow != NULL )
+        
+        flightRecorder.recordPose(tracking, GetTimeInNanoseconds(), frameQuery ? FLIGHT_POSE_QUERIED : FLIGHT_POSE_DELIVERED);
+        
+        if (predictionAccuracyEnabled)
         {
-            // Both the curent native window and the new one are the same (and not NULL). Release the new one (acquired outside of this call)
-            ANativeWindow_release(nativeWindow);
+            // The most recent sensor reading is the ground truth for the predictions made before
+            const ovrTracking latestTracking = getPredictedTracking(ovr, 0.0, false);
+            predictionAccuracy.addObservation(latestTracking.HeadPose.TimeInSeconds, latestTracking.HeadPose.Pose.Orientation);
+            predictionAccuracy.addPrediction(predictedDisplayTime, predictedDisplayTime - now, tracking.HeadPose.Pose.Orientation);
         }
+        return true;
     }
     
-    void getData(JNIEnv* jniEnv)
+    template<unsigned int FIELDS>
+    void getData(JNIEnv* jniEnv, jobject dataJObject)
+    {
+        ovrTracking tracking;
+        if (predictTracking(tracking))
+        {
+            setData<FIELDS>(jniEnv, dataJObject, tracking);
+        }
+        // Otherwise (not in VR mode) the data keeps its last values
+    }
+    
+    template<unsigned int FIELDS>
+    void setData(JNIEnv* jniEnv, jobject dataJObject, const ovrTracking& tracking)
     {
-        frameIndex++;
-        const ovrHeadModelParms headModelParms = vrapi_DefaultHeadModelParms();
-        const double predictedDisplayTime = vrapi_GetPredictedDisplayTime(ovr, frameIndex);
-        const ovrTracking baseTracking = vrapi_GetPredictedTracking(ovr, predictedDisplayTime);
-        const ovrTracking tracking = vrapi_ApplyHeadModel(&headModelParms, &baseTracking);
-        
         // ==============================================
         // THIS CODE IS JUST FOR REFERENCE PURPOSES! BEGIN
         //            // Position and orientation together.
@@ -878,66 +2021,576 @@ public:
         // THIS CODE IS JUST FOR REFERENCE PURPOSES! END
         // ==============================================
         
-        jniEnv->SetDoubleField(dataJObject, dataTimeStampFieldID, tracking.HeadPose.TimeInSeconds);
-        jniEnv->SetFloatField(dataJObject, dataOrientationXFieldID, tracking.HeadPose.Pose.Orientation.x);
-        jniEnv->SetFloatField(dataJObject, dataOrientationYFieldID, tracking.HeadPose.Pose.Orientation.y);
-        jniEnv->SetFloatField(dataJObject, dataOrientationZFieldID, tracking.HeadPose.Pose.Orientation.z);
-        jniEnv->SetFloatField(dataJObject, dataOrientationWFieldID, tracking.HeadPose.Pose.Orientation.w);
-        jniEnv->SetFloatField(dataJObject, dataLinearVelocityXFieldID, tracking.HeadPose.LinearVelocity.x);
-        jniEnv->SetFloatField(dataJObject, dataLinearVelocityYFieldID, tracking.HeadPose.LinearVelocity.y);
-        jniEnv->SetFloatField(dataJObject, dataLinearVelocityZFieldID, tracking.HeadPose.LinearVelocity.z);
-        jniEnv->SetFloatField(dataJObject, dataLinearAccelerationXFieldID, tracking.HeadPose.LinearAcceleration.x);
-        jniEnv->SetFloatField(dataJObject, dataLinearAccelerationYFieldID, tracking.HeadPose.LinearAcceleration.y);
-        jniEnv->SetFloatField(dataJObject, dataLinearAccelerationZFieldID, tracking.HeadPose.LinearAcceleration.z);
-        jniEnv->SetFloatField(dataJObject, dataAngularVelocityXFieldID, tracking.HeadPose.AngularVelocity.x);
-        jniEnv->SetFloatField(dataJObject, dataAngularVelocityYFieldID, tracking.HeadPose.AngularVelocity.y);
-        jniEnv->SetFloatField(dataJObject, dataAngularVelocityZFieldID, tracking.HeadPose.AngularVelocity.z);
-        jniEnv->SetFloatField(dataJObject, dataAngularAccelerationXFieldID, tracking.HeadPose.AngularAcceleration.x);
-        jniEnv->SetFloatField(dataJObject, dataAngularAccelerationYFieldID, tracking.HeadPose.AngularAcceleration.y);
-        jniEnv->SetFloatField(dataJObject, dataAngularAccelerationZFieldID, tracking.HeadPose.AngularAcceleration.z);
-        jniEnv->SetIntField(dataJObject, dataMountedFieldID, vrapi_GetSystemStatusInt(&java, VRAPI_SYS_STATUS_MOUNTED));
-        jniEnv->SetIntField(dataJObject, dataDockedFieldID, vrapi_GetSystemStatusInt(&java, VRAPI_SYS_STATUS_DOCKED));
+        if (FIELDS & DATA_FIELD_TIME_STAMP)
+        {
+            jniEnv->SetDoubleField(dataJObject, dataTimeStampFieldID, tracking.HeadPose.TimeInSeconds);
+        }
+        if (FIELDS & DATA_FIELD_ORIENTATION)
+        {
+            jniEnv->SetFloatField(dataJObject, dataOrientationXFieldID, tracking.HeadPose.Pose.Orientation.x);
+            jniEnv->SetFloatField(dataJObject, dataOrientationYFieldID, tracking.HeadPose.Pose.Orientation.y);
+            jniEnv->SetFloatField(dataJObject, dataOrientationZFieldID, tracking.HeadPose.Pose.Orientation.z);
+            jniEnv->SetFloatField(dataJObject, dataOrientationWFieldID, tracking.HeadPose.Pose.Orientation.w);
+        }
+        if (FIELDS & DATA_FIELD_LINEAR_VELOCITY)
+        {
+            jniEnv->SetFloatField(dataJObject, dataLinearVelocityXFieldID, tracking.HeadPose.LinearVelocity.x);
+            jniEnv->SetFloatField(dataJObject, dataLinearVelocityYFieldID, tracking.HeadPose.LinearVelocity.y);
+            jniEnv->SetFloatField(dataJObject, dataLinearVelocityZFieldID, tracking.HeadPose.LinearVelocity.z);
+        }
+        if (FIELDS & DATA_FIELD_LINEAR_ACCELERATION)
+        {
+            jniEnv->SetFloatField(dataJObject, dataLinearAccelerationXFieldID, tracking.HeadPose.LinearAcceleration.x);
+            jniEnv->SetFloatField(dataJObject, dataLinearAccelerationYFieldID, tracking.HeadPose.LinearAcceleration.y);
+            jniEnv->SetFloatField(dataJObject, dataLinearAccelerationZFieldID, tracking.HeadPose.LinearAcceleration.z);
+        }
+        if (FIELDS & DATA_FIELD_ANGULAR_VELOCITY)
+        {
+            jniEnv->SetFloatField(dataJObject, dataAngularVelocityXFieldID, tracking.HeadPose.AngularVelocity.x);
+            jniEnv->SetFloatField(dataJObject, dataAngularVelocityYFieldID, tracking.HeadPose.AngularVelocity.y);
+            jniEnv->SetFloatField(dataJObject, dataAngularVelocityZFieldID, tracking.HeadPose.AngularVelocity.z);
+        }
+        if (FIELDS & DATA_FIELD_ANGULAR_ACCELERATION)
+        {
+            jniEnv->SetFloatField(dataJObject, dataAngularAccelerationXFieldID, tracking.HeadPose.AngularAcceleration.x);
+            jniEnv->SetFloatField(dataJObject, dataAngularAccelerationYFieldID, tracking.HeadPose.AngularAcceleration.y);
+            jniEnv->SetFloatField(dataJObject, dataAngularAccelerationZFieldID, tracking.HeadPose.AngularAcceleration.z);
+        }
+        if (FIELDS & DATA_FIELD_MOUNTED)
+        {
+            jniEnv->SetIntField(dataJObject, dataMountedFieldID, mounted.load(std::memory_order_relaxed));
+        }
+        if (FIELDS & DATA_FIELD_DOCKED)
+        {
+            jniEnv->SetIntField(dataJObject, dataDockedFieldID, docked.load(std::memory_order_relaxed));
+        }
     }
-};
-
-extern "C"
-{
-    // Activity life cycle
-    JNIEXPORT jlong JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeStart(JNIEnv* jniEnv, jobject obj, jobject activityJObject, jobject oculusMobileSDKHeadTrackingJObject, jobject dataJObject)
+    
+    void setPredictionAccuracyEnabled(bool enabled)
     {
-        OculusMobileSDKHeadTracking* oculusMobileSDKHeadTracking = new OculusMobileSDKHeadTracking();
-        oculusMobileSDKHeadTracking->start(jniEnv, activityJObject, oculusMobileSDKHeadTrackingJObject, dataJObject);
-        return (jlong)((size_t)oculusMobileSDKHeadTracking);
-        
-        return 0;
+        if (enabled && !predictionAccuracyEnabled)
+        {
+            predictionAccuracy.reset();
+        }
+        predictionAccuracyEnabled = enabled;
     }
-
-    JNIEXPORT void JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeResume(JNIEnv* jniEnv, jobject obj, jlong objectPtr)
+    
+    void getPredictionAccuracy(JNIEnv* jniEnv, jfloatArray statisticsJFloatArray)
     {
-        OculusMobileSDKHeadTracking* oculusMobileSDKHeadTracking = (OculusMobileSDKHeadTracking*)((size_t)objectPtr);
-        
-        oculusMobileSDKHeadTracking->resume();
+        float statistics[PredictionAccuracy::STATISTICS_FLOAT_COUNT];
+        predictionAccuracy.getStatistics(statistics);
+        jniEnv->SetFloatArrayRegion(statisticsJFloatArray, 0, PredictionAccuracy::STATISTICS_FLOAT_COUNT, statistics);
     }
     
-    JNIEXPORT void JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativePause(JNIEnv* jniEnv, jobject obj, jlong objectPtr)
+    // The session samples at the highest rate requested by its consumers.
+    void setSamplingRate(OculusMobileSDKHeadTrackingConsumer* consumer, int samplesPerSecond)
     {
-        OculusMobileSDKHeadTracking* oculusMobileSDKHeadTracking = (OculusMobileSDKHeadTracking*)((size_t)objectPtr);
-        
-        oculusMobileSDKHeadTracking->pause();
+        // Post MESSAGE_SET_SAMPLING_RATE
+        ovrMessage message;
+        ovrMessage_Init(&message, MESSAGE_SET_SAMPLING_RATE, MQ_WAIT_PROCESSED);
+        ovrMessage_SetPointerParm(&message, 0, consumer);
+        ovrMessage_SetIntegerParm(&message, 1, samplesPerSecond);
+        ovrMessageQueue_PostMessage(&messageQueue, &message);
     }
     
-    JNIEXPORT void JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeStop(JNIEnv* jniEnv, jobject obj, jlong objectPtr)
+    // Seconds since start for each startup phase, -1 for the ones not reached yet.
+    void getStartupTimeline(double timeline[STARTUP_PHASE_COUNT]) const
     {
-        OculusMobileSDKHeadTracking* oculusMobileSDKHeadTracking = (OculusMobileSDKHeadTracking*)((size_t)objectPtr);
-        oculusMobileSDKHeadTracking->stop(jniEnv);
-        delete oculusMobileSDKHeadTracking;
-        oculusMobileSDKHeadTracking = 0;
+        const long long startTime = startupPhaseTimes[STARTUP_PHASE_START].load(std::memory_order_relaxed);
+        for (int i = 0; i < STARTUP_PHASE_COUNT; i++)
+        {
+            const long long time = startupPhaseTimes[i].load(std::memory_order_relaxed);
+            timeline[i] = time != 0 ? (double)(time - startTime) * 1e-9 : -1.0;
+        }
+    }
+    
+    void getWorkerPoolStatistics(JNIEnv* jniEnv, jfloatArray statisticsJFloatArray)
+    {
+        float statistics[WorkerPool::STATISTICS_FLOAT_COUNT];
+        workers.getStatistics(statistics);
+        jniEnv->SetFloatArrayRegion(statisticsJFloatArray, 0, WorkerPool::STATISTICS_FLOAT_COUNT, statistics);
+    }
+    
+    void getSamplingStatistics(JNIEnv* jniEnv, jfloatArray statisticsJFloatArray)
+    {
+        float statistics[PoseSampler::STATISTICS_FLOAT_COUNT];
+        sampler.getStatistics(statistics);
+        jniEnv->SetFloatArrayRegion(statisticsJFloatArray, 0, PoseSampler::STATISTICS_FLOAT_COUNT, statistics);
+    }
+    
+    inline void setSampledPredictionEnabled(bool enabled)
+    {
+        sampledPredictionEnabled = enabled;
+    }
+    
+    void setAdaptiveHorizonEnabled(bool enabled)
+    {
+        if (enabled && !adaptiveHorizonEnabled)
+        {
+            adaptiveHorizon.reset();
+        }
+        adaptiveHorizonEnabled = enabled;
+    }
+    
+    inline void frameSubmitted()
+    {
+        adaptiveHorizon.submitted(vrapi_GetTimeInSeconds());
+    }
+    
+    // The horizon used by the last getData call followed by the adaptive horizon statistics.
+    void getPredictionHorizon(float statistics[5]) const
+    {
+        statistics[0] = lastHorizon;
+        adaptiveHorizon.getStatistics(statistics + 1);
+    }
+    
+    inline bool getLateLatchedPose(double targetTime, ovrPosef* pose, ovrQuatf* deltaRotation) const
+    {
+        return lateLatch.predict(targetTime, pose, deltaRotation);
+    }
+    
+    // affinityMask 0 leaves the affinity as it is and fifoPriority 0 the scheduling policy.
+    void setThreadConfiguration(Threads configuredThread, unsigned int affinityMask, int fifoPriority)
+    {
+        // Post MESSAGE_SET_THREAD_CONFIGURATION
+        ovrMessage message;
+        ovrMessage_Init(&message, MESSAGE_SET_THREAD_CONFIGURATION, MQ_WAIT_PROCESSED);
+        ovrMessage_SetIntegerParm(&message, 0, configuredThread);
+        ovrMessage_SetIntegerParm(&message, 1, (int)affinityMask);
+        ovrMessage_SetIntegerParm(&message, 2, fifoPriority);
+        ovrMessageQueue_PostMessage(&messageQueue, &message);
+    }
+    
+    // 0 (the default) leaves VR mode as soon as paused.
+    void setWarmResumeGracePeriod(float seconds)
+    {
+        // Post MESSAGE_SET_WARM_RESUME_GRACE_PERIOD
+        ovrMessage message;
+        ovrMessage_Init(&message, MESSAGE_SET_WARM_RESUME_GRACE_PERIOD, MQ_WAIT_PROCESSED);
+        ovrMessage_SetFloatParm(&message, 0, seconds);
+        ovrMessageQueue_PostMessage(&messageQueue, &message);
+    }
+    
+    // Records every sampled pose (while sampling) to <pathPrefix>.<index>.ovrpose files of fileSize bytes, keeping
+    // the last maxFiles (0 keeps them all). Returns false if the first file could not be created.
+    bool startPoseRecording(const char* pathPrefix, int fileSize, int maxFiles)
+    {
+        // Post MESSAGE_SET_POSE_RECORDING
+        bool recordingStarted = false;
+        ovrMessage message;
+        ovrMessage_Init(&message, MESSAGE_SET_POSE_RECORDING, MQ_WAIT_PROCESSED);
+        ovrMessage_SetPointerParm(&message, 0, (void*)pathPrefix);
+        ovrMessage_SetIntegerParm(&message, 1, fileSize);
+        ovrMessage_SetIntegerParm(&message, 2, maxFiles);
+        ovrMessage_SetPointerParm(&message, 3, &recordingStarted);
+        ovrMessageQueue_PostMessage(&messageQueue, &message);
+        return recordingStarted;
+    }
+    
+    void stopPoseRecording()
+    {
+        // Post MESSAGE_SET_POSE_RECORDING
+        ovrMessage message;
+        ovrMessage_Init(&message, MESSAGE_SET_POSE_RECORDING, MQ_WAIT_PROCESSED);
+        ovrMessage_SetPointerParm(&message, 0, NULL);
+        ovrMessageQueue_PostMessage(&messageQueue, &message);
+    }
+    
+    // Loads a recording made by startPoseRecording (pathPrefix NULL unloads it). The live tracking is used until it is
+    // played. Returns false if no pose could be read.
+    bool loadPoseReplay(const char* pathPrefix)
+    {
+        ovrPoseRecording* poseRecording = NULL;
+        if (pathPrefix != NULL)
+        {
+            poseRecording = new ovrPoseRecording();
+            if (ovrPoseRecording_Load(pathPrefix, poseRecording->records) == 0 || poseRecording->records.empty())
+            {
+                delete poseRecording;
+                return false;
+            }
+            poseRecording->startTime = poseRecording->records.front().PoseTimeInSeconds;
+            poseRecording->duration = poseRecording->records.back().PoseTimeInSeconds - poseRecording->startTime;
+        }
+        // Post MESSAGE_SET_POSE_REPLAY
+        bool taken = false;
+        ovrMessage message;
+        ovrMessage_Init(&message, MESSAGE_SET_POSE_REPLAY, MQ_WAIT_PROCESSED);
+        ovrMessage_SetPointerParm(&message, 0, poseRecording);
+        ovrMessage_SetPointerParm(&message, 1, &taken);
+        ovrMessageQueue_PostMessage(&messageQueue, &message);
+        if (!taken)
+        {
+            // Not started
+            delete poseRecording;
+            return false;
+        }
+        return poseRecording != NULL;
+    }
+    
+    // speed 1 is real time, 0 as fast as possible (every pose query gets the next recorded pose).
+    inline void playPoseReplay(float speed, bool loop)
+    {
+        poseReplay.play(vrapi_GetTimeInSeconds(), speed, loop);
+    }
+    
+    inline void pausePoseReplay()
+    {
+        poseReplay.pause();
+    }
+    
+    inline void seekPoseReplay(double seconds)
+    {
+        poseReplay.seek(vrapi_GetTimeInSeconds(), seconds);
+    }
+    
+    void getPoseReplayStatistics(JNIEnv* jniEnv, jfloatArray statisticsJFloatArray)
+    {
+        float statistics[PoseReplay::STATISTICS_FLOAT_COUNT];
+        poseReplay.getStatistics(statistics);
+        jniEnv->SetFloatArrayRegion(statisticsJFloatArray, 0, PoseReplay::STATISTICS_FLOAT_COUNT, statistics);
+    }
+    
+    void getPoseRecorderStatistics(JNIEnv* jniEnv, jfloatArray statisticsJFloatArray)
+    {
+        float statistics[PoseRecorder::STATISTICS_FLOAT_COUNT];
+        poseRecorder.getStatistics(statistics);
+        jniEnv->SetFloatArrayRegion(statisticsJFloatArray, 0, PoseRecorder::STATISTICS_FLOAT_COUNT, statistics);
+    }
+    
+    // Where the flight recorder is dumped on error and on stop (<pathPrefix>.error.txt, <pathPrefix>.stop.txt) and kept
+    // (<pathPrefix>.flight, see FlightRecorder), NULL to not dump it.
+    void setFlightRecorderDumpPath(const char* pathPrefix)
+    {
+        flightRecorder.setDumpPathPrefix(pathPrefix);
+    }
+    
+    // Writes the flight recorder to the file in the calling thread. Returns false if it could not be written.
+    bool dumpFlightRecorder(const char* path)
+    {
+        flightRecorder.recordEvent(FLIGHT_EVENT_LIFECYCLE, "dump requested");
+        return flightRecorder.dump(path, "requested");
+    }
+    
+    void getFlightRecorderStatistics(JNIEnv* jniEnv, jfloatArray statisticsJFloatArray)
+    {
+        float statistics[FlightRecorder::STATISTICS_FLOAT_COUNT];
+        flightRecorder.getStatistics(statistics);
+        jniEnv->SetFloatArrayRegion(statisticsJFloatArray, 0, FlightRecorder::STATISTICS_FLOAT_COUNT, statistics);
+    }
+    
+    void getResumeStatistics(JNIEnv* jniEnv, jfloatArray statisticsJFloatArray)
+    {
+        float statistics[ResumeStatistics::STATISTICS_FLOAT_COUNT];
+        resumeStatistics.getStatistics(statistics);
+        jniEnv->SetFloatArrayRegion(statisticsJFloatArray, 0, ResumeStatistics::STATISTICS_FLOAT_COUNT, statistics);
+    }
+    
+    void getVrModeTransitions(JNIEnv* jniEnv, jfloatArray statisticsJFloatArray)
+    {
+        float statistics[VrModeStateMachine::STATISTICS_FLOAT_COUNT];
+        vrModeStateMachine.getStatistics(statistics);
+        jniEnv->SetFloatArrayRegion(statisticsJFloatArray, 0, VrModeStateMachine::STATISTICS_FLOAT_COUNT, statistics);
+    }
+    
+    inline int getVrModeState() const
+    {
+        return vrModeStateMachine.getState();
+    }
+    
+    void getGraphicsFootprint(JNIEnv* jniEnv, jfloatArray statisticsJFloatArray)
+    {
+        float statistics[GraphicsFootprint::STATISTICS_FLOAT_COUNT];
+        graphicsFootprint.getStatistics(statistics);
+        jniEnv->SetFloatArrayRegion(statisticsJFloatArray, 0, GraphicsFootprint::STATISTICS_FLOAT_COUNT, statistics);
+    }
+    
+    void setPerformanceGovernorEnabled(bool enabled)
+    {
+        // Post MESSAGE_SET_PERFORMANCE_GOVERNOR_ENABLED
+        ovrMessage message;
+        ovrMessage_Init(&message, MESSAGE_SET_PERFORMANCE_GOVERNOR_ENABLED, MQ_WAIT_PROCESSED);
+        ovrMessage_SetIntegerParm(&message, 0, enabled ? 1 : 0);
+        ovrMessageQueue_PostMessage(&messageQueue, &message);
+    }
+    
+    inline int getPerformanceGovernorDecisions(double values[PerformanceGovernor::DECISION_HISTORY_SIZE * PerformanceGovernor::DOUBLES_PER_DECISION]) const
+    {
+        return governor.getDecisions(values);
+    }
+    
+    // Returns false if the thread has not been configured yet (the sampler only exists while sampling).
+    bool getThreadTelemetry(Threads configuredThread, int telemetryValues[THREAD_TELEMETRY_INT_COUNT])
+    {
+        pthread_mutex_lock(&threadTelemetryMutex);
+        ovrThreadTelemetry telemetry = threadTelemetries[configuredThread];
+        pthread_mutex_unlock(&threadTelemetryMutex);
+        if (telemetry.Tid == 0)
+        {
+            return false;
+        }
+        // vrapi may have promoted the thread since it was configured
+        ovrThreadTelemetry_Refresh(&telemetry);
+        telemetryValues[0] = telemetry.Tid;
+        telemetryValues[1] = (int)telemetry.RequestedAffinityMask;
+        telemetryValues[2] = (int)telemetry.GrantedAffinityMask;
+        telemetryValues[3] = telemetry.RequestedFifoPriority;
+        telemetryValues[4] = telemetry.GrantedPolicy;
+        telemetryValues[5] = telemetry.GrantedPriority;
+        telemetryValues[6] = telemetry.GrantedNice;
+        telemetryValues[7] = telemetry.VrapiFifoRequested ? 1 : 0;
+        return true;
+    }
+};
+
+pthread_mutex_t OculusMobileSDKHeadTracking::sharedMutex = PTHREAD_MUTEX_INITIALIZER;
+OculusMobileSDKHeadTracking* OculusMobileSDKHeadTracking::shared = NULL;
+int OculusMobileSDKHeadTracking::sharedReferenceCount = 0;
+bool OculusMobileSDKHeadTracking::sharedStopping = false;
+pthread_cond_t OculusMobileSDKHeadTracking::sharedStopped = PTHREAD_COND_INITIALIZER;
+
+void OculusMobileSDKHeadTrackingConsumer::setDataListener(JNIEnv* jniEnv, jobject listenerJObject, int deliveriesPerSecond, jobjectArray dataPoolJObjectArray)
+{
+    // The delivery thread uses the references so it goes first
+    delivery.stop();
+    if (dataListenerJObject != NULL)
+    {
+        jniEnv->DeleteGlobalRef(dataListenerJObject);
+        dataListenerJObject = NULL;
+        for (int i = 0; i < DATA_POOL_SIZE; i++)
+        {
+            jniEnv->DeleteGlobalRef(dataPoolJObjects[i]);
+            dataPoolJObjects[i] = NULL;
+        }
+    }
+    if (listenerJObject == NULL || deliveriesPerSecond == 0)
+    {
+        return;
+    }
+    
+    dataListenerJObject = jniEnv->NewGlobalRef(listenerJObject);
+    jclass listenerJClass = jniEnv->GetObjectClass(listenerJObject);
+    dataListenerMethodID = jniEnv->GetMethodID(listenerJClass, "headTrackingData", "(Lcom/judax/oculusmobilesdkheadtracking/OculusMobileSDKHeadTracking;Lcom/judax/oculusmobilesdkheadtracking/OculusMobileSDKHeadTrackingData;)V");
+    jniEnv->DeleteLocalRef(listenerJClass);
+    for (int i = 0; i < DATA_POOL_SIZE; i++)
+    {
+        jobject dataPoolJObject = jniEnv->GetObjectArrayElement(dataPoolJObjectArray, i);
+        dataPoolJObjects[i] = jniEnv->NewGlobalRef(dataPoolJObject);
+        jniEnv->DeleteLocalRef(dataPoolJObject);
+    }
+    dataPoolIndex = 0;
+    
+    ovrThreadConfiguration configuration;
+    ovrThreadConfiguration_Init(&configuration, "OVRHeadDelivery");
+    // On the display refresh the rate is only what the delivery falls back to outside of VR mode
+    const bool displayRefresh = deliveriesPerSecond == DELIVERY_DISPLAY_REFRESH;
+    const int rate = displayRefresh ? session->getDisplayRefreshRate() : deliveriesPerSecond;
+    if (!delivery.start(rate, deliverStatic, this, configuration, displayRefresh ? nextDisplayRefreshStatic : NULL))
+    {
+        LOG_ERROR("Could not create the delivery thread.");
+    }
+}
+
+// Called from the delivery thread.
+void OculusMobileSDKHeadTrackingConsumer::deliver()
+{
+    JNIEnv* jniEnv = JavaThread_GetEnv(session->getJavaVM(), "OVRHeadDelivery");
+    ovrTracking tracking;
+    if (jniEnv == NULL || !session->predictTracking(tracking, false))
+    {
+        return;
+    }
+    jobject dataPoolJObject = dataPoolJObjects[dataPoolIndex];
+    dataPoolIndex = (dataPoolIndex + 1) % DATA_POOL_SIZE;
+    session->setData<OculusMobileSDKHeadTracking::DATA_FIELDS_FULL>(jniEnv, dataPoolJObject, tracking);
+    jniEnv->CallVoidMethod(dataListenerJObject, dataListenerMethodID, oculusMobileSDKHeadTrackingJObject, dataPoolJObject);
+    if (jniEnv->ExceptionCheck())
+    {
+        // Do not let a failing listener break the following deliveries
+        jniEnv->ExceptionDescribe();
+        jniEnv->ExceptionClear();
+    }
+}
+
+// Called from the delivery thread when delivering on the display refresh.
+long long OculusMobileSDKHeadTrackingConsumer::nextDisplayRefreshStatic(void* data, long long periodDeadline)
+{
+    return ((OculusMobileSDKHeadTrackingConsumer*)data)->session->getNextDisplayRefreshTime(periodDeadline);
+}
+
+// Reads a column of the poses of [startTime, endTime] from the columnar file of a recording, through the cached
+// reader so the file is not mapped again for every window or column. Returns false if the file could not be read.
+template<typename T>
+static bool ReadPoseColumnWindow(JNIEnv* jniEnv, jstring pathPrefixJString, const int column, const double startTime, const double endTime, std::vector<T>& values)
+{
+    if (pathPrefixJString == NULL)
+    {
+        return false;
+    }
+    const char* pathPrefix = jniEnv->GetStringUTFChars(pathPrefixJString, NULL);
+    char path[PoseColumnsReaderCache::PATH_SIZE];
+    snprintf(path, sizeof(path), "%s%s", pathPrefix, POSE_COLUMNS_FILE_EXTENSION);
+    jniEnv->ReleaseStringUTFChars(pathPrefixJString, pathPrefix);
+    PoseColumnsReaderCache& cache = PoseColumnsReaderCache::get();
+    const PoseColumnsReader* reader = cache.lock(path);
+    if (reader == NULL)
+    {
+        return false;
+    }
+    // The chunks of the window, and in the first and the last of them only the records in it
+    int firstChunk = 0;
+    const int chunkCount = reader->findChunks(startTime, endTime, &firstChunk);
+    bool valid = true;
+    for (int chunk = firstChunk; chunk < firstChunk + chunkCount && valid; chunk++)
+    {
+        valid = reader->isChunkValid(chunk);
+        if (valid)
+        {
+            const unsigned int begin = chunk == firstChunk ? reader->findRecord(chunk, startTime) : 0;
+            const unsigned int end = chunk == firstChunk + chunkCount - 1 ? reader->findRecord(chunk, nextafter(endTime, INFINITY)) : reader->getChunk(chunk).RecordCount;
+            const T* columnValues = reader->getColumn<T>(chunk, column);
+            values.insert(values.end(), columnValues + begin, columnValues + (end < begin ? begin : end));
+        }
+    }
+    cache.unlock();
+    return valid;
+}
+
+// Starts a private session (not the shared one), waits for its tracking thread to be ready and stops it.
+// Without a surface the session never enters VR mode, so the last phases of the timeline are -1.
+static bool BenchmarkSessionStartup(JNIEnv* jniEnv, jobject activityJObject, jobject oculusMobileSDKHeadTrackingJObject, jobject dataJObject, double timeline[OculusMobileSDKHeadTracking::STARTUP_PHASE_COUNT])
+{
+    static const int TIMEOUT_MILLISECONDS = 10000;
+    OculusMobileSDKHeadTracking* session = new OculusMobileSDKHeadTracking();
+    if (!session->start(jniEnv, activityJObject, oculusMobileSDKHeadTrackingJObject, dataJObject))
+    {
+        delete session;
+        return false;
+    }
+    for (int waited = 0; waited < TIMEOUT_MILLISECONDS; waited++)
+    {
+        session->getStartupTimeline(timeline);
+        if (timeline[OculusMobileSDKHeadTracking::STARTUP_PHASE_TRACKING_THREAD_READY] >= 0.0)
+        {
+            break;
+        }
+        usleep(1000);
+    }
+    session->stop(jniEnv);
+    delete session;
+    return true;
+}
+
+// Averages the time at which each startup phase is reached over iterations sessions.
+static void BenchmarkStartup(JNIEnv* jniEnv, jobject activityJObject, jobject oculusMobileSDKHeadTrackingJObject, jobject dataJObject, const int iterations, double results[OculusMobileSDKHeadTracking::STARTUP_PHASE_COUNT])
+{
+    double sums[OculusMobileSDKHeadTracking::STARTUP_PHASE_COUNT];
+    int counts[OculusMobileSDKHeadTracking::STARTUP_PHASE_COUNT];
+    memset(sums, 0, sizeof(sums));
+    memset(counts, 0, sizeof(counts));
+    for (int iteration = 0; iteration < iterations; iteration++)
+    {
+        double timeline[OculusMobileSDKHeadTracking::STARTUP_PHASE_COUNT];
+        if (!BenchmarkSessionStartup(jniEnv, activityJObject, oculusMobileSDKHeadTrackingJObject, dataJObject, timeline))
+        {
+            break;
+        }
+        for (int i = 0; i < OculusMobileSDKHeadTracking::STARTUP_PHASE_COUNT; i++)
+        {
+            if (timeline[i] >= 0.0)
+            {
+                sums[i] += timeline[i];
+                counts[i]++;
+            }
+        }
+    }
+    for (int i = 0; i < OculusMobileSDKHeadTracking::STARTUP_PHASE_COUNT; i++)
+    {
+        results[i] = counts[i] > 0 ? sums[i] / counts[i] : -1.0;
+    }
+    LOG_MESSAGE("Startup benchmark (%d iterations): start returned after %.2f ms, vrapi initialized after %.2f ms, EGL context created after %.2f ms, tracking thread ready after %.2f ms", iterations, results[OculusMobileSDKHeadTracking::STARTUP_PHASE_JNI_CACHED] * 1000.0, results[OculusMobileSDKHeadTracking::STARTUP_PHASE_VRAPI_INITIALIZED] * 1000.0, results[OculusMobileSDKHeadTracking::STARTUP_PHASE_EGL_CONTEXT_CREATED] * 1000.0, results[OculusMobileSDKHeadTracking::STARTUP_PHASE_TRACKING_THREAD_READY] * 1000.0);
+}
+
+// Compares a cold start (no EGL resources kept) with the restarts that follow it (which reuse them).
+static void BenchmarkRestart(JNIEnv* jniEnv, jobject activityJObject, jobject oculusMobileSDKHeadTrackingJObject, jobject dataJObject, const int iterations, double results[5])
+{
+    ovrEglResources_Trim();
+    const int reusedBefore = eglResourcesReused.load();
+    double restartReadySum = 0.0;
+    double restartEglSum = 0.0;
+    int restarts = 0;
+    for (int iteration = 0; iteration <= iterations; iteration++)
+    {
+        double timeline[OculusMobileSDKHeadTracking::STARTUP_PHASE_COUNT];
+        if (!BenchmarkSessionStartup(jniEnv, activityJObject, oculusMobileSDKHeadTrackingJObject, dataJObject, timeline))
+        {
+            break;
+        }
+        const double ready = timeline[OculusMobileSDKHeadTracking::STARTUP_PHASE_TRACKING_THREAD_READY] * 1000.0;
+        const double egl = timeline[OculusMobileSDKHeadTracking::STARTUP_PHASE_EGL_CONTEXT_CREATED] * 1000.0;
+        if (iteration == 0)
+        {
+            results[0] = ready;
+            results[2] = egl;
+        }
+        else
+        {
+            restartReadySum += ready;
+            restartEglSum += egl;
+            restarts++;
+        }
+    }
+    results[1] = restarts > 0 ? restartReadySum / restarts : -1.0;
+    results[3] = restarts > 0 ? restartEglSum / restarts : -1.0;
+    results[4] = eglResourcesReused.load() - reusedBefore;
+    LOG_MESSAGE("Restart benchmark (%d restarts): tracking thread ready after %.2f ms cold, %.2f ms on restart; EGL context ready after %.2f ms cold, %.2f ms on restart (%d reused)", restarts, results[0], results[1], results[2], results[3], (int)results[4]);
+}
+
+extern "C"
+{
+    // Activity life cycle
+    JNIEXPORT jlong JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeStart(JNIEnv* jniEnv, jobject obj, jobject activityJObject, jobject oculusMobileSDKHeadTrackingJObject, jobject dataJObject, jboolean trackingOnly)
+    {
+        // Every Java instance gets its own consumer of the shared session
+        OculusMobileSDKHeadTrackingConsumer* consumer = new OculusMobileSDKHeadTrackingConsumer(jniEnv, activityJObject, oculusMobileSDKHeadTrackingJObject, dataJObject);
+        if (OculusMobileSDKHeadTracking::acquireShared(jniEnv, activityJObject, consumer, trackingOnly) == NULL)
+        {
+            consumer->destroy(jniEnv);
+            delete consumer;
+            return 0;
+        }
+        return (jlong)((size_t)consumer);
+    }
+
+    JNIEXPORT void JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeResume(JNIEnv* jniEnv, jobject obj, jlong objectPtr)
+    {
+        OculusMobileSDKHeadTrackingConsumer* consumer = (OculusMobileSDKHeadTrackingConsumer*)((size_t)objectPtr);
+        
+        consumer->session->resume(consumer);
+    }
+    
+    JNIEXPORT void JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativePause(JNIEnv* jniEnv, jobject obj, jlong objectPtr)
+    {
+        OculusMobileSDKHeadTrackingConsumer* consumer = (OculusMobileSDKHeadTrackingConsumer*)((size_t)objectPtr);
+        
+        consumer->session->pause(consumer);
+    }
+    
+    JNIEXPORT void JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeStop(JNIEnv* jniEnv, jobject obj, jlong objectPtr)
+    {
+        OculusMobileSDKHeadTrackingConsumer* consumer = (OculusMobileSDKHeadTrackingConsumer*)((size_t)objectPtr);
+        // The delivery thread uses the session
+        consumer->setDataListener(jniEnv, NULL, 0, NULL);
+        OculusMobileSDKHeadTracking::releaseShared(jniEnv, consumer);
+        consumer->destroy(jniEnv);
+        delete consumer;
+        consumer = 0;
     }
     
     // Surface life cycle
     JNIEXPORT void JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeSurfaceCreated(JNIEnv* jniEnv, jobject obj, jlong objectPtr, jobject surfaceJObject)
     {
-        OculusMobileSDKHeadTracking* oculusMobileSDKHeadTracking = (OculusMobileSDKHeadTracking*)((size_t)objectPtr);
+        OculusMobileSDKHeadTrackingConsumer* consumer = (OculusMobileSDKHeadTrackingConsumer*)((size_t)objectPtr);
         
         ANativeWindow * newNativeWindow = ANativeWindow_fromSurface(jniEnv, surfaceJObject);
         if (ANativeWindow_getWidth(newNativeWindow) < ANativeWindow_getHeight(newNativeWindow))
@@ -949,14 +2602,22 @@ extern "C"
             LOG_ERROR("Surface not in landscape mode!");
         }
         
-        oculusMobileSDKHeadTracking->setNativeWindow(newNativeWindow);
+        consumer->callbackNativeWindow = newNativeWindow;
+        consumer->session->setNativeWindow(consumer, newNativeWindow);
     }
     
     JNIEXPORT void JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeSurfaceChanged(JNIEnv* jniEnv, jobject obj, jlong objectPtr, jobject surfaceJObject)
     {
-        OculusMobileSDKHeadTracking* oculusMobileSDKHeadTracking = (OculusMobileSDKHeadTracking*)((size_t)objectPtr);
+        OculusMobileSDKHeadTrackingConsumer* consumer = (OculusMobileSDKHeadTrackingConsumer*)((size_t)objectPtr);
 
         ANativeWindow* newNativeWindow = ANativeWindow_fromSurface(jniEnv, surfaceJObject);
+        if (newNativeWindow == consumer->callbackNativeWindow)
+        {
+            // Only the size or the format changed: the EGL window surface follows the window buffers so
+            // there is nothing for the session to do
+            ANativeWindow_release(newNativeWindow);
+            return;
+        }
         if (ANativeWindow_getWidth(newNativeWindow) < ANativeWindow_getHeight(newNativeWindow))
         {
             // An app that is relaunched after pressing the home button gets an initial surface with
@@ -966,21 +2627,511 @@ extern "C"
             LOG_ERROR("Surface not in landscape mode!");
         }
         
-        oculusMobileSDKHeadTracking->setNativeWindow(newNativeWindow);
+        consumer->callbackNativeWindow = newNativeWindow;
+        consumer->session->setNativeWindow(consumer, newNativeWindow);
     }
     
     JNIEXPORT void JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeSurfaceDestroyed(JNIEnv* jniEnv, jobject obj, jlong objectPtr)
     {
-        OculusMobileSDKHeadTracking* oculusMobileSDKHeadTracking = (OculusMobileSDKHeadTracking*)((size_t)objectPtr);
+        OculusMobileSDKHeadTrackingConsumer* consumer = (OculusMobileSDKHeadTrackingConsumer*)((size_t)objectPtr);
         
-        oculusMobileSDKHeadTracking->setNativeWindow(NULL);
+        consumer->callbackNativeWindow = NULL;
+        consumer->session->setNativeWindow(consumer, NULL);
     }
     
     JNIEXPORT void JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeGetData(JNIEnv* jniEnv, jobject obj, jlong objectPtr)
     {
-        OculusMobileSDKHeadTracking* oculusMobileSDKHeadTracking = (OculusMobileSDKHeadTracking*)((size_t)objectPtr);
+        OculusMobileSDKHeadTrackingConsumer* consumer = (OculusMobileSDKHeadTrackingConsumer*)((size_t)objectPtr);
+        
+        consumer->session->getData<OculusMobileSDKHeadTracking::DATA_FIELDS_FULL>(jniEnv, consumer->dataJObject);
+    }
+    
+    JNIEXPORT void JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeGetOrientationData(JNIEnv* jniEnv, jobject obj, jlong objectPtr)
+    {
+        OculusMobileSDKHeadTrackingConsumer* consumer = (OculusMobileSDKHeadTrackingConsumer*)((size_t)objectPtr);
+        
+        consumer->session->getData<OculusMobileSDKHeadTracking::DATA_FIELDS_ORIENTATION>(jniEnv, consumer->dataJObject);
+    }
+    
+    JNIEXPORT void JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeGetOrientationAndVelocityData(JNIEnv* jniEnv, jobject obj, jlong objectPtr)
+    {
+        OculusMobileSDKHeadTrackingConsumer* consumer = (OculusMobileSDKHeadTrackingConsumer*)((size_t)objectPtr);
         
-        oculusMobileSDKHeadTracking->getData(jniEnv);
+        consumer->session->getData<OculusMobileSDKHeadTracking::DATA_FIELDS_ORIENTATION_AND_VELOCITY>(jniEnv, consumer->dataJObject);
     }
     
+    // Prediction accuracy
+    JNIEXPORT void JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeSetPredictionAccuracyEnabled(JNIEnv* jniEnv, jobject obj, jlong objectPtr, jboolean enabled)
+    {
+        OculusMobileSDKHeadTracking* oculusMobileSDKHeadTracking = ((OculusMobileSDKHeadTrackingConsumer*)((size_t)objectPtr))->session;
+        
+        oculusMobileSDKHeadTracking->setPredictionAccuracyEnabled(enabled);
+    }
+    
+    JNIEXPORT jint JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeGetPredictionAccuracyBucketCount(JNIEnv* jniEnv, jobject obj)
+    {
+        return PredictionAccuracy::HORIZON_BUCKET_COUNT;
+    }
+    
+    JNIEXPORT void JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeGetPredictionAccuracy(JNIEnv* jniEnv, jobject obj, jlong objectPtr, jfloatArray statisticsJFloatArray)
+    {
+        OculusMobileSDKHeadTracking* oculusMobileSDKHeadTracking = ((OculusMobileSDKHeadTrackingConsumer*)((size_t)objectPtr))->session;
+        
+        oculusMobileSDKHeadTracking->getPredictionAccuracy(jniEnv, statisticsJFloatArray);
+    }
+    
+    // Sampling
+    JNIEXPORT void JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeSetSamplingRate(JNIEnv* jniEnv, jobject obj, jlong objectPtr, jint samplesPerSecond)
+    {
+        OculusMobileSDKHeadTrackingConsumer* consumer = (OculusMobileSDKHeadTrackingConsumer*)((size_t)objectPtr);
+        
+        consumer->session->setSamplingRate(consumer, samplesPerSecond);
+    }
+    
+    JNIEXPORT void JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeSetSampledPredictionEnabled(JNIEnv* jniEnv, jobject obj, jlong objectPtr, jboolean enabled)
+    {
+        OculusMobileSDKHeadTracking* oculusMobileSDKHeadTracking = ((OculusMobileSDKHeadTrackingConsumer*)((size_t)objectPtr))->session;
+        
+        oculusMobileSDKHeadTracking->setSampledPredictionEnabled(enabled);
+    }
+    
+    JNIEXPORT void JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeGetSamplingStatistics(JNIEnv* jniEnv, jobject obj, jlong objectPtr, jfloatArray statisticsJFloatArray)
+    {
+        OculusMobileSDKHeadTracking* oculusMobileSDKHeadTracking = ((OculusMobileSDKHeadTrackingConsumer*)((size_t)objectPtr))->session;
+        
+        oculusMobileSDKHeadTracking->getSamplingStatistics(jniEnv, statisticsJFloatArray);
+    }
+    
+    // Startup
+    JNIEXPORT void JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeGetStartupTimeline(JNIEnv* jniEnv, jobject obj, jlong objectPtr, jdoubleArray timelineJDoubleArray)
+    {
+        OculusMobileSDKHeadTracking* oculusMobileSDKHeadTracking = ((OculusMobileSDKHeadTrackingConsumer*)((size_t)objectPtr))->session;
+        
+        double timeline[OculusMobileSDKHeadTracking::STARTUP_PHASE_COUNT];
+        oculusMobileSDKHeadTracking->getStartupTimeline(timeline);
+        jniEnv->SetDoubleArrayRegion(timelineJDoubleArray, 0, OculusMobileSDKHeadTracking::STARTUP_PHASE_COUNT, timeline);
+    }
+    
+    JNIEXPORT void JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTrackingBenchmarks_nativeBenchmarkRestart(JNIEnv* jniEnv, jclass clazz, jobject activityJObject, jobject oculusMobileSDKHeadTrackingJObject, jobject dataJObject, jint iterations, jdoubleArray resultsJDoubleArray)
+    {
+        double results[5] = { -1.0, -1.0, -1.0, -1.0, 0.0 };
+        if (iterations > 0)
+        {
+            BenchmarkRestart(jniEnv, activityJObject, oculusMobileSDKHeadTrackingJObject, dataJObject, iterations, results);
+        }
+        jniEnv->SetDoubleArrayRegion(resultsJDoubleArray, 0, 5, results);
+    }
+    
+    JNIEXPORT void JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTrackingBenchmarks_nativeBenchmarkStartup(JNIEnv* jniEnv, jclass clazz, jobject activityJObject, jobject oculusMobileSDKHeadTrackingJObject, jobject dataJObject, jint iterations, jdoubleArray resultsJDoubleArray)
+    {
+        double results[OculusMobileSDKHeadTracking::STARTUP_PHASE_COUNT];
+        for (int i = 0; i < OculusMobileSDKHeadTracking::STARTUP_PHASE_COUNT; i++)
+        {
+            results[i] = -1.0;
+        }
+        if (iterations > 0)
+        {
+            BenchmarkStartup(jniEnv, activityJObject, oculusMobileSDKHeadTrackingJObject, dataJObject, iterations, results);
+        }
+        jniEnv->SetDoubleArrayRegion(resultsJDoubleArray, 0, OculusMobileSDKHeadTracking::STARTUP_PHASE_COUNT, results);
+    }
+    
+    // EGL config cache
+    JNIEXPORT void JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeSetEglConfigCacheFile(JNIEnv* jniEnv, jclass clazz, jstring pathJString)
+    {
+        if (pathJString == NULL)
+        {
+            ovrEglConfigCache_SetFile(NULL);
+            return;
+        }
+        const char* path = jniEnv->GetStringUTFChars(pathJString, NULL);
+        ovrEglConfigCache_SetFile(path);
+        jniEnv->ReleaseStringUTFChars(pathJString, path);
+    }
+    
+    JNIEXPORT void JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeGetEglConfigCacheStatistics(JNIEnv* jniEnv, jclass clazz, jfloatArray statisticsJFloatArray)
+    {
+        float statistics[EGL_CONFIG_CACHE_STATISTICS_FLOAT_COUNT];
+        ovrEglConfigCache_GetStatistics(statistics);
+        jniEnv->SetFloatArrayRegion(statisticsJFloatArray, 0, EGL_CONFIG_CACHE_STATISTICS_FLOAT_COUNT, statistics);
+    }
+    
+    // Pose codec
+    JNIEXPORT jlong JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeCompressPoseRecording(JNIEnv* jniEnv, jclass clazz, jstring pathPrefixJString, jfloat orientationError, jfloat positionError, jfloat velocityError, jfloat accelerationError, jint keyframeInterval)
+    {
+        if (pathPrefixJString == NULL)
+        {
+            return 0;
+        }
+        ovrPoseCodecParms parms = ovrPoseCodec_DefaultParms();
+        parms.OrientationError = orientationError;
+        parms.PositionError = positionError;
+        parms.AngularVelocityError = velocityError;
+        parms.LinearVelocityError = velocityError;
+        parms.AngularAccelerationError = accelerationError;
+        parms.LinearAccelerationError = accelerationError;
+        parms.KeyframeInterval = keyframeInterval;
+        const char* pathPrefix = jniEnv->GetStringUTFChars(pathPrefixJString, NULL);
+        std::vector<ovrPoseRecord> records;
+        size_t size = 0;
+        if (ovrPoseRecording_Load(pathPrefix, records) > 0 && !records.empty())
+        {
+            char path[PoseRecorder::PATH_PREFIX_SIZE + 32];
+            snprintf(path, sizeof(path), "%s%s", pathPrefix, POSE_CODEC_FILE_EXTENSION);
+            size = ovrPoseCodec_WriteFile(path, &parms, &records[0], (int)records.size());
+        }
+        jniEnv->ReleaseStringUTFChars(pathPrefixJString, pathPrefix);
+        return (jlong)size;
+    }
+    
+    // Pose columns
+    JNIEXPORT jlong JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeConvertPoseRecordingToColumns(JNIEnv* jniEnv, jclass clazz, jstring pathPrefixJString, jint chunkCapacity)
+    {
+        if (pathPrefixJString == NULL)
+        {
+            return 0;
+        }
+        const char* pathPrefix = jniEnv->GetStringUTFChars(pathPrefixJString, NULL);
+        std::vector<ovrPoseRecord> records;
+        size_t size = 0;
+        if (ovrPoseRecording_Load(pathPrefix, records) > 0 && !records.empty())
+        {
+            char path[PoseRecorder::PATH_PREFIX_SIZE + 32];
+            snprintf(path, sizeof(path), "%s%s", pathPrefix, POSE_COLUMNS_FILE_EXTENSION);
+            PoseColumnsReaderCache::get().invalidate(path);
+            size = ovrPoseColumns_WriteFile(path, &records[0], (int)records.size(), chunkCapacity);
+        }
+        jniEnv->ReleaseStringUTFChars(pathPrefixJString, pathPrefix);
+        return (jlong)size;
+    }
+    
+    JNIEXPORT jfloatArray JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeReadPoseColumn(JNIEnv* jniEnv, jclass clazz, jstring pathPrefixJString, jint column, jdouble startTime, jdouble endTime)
+    {
+        std::vector<float> values;
+        if (column < POSE_COLUMN_ORIENTATION_X || column > POSE_COLUMN_LINEAR_ACCELERATION_Z || !ReadPoseColumnWindow(jniEnv, pathPrefixJString, column, startTime, endTime, values))
+        {
+            return NULL;
+        }
+        jfloatArray valuesJFloatArray = jniEnv->NewFloatArray((jsize)values.size());
+        if (!values.empty())
+        {
+            jniEnv->SetFloatArrayRegion(valuesJFloatArray, 0, (jsize)values.size(), &values[0]);
+        }
+        return valuesJFloatArray;
+    }
+    
+    JNIEXPORT jdoubleArray JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeReadPoseDoubleColumn(JNIEnv* jniEnv, jclass clazz, jstring pathPrefixJString, jint column, jdouble startTime, jdouble endTime)
+    {
+        std::vector<double> values;
+        if ((column != POSE_COLUMN_POSE_TIME && column != POSE_COLUMN_PREDICTION) || !ReadPoseColumnWindow(jniEnv, pathPrefixJString, column, startTime, endTime, values))
+        {
+            return NULL;
+        }
+        jdoubleArray valuesJDoubleArray = jniEnv->NewDoubleArray((jsize)values.size());
+        if (!values.empty())
+        {
+            jniEnv->SetDoubleArrayRegion(valuesJDoubleArray, 0, (jsize)values.size(), &values[0]);
+        }
+        return valuesJDoubleArray;
+    }
+    
+    // Process lifetime EGL resources
+    JNIEXPORT jboolean JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeReleaseEglResources(JNIEnv* jniEnv, jclass clazz)
+    {
+        return ovrEglResources_Trim();
+    }
+    
+    // Lifecycle profiler
+    JNIEXPORT jdoubleArray JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeGetLifecycleProfile(JNIEnv* jniEnv, jclass clazz)
+    {
+        double values[LifecycleProfiler::LIFECYCLE_HISTORY_SIZE * LifecycleProfiler::PHASE_COUNT * LifecycleProfiler::DOUBLES_PER_PHASE];
+        const int count = LifecycleProfiler::get().getLifecycles(values);
+        const int valueCount = count * LifecycleProfiler::PHASE_COUNT * LifecycleProfiler::DOUBLES_PER_PHASE;
+        jdoubleArray valuesJDoubleArray = jniEnv->NewDoubleArray(valueCount);
+        jniEnv->SetDoubleArrayRegion(valuesJDoubleArray, 0, valueCount, values);
+        return valuesJDoubleArray;
+    }
+    
+    // Worker pool
+    JNIEXPORT void JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeGetWorkerPoolStatistics(JNIEnv* jniEnv, jobject obj, jlong objectPtr, jfloatArray statisticsJFloatArray)
+    {
+        OculusMobileSDKHeadTracking* oculusMobileSDKHeadTracking = ((OculusMobileSDKHeadTrackingConsumer*)((size_t)objectPtr))->session;
+        
+        oculusMobileSDKHeadTracking->getWorkerPoolStatistics(jniEnv, statisticsJFloatArray);
+    }
+    
+    // Prediction horizon
+    JNIEXPORT void JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeSetAdaptivePredictionHorizonEnabled(JNIEnv* jniEnv, jobject obj, jlong objectPtr, jboolean enabled)
+    {
+        OculusMobileSDKHeadTracking* oculusMobileSDKHeadTracking = ((OculusMobileSDKHeadTrackingConsumer*)((size_t)objectPtr))->session;
+        
+        oculusMobileSDKHeadTracking->setAdaptiveHorizonEnabled(enabled);
+    }
+    
+    JNIEXPORT void JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeFrameSubmitted(JNIEnv* jniEnv, jobject obj, jlong objectPtr)
+    {
+        OculusMobileSDKHeadTracking* oculusMobileSDKHeadTracking = ((OculusMobileSDKHeadTrackingConsumer*)((size_t)objectPtr))->session;
+        
+        oculusMobileSDKHeadTracking->frameSubmitted();
+    }
+    
+    JNIEXPORT void JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeGetPredictionHorizon(JNIEnv* jniEnv, jobject obj, jlong objectPtr, jfloatArray statisticsJFloatArray)
+    {
+        OculusMobileSDKHeadTracking* oculusMobileSDKHeadTracking = ((OculusMobileSDKHeadTrackingConsumer*)((size_t)objectPtr))->session;
+        
+        float statistics[5];
+        oculusMobileSDKHeadTracking->getPredictionHorizon(statistics);
+        jniEnv->SetFloatArrayRegion(statisticsJFloatArray, 0, 5, statistics);
+    }
+    
+    // Push delivery
+    JNIEXPORT void JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeSetDataListener(JNIEnv* jniEnv, jobject obj, jlong objectPtr, jobject listenerJObject, jint deliveriesPerSecond, jobjectArray dataPoolJObjectArray)
+    {
+        OculusMobileSDKHeadTrackingConsumer* consumer = (OculusMobileSDKHeadTrackingConsumer*)((size_t)objectPtr);
+        
+        consumer->setDataListener(jniEnv, listenerJObject, deliveriesPerSecond, dataPoolJObjectArray);
+    }
+    
+    JNIEXPORT jint JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeGetDataPoolSize(JNIEnv* jniEnv, jclass clazz)
+    {
+        return OculusMobileSDKHeadTrackingConsumer::DATA_POOL_SIZE;
+    }
+    
+    // Sample history
+    JNIEXPORT jint JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeReadSamples(JNIEnv* jniEnv, jobject obj, jlong objectPtr, jdoubleArray samplesJDoubleArray)
+    {
+        OculusMobileSDKHeadTrackingConsumer* consumer = (OculusMobileSDKHeadTrackingConsumer*)((size_t)objectPtr);
+        
+        const int maxSamples = jniEnv->GetArrayLength(samplesJDoubleArray) / OculusMobileSDKHeadTracking::SAMPLE_DOUBLE_COUNT;
+        std::vector<double> samples(maxSamples * OculusMobileSDKHeadTracking::SAMPLE_DOUBLE_COUNT + 1);
+        const int count = consumer->session->readSamples(consumer, &samples[0], maxSamples);
+        jniEnv->SetDoubleArrayRegion(samplesJDoubleArray, 0, count * OculusMobileSDKHeadTracking::SAMPLE_DOUBLE_COUNT, &samples[0]);
+        return count;
+    }
+    
+    // Late latching
+    JNIEXPORT jdouble JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeGetTimeInSeconds(JNIEnv* jniEnv, jclass clazz)
+    {
+        return vrapi_GetTimeInSeconds();
+    }
+    
+    JNIEXPORT jboolean JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeGetLateLatchedPose(JNIEnv* jniEnv, jobject obj, jlong objectPtr, jdouble targetTime, jfloatArray poseJFloatArray)
+    {
+        OculusMobileSDKHeadTracking* oculusMobileSDKHeadTracking = ((OculusMobileSDKHeadTrackingConsumer*)((size_t)objectPtr))->session;
+        
+        ovrPosef pose;
+        if (!oculusMobileSDKHeadTracking->getLateLatchedPose(targetTime, &pose, NULL))
+        {
+            return JNI_FALSE;
+        }
+        const float values[7] = { pose.Orientation.x, pose.Orientation.y, pose.Orientation.z, pose.Orientation.w, pose.Position.x, pose.Position.y, pose.Position.z };
+        jniEnv->SetFloatArrayRegion(poseJFloatArray, 0, 7, values);
+        return JNI_TRUE;
+    }
+    
+    JNIEXPORT jboolean JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeGetLateLatchedDeltaRotation(JNIEnv* jniEnv, jobject obj, jlong objectPtr, jdouble targetTime, jfloatArray rotationJFloatArray)
+    {
+        OculusMobileSDKHeadTracking* oculusMobileSDKHeadTracking = ((OculusMobileSDKHeadTrackingConsumer*)((size_t)objectPtr))->session;
+        
+        ovrQuatf deltaRotation;
+        if (!oculusMobileSDKHeadTracking->getLateLatchedPose(targetTime, NULL, &deltaRotation))
+        {
+            return JNI_FALSE;
+        }
+        const float values[4] = { deltaRotation.x, deltaRotation.y, deltaRotation.z, deltaRotation.w };
+        jniEnv->SetFloatArrayRegion(rotationJFloatArray, 0, 4, values);
+        return JNI_TRUE;
+    }
+    
+    // Thread configuration
+    JNIEXPORT void JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeSetThreadConfiguration(JNIEnv* jniEnv, jobject obj, jlong objectPtr, jint thread, jint affinityMask, jint fifoPriority)
+    {
+        OculusMobileSDKHeadTracking* oculusMobileSDKHeadTracking = ((OculusMobileSDKHeadTrackingConsumer*)((size_t)objectPtr))->session;
+        
+        oculusMobileSDKHeadTracking->setThreadConfiguration((OculusMobileSDKHeadTracking::Threads)thread, (unsigned int)affinityMask, fifoPriority);
+    }
+    
+    JNIEXPORT jboolean JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeGetThreadTelemetry(JNIEnv* jniEnv, jobject obj, jlong objectPtr, jint thread, jintArray telemetryJIntArray)
+    {
+        OculusMobileSDKHeadTracking* oculusMobileSDKHeadTracking = ((OculusMobileSDKHeadTrackingConsumer*)((size_t)objectPtr))->session;
+        
+        int telemetry[OculusMobileSDKHeadTracking::THREAD_TELEMETRY_INT_COUNT];
+        if (!oculusMobileSDKHeadTracking->getThreadTelemetry((OculusMobileSDKHeadTracking::Threads)thread, telemetry))
+        {
+            return JNI_FALSE;
+        }
+        jniEnv->SetIntArrayRegion(telemetryJIntArray, 0, OculusMobileSDKHeadTracking::THREAD_TELEMETRY_INT_COUNT, telemetry);
+        return JNI_TRUE;
+    }
+    
+    JNIEXPORT jint JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeGetBigCoresAffinityMask(JNIEnv* jniEnv, jclass clazz)
+    {
+        return (jint)ovrThreadConfiguration_GetBigCoresMask();
+    }
+    
+    // Warm resume
+    JNIEXPORT void JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeSetWarmResumeGracePeriod(JNIEnv* jniEnv, jobject obj, jlong objectPtr, jfloat seconds)
+    {
+        OculusMobileSDKHeadTracking* oculusMobileSDKHeadTracking = ((OculusMobileSDKHeadTrackingConsumer*)((size_t)objectPtr))->session;
+        
+        oculusMobileSDKHeadTracking->setWarmResumeGracePeriod(seconds);
+    }
+    
+    JNIEXPORT void JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeGetResumeStatistics(JNIEnv* jniEnv, jobject obj, jlong objectPtr, jfloatArray statisticsJFloatArray)
+    {
+        OculusMobileSDKHeadTracking* oculusMobileSDKHeadTracking = ((OculusMobileSDKHeadTrackingConsumer*)((size_t)objectPtr))->session;
+        
+        oculusMobileSDKHeadTracking->getResumeStatistics(jniEnv, statisticsJFloatArray);
+    }
+    
+    // VR mode state
+    JNIEXPORT jint JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeGetVrModeState(JNIEnv* jniEnv, jobject obj, jlong objectPtr)
+    {
+        OculusMobileSDKHeadTracking* oculusMobileSDKHeadTracking = ((OculusMobileSDKHeadTrackingConsumer*)((size_t)objectPtr))->session;
+        
+        return oculusMobileSDKHeadTracking->getVrModeState();
+    }
+    
+    JNIEXPORT void JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeGetVrModeTransitions(JNIEnv* jniEnv, jobject obj, jlong objectPtr, jfloatArray statisticsJFloatArray)
+    {
+        OculusMobileSDKHeadTracking* oculusMobileSDKHeadTracking = ((OculusMobileSDKHeadTrackingConsumer*)((size_t)objectPtr))->session;
+        
+        oculusMobileSDKHeadTracking->getVrModeTransitions(jniEnv, statisticsJFloatArray);
+    }
+    
+    // Graphics footprint
+    JNIEXPORT void JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeGetGraphicsFootprint(JNIEnv* jniEnv, jobject obj, jlong objectPtr, jfloatArray statisticsJFloatArray)
+    {
+        OculusMobileSDKHeadTracking* oculusMobileSDKHeadTracking = ((OculusMobileSDKHeadTrackingConsumer*)((size_t)objectPtr))->session;
+        
+        oculusMobileSDKHeadTracking->getGraphicsFootprint(jniEnv, statisticsJFloatArray);
+    }
+    
+    // Performance governor
+    JNIEXPORT void JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeSetPerformanceGovernorEnabled(JNIEnv* jniEnv, jobject obj, jlong objectPtr, jboolean enabled)
+    {
+        OculusMobileSDKHeadTracking* oculusMobileSDKHeadTracking = ((OculusMobileSDKHeadTrackingConsumer*)((size_t)objectPtr))->session;
+        
+        oculusMobileSDKHeadTracking->setPerformanceGovernorEnabled(enabled);
+    }
+    
+    JNIEXPORT jdoubleArray JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeGetPerformanceGovernorDecisions(JNIEnv* jniEnv, jobject obj, jlong objectPtr)
+    {
+        OculusMobileSDKHeadTracking* oculusMobileSDKHeadTracking = ((OculusMobileSDKHeadTrackingConsumer*)((size_t)objectPtr))->session;
+        
+        double values[PerformanceGovernor::DECISION_HISTORY_SIZE * PerformanceGovernor::DOUBLES_PER_DECISION];
+        const int count = oculusMobileSDKHeadTracking->getPerformanceGovernorDecisions(values);
+        jdoubleArray valuesJDoubleArray = jniEnv->NewDoubleArray(count * PerformanceGovernor::DOUBLES_PER_DECISION);
+        jniEnv->SetDoubleArrayRegion(valuesJDoubleArray, 0, count * PerformanceGovernor::DOUBLES_PER_DECISION, values);
+        return valuesJDoubleArray;
+    }
+    
+    // Pose recording
+    JNIEXPORT jboolean JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeStartPoseRecording(JNIEnv* jniEnv, jobject obj, jlong objectPtr, jstring pathPrefixJString, jint fileSize, jint maxFiles)
+    {
+        OculusMobileSDKHeadTracking* oculusMobileSDKHeadTracking = ((OculusMobileSDKHeadTrackingConsumer*)((size_t)objectPtr))->session;
+        
+        if (pathPrefixJString == NULL)
+        {
+            return JNI_FALSE;
+        }
+        const char* pathPrefix = jniEnv->GetStringUTFChars(pathPrefixJString, NULL);
+        const bool recordingStarted = oculusMobileSDKHeadTracking->startPoseRecording(pathPrefix, fileSize, maxFiles);
+        jniEnv->ReleaseStringUTFChars(pathPrefixJString, pathPrefix);
+        return recordingStarted ? JNI_TRUE : JNI_FALSE;
+    }
+    
+    JNIEXPORT void JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeStopPoseRecording(JNIEnv* jniEnv, jobject obj, jlong objectPtr)
+    {
+        OculusMobileSDKHeadTracking* oculusMobileSDKHeadTracking = ((OculusMobileSDKHeadTrackingConsumer*)((size_t)objectPtr))->session;
+        
+        oculusMobileSDKHeadTracking->stopPoseRecording();
+    }
+    
+    JNIEXPORT void JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeGetPoseRecorderStatistics(JNIEnv* jniEnv, jobject obj, jlong objectPtr, jfloatArray statisticsJFloatArray)
+    {
+        OculusMobileSDKHeadTracking* oculusMobileSDKHeadTracking = ((OculusMobileSDKHeadTrackingConsumer*)((size_t)objectPtr))->session;
+        
+        oculusMobileSDKHeadTracking->getPoseRecorderStatistics(jniEnv, statisticsJFloatArray);
+    }
+    
+    // Flight recorder
+    JNIEXPORT void JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeSetFlightRecorderDumpPath(JNIEnv* jniEnv, jobject obj, jlong objectPtr, jstring pathPrefixJString)
+    {
+        OculusMobileSDKHeadTracking* oculusMobileSDKHeadTracking = ((OculusMobileSDKHeadTrackingConsumer*)((size_t)objectPtr))->session;
+        
+        if (pathPrefixJString == NULL)
+        {
+            oculusMobileSDKHeadTracking->setFlightRecorderDumpPath(NULL);
+            return;
+        }
+        const char* pathPrefix = jniEnv->GetStringUTFChars(pathPrefixJString, NULL);
+        oculusMobileSDKHeadTracking->setFlightRecorderDumpPath(pathPrefix);
+        jniEnv->ReleaseStringUTFChars(pathPrefixJString, pathPrefix);
+    }
+    
+    JNIEXPORT jboolean JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeDumpFlightRecorder(JNIEnv* jniEnv, jobject obj, jlong objectPtr, jstring pathJString)
+    {
+        OculusMobileSDKHeadTracking* oculusMobileSDKHeadTracking = ((OculusMobileSDKHeadTrackingConsumer*)((size_t)objectPtr))->session;
+        
+        if (pathJString == NULL)
+        {
+            return JNI_FALSE;
+        }
+        const char* path = jniEnv->GetStringUTFChars(pathJString, NULL);
+        const bool dumped = oculusMobileSDKHeadTracking->dumpFlightRecorder(path);
+        jniEnv->ReleaseStringUTFChars(pathJString, path);
+        return dumped ? JNI_TRUE : JNI_FALSE;
+    }
+    
+    JNIEXPORT void JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeGetFlightRecorderStatistics(JNIEnv* jniEnv, jobject obj, jlong objectPtr, jfloatArray statisticsJFloatArray)
+    {
+        OculusMobileSDKHeadTracking* oculusMobileSDKHeadTracking = ((OculusMobileSDKHeadTrackingConsumer*)((size_t)objectPtr))->session;
+        
+        oculusMobileSDKHeadTracking->getFlightRecorderStatistics(jniEnv, statisticsJFloatArray);
+    }
+    
+    // Pose replay
+    JNIEXPORT jboolean JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeLoadPoseReplay(JNIEnv* jniEnv, jobject obj, jlong objectPtr, jstring pathPrefixJString)
+    {
+        OculusMobileSDKHeadTracking* oculusMobileSDKHeadTracking = ((OculusMobileSDKHeadTrackingConsumer*)((size_t)objectPtr))->session;
+        
+        if (pathPrefixJString == NULL)
+        {
+            oculusMobileSDKHeadTracking->loadPoseReplay(NULL);
+            return JNI_FALSE;
+        }
+        const char* pathPrefix = jniEnv->GetStringUTFChars(pathPrefixJString, NULL);
+        const bool loaded = oculusMobileSDKHeadTracking->loadPoseReplay(pathPrefix);
+        jniEnv->ReleaseStringUTFChars(pathPrefixJString, pathPrefix);
+        return loaded ? JNI_TRUE : JNI_FALSE;
+    }
+    
+    JNIEXPORT void JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativePlayPoseReplay(JNIEnv* jniEnv, jobject obj, jlong objectPtr, jfloat speed, jboolean loop)
+    {
+        OculusMobileSDKHeadTracking* oculusMobileSDKHeadTracking = ((OculusMobileSDKHeadTrackingConsumer*)((size_t)objectPtr))->session;
+        
+        oculusMobileSDKHeadTracking->playPoseReplay(speed, loop);
+    }
+    
+    JNIEXPORT void JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativePausePoseReplay(JNIEnv* jniEnv, jobject obj, jlong objectPtr)
+    {
+        OculusMobileSDKHeadTracking* oculusMobileSDKHeadTracking = ((OculusMobileSDKHeadTrackingConsumer*)((size_t)objectPtr))->session;
+        
+        oculusMobileSDKHeadTracking->pausePoseReplay();
+    }
+    
+    JNIEXPORT void JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeSeekPoseReplay(JNIEnv* jniEnv, jobject obj, jlong objectPtr, jdouble seconds)
+    {
+        OculusMobileSDKHeadTracking* oculusMobileSDKHeadTracking = ((OculusMobileSDKHeadTrackingConsumer*)((size_t)objectPtr))->session;
+        
+        oculusMobileSDKHeadTracking->seekPoseReplay(seconds);
+    }
+    
+    JNIEXPORT void JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTracking_nativeGetPoseReplayStatistics(JNIEnv* jniEnv, jobject obj, jlong objectPtr, jfloatArray statisticsJFloatArray)
+    {
+        OculusMobileSDKHeadTracking* oculusMobileSDKHeadTracking = ((OculusMobileSDKHeadTrackingConsumer*)((size_t)objectPtr))->session;
+        
+        oculusMobileSDKHeadTracking->getPoseReplayStatistics(jniEnv, statisticsJFloatArray);
+    }
 }
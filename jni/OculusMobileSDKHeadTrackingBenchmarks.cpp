@@ -0,0 +1,642 @@
+#include <stdlib.h> // for rand
+#include <math.h>
+#include <stdio.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+
+#include <pthread.h>
+#include <sched.h> // for sched_yield
+
+#include <atomic>
+#include <vector>
+
+// vrapi and the Android NDK
+#include "Backend.h"
+
+#include "Clock.h"
+#include "HeadModelBatch.h"
+#include "GuardedPointer.h"
+#include "WorkerPool.h"
+#include "PoseRecorder.h"
+#include "PoseCodec.h"
+#include "PoseColumns.h"
+#include "FlightRecorder.h"
+#include "PoseMath.h"
+
+#define LOG_TAG "OculusMobileSDKHeadTracking"
+#define LOG_MESSAGE(...) __android_log_print( ANDROID_LOG_VERBOSE, LOG_TAG, __VA_ARGS__ )
+
+// ================================================================================================
+// Micro benchmarks of the native building blocks. They do not need VR mode (nor even a started
+// OculusMobileSDKHeadTracking) so they can be run from any thread at any time.
+// ================================================================================================
+static float RandomFloat(float min, float max)
+{
+    return min + (max - min) * ((float)rand() / (float)RAND_MAX);
+}
+
+static ovrQuatf RandomOrientation()
+{
+    ovrQuatf q;
+    q.x = RandomFloat(-1.0f, 1.0f);
+    q.y = RandomFloat(-1.0f, 1.0f);
+    q.z = RandomFloat(-1.0f, 1.0f);
+    q.w = RandomFloat(-1.0f, 1.0f);
+    const float length = sqrtf(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+    q.x /= length;
+    q.y /= length;
+    q.z /= length;
+    q.w /= length;
+    return q;
+}
+
+// Returns { batched samples per second, vrapi_ApplyHeadModel samples per second, max position difference }
+static void BenchmarkHeadModel(const int sampleCount, const int iterations, double results[3])
+{
+    const ovrHeadModelParms headModelParms = vrapi_DefaultHeadModelParms();
+    std::vector<ovrTracking> trackings(sampleCount);
+    std::vector<unsigned int> status(sampleCount);
+    std::vector<float> orientations[4];
+    std::vector<float> positions[3];
+    for (int j = 0; j < 4; j++)
+    {
+        orientations[j].resize(sampleCount);
+    }
+    for (int j = 0; j < 3; j++)
+    {
+        positions[j].resize(sampleCount);
+    }
+    for (int i = 0; i < sampleCount; i++)
+    {
+        memset(&trackings[i], 0, sizeof(ovrTracking));
+        // Some samples with positional tracking to exercise both paths.
+        trackings[i].Status = VRAPI_TRACKING_STATUS_ORIENTATION_TRACKED | ((i % 8) == 0 ? VRAPI_TRACKING_STATUS_POSITION_TRACKED : 0);
+        trackings[i].HeadPose.Pose.Orientation = RandomOrientation();
+        status[i] = trackings[i].Status;
+        orientations[0][i] = trackings[i].HeadPose.Pose.Orientation.x;
+        orientations[1][i] = trackings[i].HeadPose.Pose.Orientation.y;
+        orientations[2][i] = trackings[i].HeadPose.Pose.Orientation.z;
+        orientations[3][i] = trackings[i].HeadPose.Pose.Orientation.w;
+    }
+    ovrHeadModelBatch batch;
+    batch.count = sampleCount;
+    batch.status = &status[0];
+    batch.orientationX = &orientations[0][0];
+    batch.orientationY = &orientations[1][0];
+    batch.orientationZ = &orientations[2][0];
+    batch.orientationW = &orientations[3][0];
+    batch.positionX = &positions[0][0];
+    batch.positionY = &positions[1][0];
+    batch.positionZ = &positions[2][0];
+
+    long long start = GetTimeInNanoseconds();
+    for (int iteration = 0; iteration < iterations; iteration++)
+    {
+        ovrHeadModelBatch_Apply(&headModelParms, &batch);
+    }
+    const long long batchedNanoseconds = GetTimeInNanoseconds() - start;
+
+    std::vector<ovrTracking> referenceTrackings(sampleCount);
+    start = GetTimeInNanoseconds();
+    for (int iteration = 0; iteration < iterations; iteration++)
+    {
+        for (int i = 0; i < sampleCount; i++)
+        {
+            referenceTrackings[i] = vrapi_ApplyHeadModel(&headModelParms, &trackings[i]);
+        }
+    }
+    const long long scalarNanoseconds = GetTimeInNanoseconds() - start;
+
+    float maxDifference = 0.0f;
+    for (int i = 0; i < sampleCount; i++)
+    {
+        const ovrVector3f& position = referenceTrackings[i].HeadPose.Pose.Position;
+        maxDifference = fmaxf(maxDifference, fabsf(position.x - positions[0][i]));
+        maxDifference = fmaxf(maxDifference, fabsf(position.y - positions[1][i]));
+        maxDifference = fmaxf(maxDifference, fabsf(position.z - positions[2][i]));
+    }
+
+    const double totalSamples = (double)sampleCount * iterations;
+    results[0] = batchedNanoseconds > 0 ? totalSamples * 1e9 / batchedNanoseconds : 0.0;
+    results[1] = scalarNanoseconds > 0 ? totalSamples * 1e9 / scalarNanoseconds : 0.0;
+    results[2] = maxDifference;
+    LOG_MESSAGE("Head model benchmark: batched = %.0f samples/s, vrapi_ApplyHeadModel = %.0f samples/s, max difference = %g", results[0], results[1], results[2]);
+}
+
+struct GuardedReadBenchmarkThread
+{
+    GuardedPointer<ovrTracking>* guardedPointer;
+    std::atomic<bool>* running;
+    long long reads;
+};
+
+static void* GuardedReadBenchmarkThreadFunction(void* data)
+{
+    GuardedReadBenchmarkThread* benchmarkThread = (GuardedReadBenchmarkThread*)data;
+    while (benchmarkThread->running->load(std::memory_order_relaxed))
+    {
+        GuardedPointer<ovrTracking>::ReadScope scope(*benchmarkThread->guardedPointer);
+        benchmarkThread->reads += scope.get() != NULL ? 1 : 0;
+    }
+    return NULL;
+}
+
+// Cost of the getData read side (GuardedPointer::ReadScope) against a plain atomic load, alone and
+// with contendingThreads other threads reading in a loop. The owner republishes and retires the
+// pointer all along the contended run to include the VR mode transitions.
+// Returns { plain load ns/read, uncontended ns/read, contended ns/read, retires, mean retire wait us }
+static void BenchmarkGuardedRead(const int iterations, const int contendingThreads, double results[5])
+{
+    ovrTracking tracking;
+    memset(&tracking, 0, sizeof(tracking));
+    std::atomic<ovrTracking*> plainPointer(&tracking);
+    GuardedPointer<ovrTracking> guardedPointer;
+    guardedPointer.publish(&tracking);
+
+    long long found = 0;
+    long long start = GetTimeInNanoseconds();
+    for (int i = 0; i < iterations; i++)
+    {
+        found += plainPointer.load() != NULL ? 1 : 0;
+    }
+    const long long plainNanoseconds = GetTimeInNanoseconds() - start;
+
+    start = GetTimeInNanoseconds();
+    for (int i = 0; i < iterations; i++)
+    {
+        GuardedPointer<ovrTracking>::ReadScope scope(guardedPointer);
+        found += scope.get() != NULL ? 1 : 0;
+    }
+    const long long uncontendedNanoseconds = GetTimeInNanoseconds() - start;
+
+    std::atomic<bool> running(true);
+    std::vector<GuardedReadBenchmarkThread> benchmarkThreads(contendingThreads);
+    std::vector<pthread_t> threads(contendingThreads);
+    for (int i = 0; i < contendingThreads; i++)
+    {
+        benchmarkThreads[i].guardedPointer = &guardedPointer;
+        benchmarkThreads[i].running = &running;
+        benchmarkThreads[i].reads = 0;
+        pthread_create(&threads[i], NULL, GuardedReadBenchmarkThreadFunction, &benchmarkThreads[i]);
+    }
+    GuardedReadBenchmarkThread mainThread;
+    mainThread.guardedPointer = &guardedPointer;
+    mainThread.running = &running;
+    mainThread.reads = 0;
+    long long retireNanoseconds = 0;
+    int retires = 0;
+    start = GetTimeInNanoseconds();
+    for (int i = 0; i < iterations; i++)
+    {
+        {
+            GuardedPointer<ovrTracking>::ReadScope scope(guardedPointer);
+            mainThread.reads += scope.get() != NULL ? 1 : 0;
+        }
+        if ((i & 0xffff) == 0)
+        {
+            // The reads in flight meanwhile are the other threads'.
+            const long long retireStart = GetTimeInNanoseconds();
+            guardedPointer.retire();
+            retireNanoseconds += GetTimeInNanoseconds() - retireStart;
+            retires++;
+            guardedPointer.publish(&tracking);
+        }
+    }
+    const long long contendedNanoseconds = GetTimeInNanoseconds() - start;
+    running.store(false);
+    for (int i = 0; i < contendingThreads; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+
+    results[0] = (double)plainNanoseconds / iterations;
+    results[1] = (double)uncontendedNanoseconds / iterations;
+    results[2] = (double)contendedNanoseconds / iterations;
+    results[3] = retires;
+    results[4] = retires > 0 ? (double)retireNanoseconds / retires * 0.001 : 0.0;
+    LOG_MESSAGE("Guarded read benchmark (%lld): plain = %.1f ns, uncontended = %.1f ns, contended (%d threads) = %.1f ns, %d retires waited %.1f us on average", found, results[0], results[1], contendingThreads, results[2], retires, results[4]);
+}
+
+// Sustained throughput of the pose recorder and what it adds to the sampler thread: records poses as fast
+// as the files can be prepared (so far more often than the sampler would) through files of fileSize
+// bytes, keeping 2 of them. When the next file is not ready yet the pose is dropped by the recorder and
+// recorded again after yielding, so only the records written are timed (the max is the worst call,
+// usually a file switch).
+// Returns { records written per second, MB written per second, mean ns per record call, max ns per record call, records dropped, files completed }
+static bool BenchmarkPoseRecorder(const char* pathPrefix, const int records, const int fileSize, double results[6])
+{
+    static const int TRACKING_COUNT = 1024;
+    std::vector<ovrTracking> trackings(TRACKING_COUNT);
+    for (int i = 0; i < TRACKING_COUNT; i++)
+    {
+        memset(&trackings[i], 0, sizeof(ovrTracking));
+        trackings[i].Status = VRAPI_TRACKING_STATUS_ORIENTATION_TRACKED;
+        trackings[i].HeadPose.Pose.Orientation = RandomOrientation();
+        trackings[i].HeadPose.AngularVelocity.y = RandomFloat(-1.0f, 1.0f);
+        trackings[i].HeadPose.TimeInSeconds = i * 0.001;
+    }
+    
+    WorkerPool workers;
+    workers.start();
+    PoseRecorder recorder;
+    if (!recorder.start(&workers, pathPrefix, fileSize, 2))
+    {
+        workers.stop();
+        return false;
+    }
+    long long recordNanoseconds = 0;
+    long long maxNanoseconds = 0;
+    const long long start = GetTimeInNanoseconds();
+    for (int i = 0; i < records;)
+    {
+        const long long time = GetTimeInNanoseconds();
+        if (!recorder.record(trackings[i & (TRACKING_COUNT - 1)], POSE_RECORD_FLAG_MOUNTED, time))
+        {
+            sched_yield();
+            continue;
+        }
+        const long long nanoseconds = GetTimeInNanoseconds() - time;
+        recordNanoseconds += nanoseconds;
+        if (nanoseconds > maxNanoseconds)
+        {
+            maxNanoseconds = nanoseconds;
+        }
+        i++;
+    }
+    const long long nanoseconds = GetTimeInNanoseconds() - start;
+    recorder.stop();
+    workers.stop();
+    
+    float statistics[PoseRecorder::STATISTICS_FLOAT_COUNT];
+    recorder.getStatistics(statistics);
+    const double seconds = (double)nanoseconds * 1e-9;
+    results[0] = records / seconds;
+    results[1] = (double)records * sizeof(ovrPoseRecord) / (1024.0 * 1024.0) / seconds;
+    results[2] = (double)recordNanoseconds / records;
+    results[3] = (double)maxNanoseconds;
+    results[4] = statistics[1];
+    results[5] = statistics[2];
+    LOG_MESSAGE("Pose recorder benchmark: %.0f records/s (%.1f MB/s), %.1f ns per record (max %.0f ns), %.0f dropped, %.0f files", results[0], results[1], results[2], results[3], results[4], results[5]);
+    return true;
+}
+
+// A head looking around, sampled at 1 kHz: yaw and pitch sinusoids around a neck pivot, with the sampling
+// jitter and the sensor noise on the velocities and accelerations of a real recording (the noise is what
+// bounds the compression).
+static void GenerateHeadMotion(const int count, std::vector<ovrPoseRecord>& records)
+{
+    static const float NECK_UP = 0.075f;
+    static const float NECK_FORWARD = 0.0805f;
+    const float pi2 = 6.2831853f;
+    records.resize(count);
+    float previousPosition[3] = { 0.0f, 0.0f, 0.0f };
+    for (int i = 0; i < count; i++)
+    {
+        const double t = i * 0.001 + RandomFloat(-0.00005f, 0.00005f);
+        const float ft = (float)t;
+        const float yaw = 0.8f * sinf(pi2 * 0.25f * ft) + 0.3f * sinf(pi2 * 0.9f * ft);
+        const float yawRate = 0.8f * pi2 * 0.25f * cosf(pi2 * 0.25f * ft) + 0.3f * pi2 * 0.9f * cosf(pi2 * 0.9f * ft);
+        const float yawAcceleration = -0.8f * pi2 * pi2 * 0.0625f * sinf(pi2 * 0.25f * ft) - 0.3f * pi2 * pi2 * 0.81f * sinf(pi2 * 0.9f * ft);
+        const float pitch = 0.3f * sinf(pi2 * 0.4f * ft + 1.0f);
+        const float pitchRate = 0.3f * pi2 * 0.4f * cosf(pi2 * 0.4f * ft + 1.0f);
+        const float pitchAcceleration = -0.3f * pi2 * pi2 * 0.16f * sinf(pi2 * 0.4f * ft + 1.0f);
+        const float sy = sinf(yaw * 0.5f), cy = cosf(yaw * 0.5f), sp = sinf(pitch * 0.5f), cp = cosf(pitch * 0.5f);
+        ovrPoseRecord& record = records[i];
+        memset(&record, 0, sizeof(record));
+        record.MonotonicTimeInNanoseconds = 1000000000LL + (long long)(t * 1e9);
+        record.PredictionInSeconds = 0.048;
+        record.PoseTimeInSeconds = record.MonotonicTimeInNanoseconds * 1e-9 + record.PredictionInSeconds;
+        // yaw (around y) then pitch (around x)
+        record.Orientation[0] = cy * sp;
+        record.Orientation[1] = sy * cp;
+        record.Orientation[2] = -sy * sp;
+        record.Orientation[3] = cy * cp;
+        record.Position[0] = -NECK_FORWARD * sinf(yaw) * cosf(pitch);
+        record.Position[1] = NECK_UP * cosf(pitch) + NECK_FORWARD * sinf(pitch) - NECK_UP;
+        record.Position[2] = NECK_FORWARD - NECK_FORWARD * cosf(yaw) * cosf(pitch);
+        record.AngularVelocity[0] = pitchRate + RandomFloat(-0.003f, 0.003f);
+        record.AngularVelocity[1] = yawRate + RandomFloat(-0.003f, 0.003f);
+        record.AngularVelocity[2] = RandomFloat(-0.003f, 0.003f);
+        record.AngularAcceleration[0] = pitchAcceleration + RandomFloat(-0.05f, 0.05f);
+        record.AngularAcceleration[1] = yawAcceleration + RandomFloat(-0.05f, 0.05f);
+        record.AngularAcceleration[2] = RandomFloat(-0.05f, 0.05f);
+        for (int j = 0; j < 3; j++)
+        {
+            record.LinearVelocity[j] = i > 0 ? (record.Position[j] - previousPosition[j]) * 1000.0f : 0.0f;
+            record.LinearAcceleration[j] = RandomFloat(-0.05f, 0.05f);
+            previousPosition[j] = record.Position[j];
+        }
+        record.TrackingStatus = VRAPI_TRACKING_STATUS_ORIENTATION_TRACKED | VRAPI_TRACKING_STATUS_POSITION_TRACKED | VRAPI_TRACKING_STATUS_HMD_CONNECTED;
+        record.Flags = POSE_RECORD_FLAG_MOUNTED;
+        record.Sequence = i + 1;
+    }
+}
+
+// Compression and speed of the pose codec with the default error bounds (scaled by errorScale) on
+// poseCount poses of GenerateHeadMotion, encoded and decoded iterations times. The errors are checked
+// on the decoded poses.
+// Returns { raw bytes per pose, encoded bytes per pose, compression ratio, encoded poses per second, decoded poses per second, max orientation error (degrees), max angular velocity error (rad/s) }
+static void BenchmarkPoseCodec(const int poseCount, const int iterations, const float errorScale, double results[7])
+{
+    std::vector<ovrPoseRecord> records;
+    GenerateHeadMotion(poseCount, records);
+    ovrPoseCodecParms parms = ovrPoseCodec_DefaultParms();
+    parms.OrientationError *= errorScale;
+    parms.PositionError *= errorScale;
+    parms.AngularVelocityError *= errorScale;
+    parms.AngularAccelerationError *= errorScale;
+    parms.LinearVelocityError *= errorScale;
+    parms.LinearAccelerationError *= errorScale;
+    std::vector<unsigned char> encoded((size_t)poseCount * POSE_CODEC_MAX_ENCODED_SIZE);
+    
+    size_t encodedSize = 0;
+    long long start = GetTimeInNanoseconds();
+    for (int iteration = 0; iteration < iterations; iteration++)
+    {
+        PoseEncoder encoder(parms);
+        encodedSize = 0;
+        for (int i = 0; i < poseCount; i++)
+        {
+            encodedSize += encoder.encode(records[i], &encoded[encodedSize]);
+        }
+    }
+    const long long encodeNanoseconds = GetTimeInNanoseconds() - start;
+    
+    std::vector<ovrPoseRecord> decoded(poseCount);
+    start = GetTimeInNanoseconds();
+    for (int iteration = 0; iteration < iterations; iteration++)
+    {
+        PoseDecoder decoder(parms);
+        size_t offset = 0;
+        for (int i = 0; i < poseCount; i++)
+        {
+            offset += decoder.decode(&encoded[offset], encodedSize - offset, &decoded[i]);
+        }
+    }
+    const long long decodeNanoseconds = GetTimeInNanoseconds() - start;
+    
+    float maxOrientationError = 0.0f;
+    float maxAngularVelocityError = 0.0f;
+    for (int i = 0; i < poseCount; i++)
+    {
+        const ovrQuatf a = { records[i].Orientation[0], records[i].Orientation[1], records[i].Orientation[2], records[i].Orientation[3] };
+        const ovrQuatf b = { decoded[i].Orientation[0], decoded[i].Orientation[1], decoded[i].Orientation[2], decoded[i].Orientation[3] };
+        const float orientationError = ovrQuatf_AngleBetween(&a, &b);
+        maxOrientationError = orientationError > maxOrientationError ? orientationError : maxOrientationError;
+        for (int j = 0; j < 3; j++)
+        {
+            const float angularVelocityError = fabsf(records[i].AngularVelocity[j] - decoded[i].AngularVelocity[j]);
+            maxAngularVelocityError = angularVelocityError > maxAngularVelocityError ? angularVelocityError : maxAngularVelocityError;
+        }
+    }
+    
+    const double totalPoses = (double)poseCount * iterations;
+    results[0] = sizeof(ovrPoseRecord);
+    results[1] = (double)encodedSize / poseCount;
+    results[2] = results[0] / results[1];
+    results[3] = totalPoses / (encodeNanoseconds * 1e-9);
+    results[4] = totalPoses / (decodeNanoseconds * 1e-9);
+    results[5] = maxOrientationError * (180.0 / 3.14159265358979);
+    results[6] = maxAngularVelocityError;
+    LOG_MESSAGE("Pose codec benchmark: %.1f bytes per pose (%.1fx), encode %.0f poses/s, decode %.0f poses/s, max errors %f degrees %f rad/s", results[1], results[2], results[3], results[4], results[5], results[6]);
+}
+
+// Reading the orientation of the poses of random time windows of windowSeconds from poseCount poses of
+// GenerateHeadMotion, iterations times, from a columnar file (see PoseColumns.h) and from the same poses
+// as rows (as PoseRecorder writes them), both memory-mapped. The rows are searched by time too, so the
+// difference is only in the bytes read for each pose. The files are <pathPrefix>.ovrposec and
+// <pathPrefix>.rows and are deleted afterwards.
+// Returns { columnar file MB, row file MB, mean microseconds to find a window in the columnar index, orientations read per second from the columns, orientations read per second from the rows, mean poses per window }, all 0 if the files could not be written.
+static bool BenchmarkPoseColumns(const char* pathPrefix, const int poseCount, const double windowSeconds, const int iterations, double results[6])
+{
+    std::vector<ovrPoseRecord> records;
+    GenerateHeadMotion(poseCount, records);
+    char columnsPath[PoseRecorder::PATH_PREFIX_SIZE + 32];
+    char rowsPath[PoseRecorder::PATH_PREFIX_SIZE + 32];
+    snprintf(columnsPath, sizeof(columnsPath), "%s%s", pathPrefix, POSE_COLUMNS_FILE_EXTENSION);
+    snprintf(rowsPath, sizeof(rowsPath), "%s.rows", pathPrefix);
+    const size_t columnsSize = ovrPoseColumns_WriteFile(columnsPath, &records[0], poseCount, POSE_COLUMNS_DEFAULT_CHUNK_CAPACITY);
+    const size_t rowsSize = (size_t)poseCount * sizeof(ovrPoseRecord);
+    FILE* rowsFile = fopen(rowsPath, "wb");
+    const bool rowsWritten = rowsFile != NULL && fwrite(&records[0], sizeof(ovrPoseRecord), poseCount, rowsFile) == (size_t)poseCount;
+    if (rowsFile != NULL)
+    {
+        fclose(rowsFile);
+    }
+    PoseColumnsReader reader;
+    const int rowsFd = rowsWritten ? open(rowsPath, O_RDONLY) : -1;
+    void* rowsMapping = rowsFd >= 0 ? mmap(NULL, rowsSize, PROT_READ, MAP_SHARED, rowsFd, 0) : MAP_FAILED;
+    if (rowsFd >= 0)
+    {
+        close(rowsFd);
+    }
+    if (columnsSize == 0 || rowsMapping == MAP_FAILED || !reader.open(columnsPath))
+    {
+        if (rowsMapping != MAP_FAILED)
+        {
+            munmap(rowsMapping, rowsSize);
+        }
+        remove(columnsPath);
+        remove(rowsPath);
+        return false;
+    }
+    const ovrPoseRecord* rows = (const ovrPoseRecord*)rowsMapping;
+    const double firstTime = records[0].PoseTimeInSeconds;
+    const double duration = records[poseCount - 1].PoseTimeInSeconds - firstTime;
+    std::vector<double> startTimes(iterations);
+    for (int i = 0; i < iterations; i++)
+    {
+        startTimes[i] = firstTime + RandomFloat(0.0f, 1.0f) * (duration > windowSeconds ? duration - windowSeconds : 0.0);
+    }
+    
+    // Columns: the chunks from the index, then the records in the first and last ones
+    float sum = 0.0f;
+    long long poses = 0;
+    long long seekNanoseconds = 0;
+    long long start = GetTimeInNanoseconds();
+    for (int i = 0; i < iterations; i++)
+    {
+        const long long seekStart = GetTimeInNanoseconds();
+        int firstChunk = 0;
+        const int chunkCount = reader.findChunks(startTimes[i], startTimes[i] + windowSeconds, &firstChunk);
+        seekNanoseconds += GetTimeInNanoseconds() - seekStart;
+        for (int c = firstChunk; c < firstChunk + chunkCount; c++)
+        {
+            if (!reader.isChunkValid(c))
+            {
+                continue;
+            }
+            const unsigned int begin = c == firstChunk ? reader.findRecord(c, startTimes[i]) : 0;
+            const unsigned int end = c == firstChunk + chunkCount - 1 ? reader.findRecord(c, startTimes[i] + windowSeconds) : reader.getChunk(c).RecordCount;
+            const float* x = reader.getColumn<float>(c, POSE_COLUMN_ORIENTATION_X);
+            const float* y = reader.getColumn<float>(c, POSE_COLUMN_ORIENTATION_Y);
+            const float* z = reader.getColumn<float>(c, POSE_COLUMN_ORIENTATION_Z);
+            const float* w = reader.getColumn<float>(c, POSE_COLUMN_ORIENTATION_W);
+            for (unsigned int r = begin; r < end; r++)
+            {
+                sum += x[r] + y[r] + z[r] + w[r];
+            }
+            poses += end > begin ? end - begin : 0;
+        }
+    }
+    const long long columnsNanoseconds = GetTimeInNanoseconds() - start;
+    
+    // Rows: the first record by binary search, then every record of the window
+    float rowsSum = 0.0f;
+    start = GetTimeInNanoseconds();
+    for (int i = 0; i < iterations; i++)
+    {
+        int low = 0;
+        int high = poseCount;
+        while (low < high)
+        {
+            const int middle = (low + high) / 2;
+            if (rows[middle].PoseTimeInSeconds < startTimes[i])
+            {
+                low = middle + 1;
+            }
+            else
+            {
+                high = middle;
+            }
+        }
+        const double endTime = startTimes[i] + windowSeconds;
+        for (int r = low; r < poseCount && rows[r].PoseTimeInSeconds < endTime; r++)
+        {
+            rowsSum += rows[r].Orientation[0] + rows[r].Orientation[1] + rows[r].Orientation[2] + rows[r].Orientation[3];
+        }
+    }
+    const long long rowsNanoseconds = GetTimeInNanoseconds() - start;
+    
+    munmap(rowsMapping, rowsSize);
+    reader.close();
+    remove(columnsPath);
+    remove(rowsPath);
+    
+    results[0] = columnsSize / (1024.0 * 1024.0);
+    results[1] = rowsSize / (1024.0 * 1024.0);
+    results[2] = seekNanoseconds * 1e-3 / iterations;
+    results[3] = poses / (columnsNanoseconds * 1e-9);
+    results[4] = poses / (rowsNanoseconds * 1e-9);
+    results[5] = (double)poses / iterations;
+    LOG_MESSAGE("Pose columns benchmark: %.1f MB (rows %.1f MB), %.2f us to find a window, %.0f orientations/s from columns, %.0f from rows, %.0f poses per window (%f %f)", results[0], results[1], results[2], results[3], results[4], results[5], sum, rowsSum);
+    return true;
+}
+
+// The cost of keeping the flight recorder on: iterations poses recorded as the sampler thread does and
+// iterations events recorded as the tracking thread does, then a dump of the full histories to the file
+// (deleted afterwards).
+// Returns { mean ns per pose recorded, mean ns per event recorded, ms to dump the full histories }, all 0 if the file could not be written.
+static bool BenchmarkFlightRecorder(const char* path, const int iterations, double results[3])
+{
+    FlightRecorder* flightRecorder = new FlightRecorder();
+    ovrTracking tracking;
+    memset(&tracking, 0, sizeof(tracking));
+    tracking.HeadPose.Pose.Orientation.w = 1.0f;
+    
+    long long start = GetTimeInNanoseconds();
+    for (int i = 0; i < iterations; i++)
+    {
+        tracking.HeadPose.TimeInSeconds = i * 0.001;
+        flightRecorder->recordPose(tracking, GetTimeInNanoseconds(), FLIGHT_POSE_SAMPLED);
+    }
+    const long long poseNanoseconds = GetTimeInNanoseconds() - start;
+    
+    start = GetTimeInNanoseconds();
+    for (int i = 0; i < iterations; i++)
+    {
+        flightRecorder->recordEvent(FLIGHT_EVENT_LIFECYCLE, "message %s", "SET_SAMPLING_RATE");
+    }
+    const long long eventNanoseconds = GetTimeInNanoseconds() - start;
+    
+    start = GetTimeInNanoseconds();
+    const bool dumped = flightRecorder->dump(path, "benchmark");
+    const long long dumpNanoseconds = GetTimeInNanoseconds() - start;
+    delete flightRecorder;
+    remove(path);
+    if (!dumped)
+    {
+        return false;
+    }
+    
+    results[0] = (double)poseNanoseconds / iterations;
+    results[1] = (double)eventNanoseconds / iterations;
+    results[2] = dumpNanoseconds * 1e-6;
+    LOG_MESSAGE("Flight recorder benchmark: %.1f ns per pose, %.1f ns per event, %.1f ms per dump", results[0], results[1], results[2]);
+    return true;
+}
+
+extern "C"
+{
+    JNIEXPORT void JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTrackingBenchmarks_nativeBenchmarkHeadModel(JNIEnv* jniEnv, jclass clazz, jint sampleCount, jint iterations, jdoubleArray resultsJDoubleArray)
+    {
+        double results[3] = { 0.0, 0.0, 0.0 };
+        if (sampleCount > 0 && iterations > 0)
+        {
+            BenchmarkHeadModel(sampleCount, iterations, results);
+        }
+        jniEnv->SetDoubleArrayRegion(resultsJDoubleArray, 0, 3, results);
+    }
+    
+    JNIEXPORT void JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTrackingBenchmarks_nativeBenchmarkGuardedRead(JNIEnv* jniEnv, jclass clazz, jint iterations, jint contendingThreads, jdoubleArray resultsJDoubleArray)
+    {
+        double results[5] = { 0.0, 0.0, 0.0, 0.0, 0.0 };
+        if (iterations > 0 && contendingThreads >= 0)
+        {
+            BenchmarkGuardedRead(iterations, contendingThreads, results);
+        }
+        jniEnv->SetDoubleArrayRegion(resultsJDoubleArray, 0, 5, results);
+    }
+    
+    JNIEXPORT jboolean JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTrackingBenchmarks_nativeBenchmarkPoseRecorder(JNIEnv* jniEnv, jclass clazz, jstring pathPrefixJString, jint records, jint fileSize, jdoubleArray resultsJDoubleArray)
+    {
+        double results[6] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+        bool recorded = false;
+        if (pathPrefixJString != NULL && records > 0)
+        {
+            const char* pathPrefix = jniEnv->GetStringUTFChars(pathPrefixJString, NULL);
+            recorded = BenchmarkPoseRecorder(pathPrefix, records, fileSize, results);
+            jniEnv->ReleaseStringUTFChars(pathPrefixJString, pathPrefix);
+        }
+        jniEnv->SetDoubleArrayRegion(resultsJDoubleArray, 0, 6, results);
+        return recorded ? JNI_TRUE : JNI_FALSE;
+    }
+    
+    JNIEXPORT void JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTrackingBenchmarks_nativeBenchmarkPoseCodec(JNIEnv* jniEnv, jclass clazz, jint poseCount, jint iterations, jfloat errorScale, jdoubleArray resultsJDoubleArray)
+    {
+        double results[7] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+        if (poseCount > 0 && iterations > 0 && errorScale > 0.0f)
+        {
+            BenchmarkPoseCodec(poseCount, iterations, errorScale, results);
+        }
+        jniEnv->SetDoubleArrayRegion(resultsJDoubleArray, 0, 7, results);
+    }
+    
+    JNIEXPORT jboolean JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTrackingBenchmarks_nativeBenchmarkPoseColumns(JNIEnv* jniEnv, jclass clazz, jstring pathPrefixJString, jint poseCount, jdouble windowSeconds, jint iterations, jdoubleArray resultsJDoubleArray)
+    {
+        double results[6] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+        bool written = false;
+        if (pathPrefixJString != NULL && poseCount > 0 && windowSeconds > 0.0 && iterations > 0)
+        {
+            const char* pathPrefix = jniEnv->GetStringUTFChars(pathPrefixJString, NULL);
+            written = BenchmarkPoseColumns(pathPrefix, poseCount, windowSeconds, iterations, results);
+            jniEnv->ReleaseStringUTFChars(pathPrefixJString, pathPrefix);
+        }
+        jniEnv->SetDoubleArrayRegion(resultsJDoubleArray, 0, 6, results);
+        return written ? JNI_TRUE : JNI_FALSE;
+    }
+    
+    JNIEXPORT jboolean JNICALL Java_com_judax_oculusmobilesdkheadtracking_OculusMobileSDKHeadTrackingBenchmarks_nativeBenchmarkFlightRecorder(JNIEnv* jniEnv, jclass clazz, jstring pathJString, jint iterations, jdoubleArray resultsJDoubleArray)
+    {
+        double results[3] = { 0.0, 0.0, 0.0 };
+        bool dumped = false;
+        if (pathJString != NULL && iterations > 0)
+        {
+            const char* path = jniEnv->GetStringUTFChars(pathJString, NULL);
+            dumped = BenchmarkFlightRecorder(path, iterations, results);
+            jniEnv->ReleaseStringUTFChars(pathJString, path);
+        }
+        jniEnv->SetDoubleArrayRegion(resultsJDoubleArray, 0, 3, results);
+        return dumped ? JNI_TRUE : JNI_FALSE;
+    }
+}
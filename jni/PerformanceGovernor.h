@@ -0,0 +1,183 @@
+#ifndef PERFORMANCE_GOVERNOR_H
+#define PERFORMANCE_GOVERNOR_H
+
+#include "SampleRing.h"
+
+// ================================================================================================
+// PerformanceGovernor
+// Lowers the CPU/GPU clock levels and the internal sampling rate as the device heats up, before the
+// system has to throttle it hard in the middle of a session. It is fed the vrapi thermal status
+// (VRAPI_SYS_STATUS_THROTTLED, THROTTLED2 and THROTTLED_WARNING_LEVEL) from the tracking thread:
+// - it steps down as soon as the status gets worse,
+// - it steps back up one state at a time, only after the status has been better for RECOVERY_SECONDS
+//   (so it does not oscillate around a thermal limit).
+// Every change of state is kept in a small ring of decisions that can be read from any thread.
+// ================================================================================================
+typedef struct
+{
+    double TimeInSeconds;
+    int State;
+    int WarningLevel;
+    int CpuLevel;
+    int GpuLevel;
+    int SamplingRate;
+} ovrGovernorDecision;
+
+class PerformanceGovernor
+{
+public:
+    enum States
+    {
+        STATE_NOMINAL,
+        STATE_WARNING,
+        STATE_THROTTLED,
+        STATE_THROTTLED2,
+        STATE_COUNT
+    };
+
+    static const int DECISION_HISTORY_SIZE = 64;
+    // time, state, warning level, cpu level, gpu level, sampling rate
+    static const int DOUBLES_PER_DECISION = 6;
+
+private:
+    static constexpr double RECOVERY_SECONDS = 30.0;
+
+    // How much each state takes away from the base clock levels and divides the sampling rate by.
+    static int getLevelReduction(const int state)
+    {
+        static const int reductions[STATE_COUNT] = { 0, 1, 2, 3 };
+        return reductions[state];
+    }
+
+    static int getSamplingRateDivisor(const int state)
+    {
+        static const int divisors[STATE_COUNT] = { 1, 2, 4, 8 };
+        return divisors[state];
+    }
+
+    int baseCpuLevel;
+    int baseGpuLevel;
+    int state;
+    // The state the status asks for and since when.
+    int targetState;
+    double targetStateTime;
+    SampleRing<ovrGovernorDecision, DECISION_HISTORY_SIZE> decisions;
+
+    static int getStateFromStatus(const bool throttled, const bool throttled2, const int warningLevel)
+    {
+        if (throttled2)
+        {
+            return STATE_THROTTLED2;
+        }
+        if (throttled)
+        {
+            return STATE_THROTTLED;
+        }
+        return warningLevel > 0 ? STATE_WARNING : STATE_NOMINAL;
+    }
+
+public:
+    PerformanceGovernor(const int baseCpuLevel, const int baseGpuLevel): baseCpuLevel(baseCpuLevel), baseGpuLevel(baseGpuLevel), state(STATE_NOMINAL), targetState(STATE_NOMINAL), targetStateTime(0.0)
+    {
+    }
+
+    // Back to the nominal state. Only from the thread that calls update.
+    void reset()
+    {
+        state = STATE_NOMINAL;
+        targetState = STATE_NOMINAL;
+        targetStateTime = 0.0;
+    }
+
+    // Returns true if the state changed (and a decision was recorded). requestedSamplingRate is only
+    // used to fill in the decision.
+    bool update(const double time, const bool throttled, const bool throttled2, const int warningLevel, const int requestedSamplingRate)
+    {
+        const int statusState = getStateFromStatus(throttled, throttled2, warningLevel);
+        if (statusState != targetState)
+        {
+            targetState = statusState;
+            targetStateTime = time;
+        }
+
+        int newState = state;
+        if (targetState > state)
+        {
+            newState = targetState;
+        }
+        else if (targetState < state && time - targetStateTime >= RECOVERY_SECONDS)
+        {
+            newState = state - 1;
+            // The next step up needs another full recovery period
+            targetStateTime = time;
+        }
+        if (newState == state)
+        {
+            return false;
+        }
+
+        state = newState;
+        ovrGovernorDecision decision;
+        decision.TimeInSeconds = time;
+        decision.State = state;
+        decision.WarningLevel = warningLevel;
+        decision.CpuLevel = getCpuLevel();
+        decision.GpuLevel = getGpuLevel();
+        decision.SamplingRate = getSamplingRate(requestedSamplingRate);
+        decisions.push(decision);
+        return true;
+    }
+
+    inline int getState() const
+    {
+        return state;
+    }
+
+    inline int getCpuLevel() const
+    {
+        const int level = baseCpuLevel - getLevelReduction(state);
+        return level < 0 ? 0 : level;
+    }
+
+    inline int getGpuLevel() const
+    {
+        const int level = baseGpuLevel - getLevelReduction(state);
+        return level < 0 ? 0 : level;
+    }
+
+    // The sampling rate to actually use for the requested one.
+    inline int getSamplingRate(const int requestedSamplingRate) const
+    {
+        const int samplingRate = requestedSamplingRate / getSamplingRateDivisor(state);
+        // Slower, but never stopped
+        return samplingRate == 0 && requestedSamplingRate > 0 ? 1 : samplingRate;
+    }
+
+    // Copies the last decisions (at most DECISION_HISTORY_SIZE), oldest first, as DOUBLES_PER_DECISION
+    // doubles each. Returns how many were copied. Can be called from any thread.
+    int getDecisions(double values[DECISION_HISTORY_SIZE * DOUBLES_PER_DECISION]) const
+    {
+        const unsigned int writeCount = decisions.getWriteCount();
+        const unsigned int first = writeCount > (unsigned int)DECISION_HISTORY_SIZE ? writeCount - DECISION_HISTORY_SIZE : 0;
+        int count = 0;
+        for (unsigned int index = first; index < writeCount; index++)
+        {
+            ovrGovernorDecision decision;
+            if (!decisions.read(index, decision))
+            {
+                continue;
+            }
+            double* decisionValues = values + count * DOUBLES_PER_DECISION;
+            decisionValues[0] = decision.TimeInSeconds;
+            decisionValues[1] = decision.State;
+            decisionValues[2] = decision.WarningLevel;
+            decisionValues[3] = decision.CpuLevel;
+            decisionValues[4] = decision.GpuLevel;
+            decisionValues[5] = decision.SamplingRate;
+            count++;
+        }
+        return count;
+    }
+};
+
+#endif // PERFORMANCE_GOVERNOR_H
@@ -0,0 +1,502 @@
+#ifndef POSE_CODEC_H
+#define POSE_CODEC_H
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include <vector>
+#include <algorithm>
+
+#include "PoseRecorder.h"
+
+// ================================================================================================
+// PoseCodec
+// A lossy codec for streams of ovrPoseRecord (see PoseRecorder), for recordings that are kept or sent
+// around. Every value is quantized to fixed point with a configurable error bound:
+// - the orientation with smallest three: the index of the largest component (made positive, q and -q
+//   are the same rotation) and the other three, which are within +-1/sqrt(2),
+// - positions, velocities and accelerations with one step per quantity,
+// - the times to microseconds.
+// Each record is then encoded as the difference of its quantized values against the previous record
+// (the time as the difference of the interval), zigzag and varint packed, so a smooth motion sampled
+// at a steady rate takes a few bits per value. The pose values go in pairs: two small ones (zigzag
+// under 8) share a single byte, otherwise a 0 byte is followed by both varints. Every
+// KeyframeInterval records the values are written as they are instead, so a stream can be decoded
+// from any keyframe. The deltas are taken between quantized values: the error never accumulates, it
+// stays within the bounds over the whole stream.
+// ================================================================================================
+#define POSE_CODEC_MAX_ENCODED_SIZE 160
+
+typedef struct
+{
+    // Max absolute error of each of the three smallest orientation components (the largest one is
+    // derived from them).
+    float	OrientationError;
+    // Meters.
+    float	PositionError;
+    // Radians per second, radians per second squared.
+    float	AngularVelocityError;
+    float	AngularAccelerationError;
+    // Meters per second, meters per second squared.
+    float	LinearVelocityError;
+    float	LinearAccelerationError;
+    // Records between keyframes (1 makes every record a keyframe).
+    int		KeyframeInterval;
+} ovrPoseCodecParms;
+
+// Close to what the sensors resolve: at most about 0.06 degrees, 0.1 mm, 0.001 rad/s and 0.01 rad/s^2.
+static inline ovrPoseCodecParms ovrPoseCodec_DefaultParms()
+{
+    ovrPoseCodecParms parms;
+    parms.OrientationError = 0.0001f;
+    parms.PositionError = 0.0001f;
+    parms.AngularVelocityError = 0.001f;
+    parms.AngularAccelerationError = 0.01f;
+    parms.LinearVelocityError = 0.001f;
+    parms.LinearAccelerationError = 0.01f;
+    parms.KeyframeInterval = 1000;
+    return parms;
+}
+
+static inline unsigned char * ovrPoseCodec_WriteVarint( unsigned char * out, unsigned long long value )
+{
+    while ( value >= 0x80 )
+    {
+        *out++ = (unsigned char)( value | 0x80 );
+        value >>= 7;
+    }
+    *out++ = (unsigned char)value;
+    return out;
+}
+
+// Returns NULL if the varint does not end before end.
+static inline const unsigned char * ovrPoseCodec_ReadVarint( const unsigned char * in, const unsigned char * end, unsigned long long * value )
+{
+    unsigned long long result = 0;
+    for ( int shift = 0; in < end && shift < 64; shift += 7 )
+    {
+        const unsigned char byte = *in++;
+        result |= (unsigned long long)( byte & 0x7f ) << shift;
+        if ( ( byte & 0x80 ) == 0 )
+        {
+            *value = result;
+            return in;
+        }
+    }
+    return NULL;
+}
+
+static inline unsigned long long ovrPoseCodec_ZigZag( const long long value )
+{
+    return ( (unsigned long long)value << 1 ) ^ (unsigned long long)( value >> 63 );
+}
+
+static inline long long ovrPoseCodec_UnZigZag( const unsigned long long value )
+{
+    return (long long)( value >> 1 ) ^ -(long long)( value & 1 );
+}
+
+// ================================================================================================
+// The quantized values of a record, shared by the encoder and the decoder.
+// ================================================================================================
+class PoseCodecState
+{
+public:
+    enum
+    {
+        VECTOR_COUNT = 5,
+        VALUE_COUNT = 3 + VECTOR_COUNT * 3
+    };
+
+    enum FrameFlags
+    {
+        FRAME_LARGEST_INDEX_MASK = 3,
+        FRAME_KEYFRAME = 4,
+        FRAME_STATUS_CHANGED = 8
+    };
+
+    // Microseconds.
+    long long time;
+    long long interval;
+    long long poseTimeOffset;
+    long long prediction;
+    unsigned int sequence;
+    unsigned int status;
+    unsigned int flags;
+    int largestIndex;
+    // The three smallest orientation components then position, angular velocity, linear velocity, angular
+    // acceleration and linear acceleration.
+    int values[VALUE_COUNT];
+    int recordCount;
+
+protected:
+    ovrPoseCodecParms parms;
+    float steps[VALUE_COUNT];
+    float inverseSteps[VALUE_COUNT];
+
+    explicit PoseCodecState(const ovrPoseCodecParms& codecParms): parms(codecParms)
+    {
+        // Rounding to the nearest step makes the error at most half a step.
+        const float errors[1 + VECTOR_COUNT] = { parms.OrientationError, parms.PositionError, parms.AngularVelocityError, parms.LinearVelocityError, parms.AngularAccelerationError, parms.LinearAccelerationError };
+        for (int i = 0; i < VALUE_COUNT; i++)
+        {
+            steps[i] = 2.0f * (errors[i / 3] > 0.0f ? errors[i / 3] : 1e-6f);
+            inverseSteps[i] = 1.0f / steps[i];
+        }
+        if (parms.KeyframeInterval < 1)
+        {
+            parms.KeyframeInterval = 1;
+        }
+        reset();
+    }
+
+public:
+    // The next record is a keyframe.
+    void reset()
+    {
+        memset(values, 0, sizeof(values));
+        time = 0;
+        interval = 0;
+        poseTimeOffset = 0;
+        prediction = 0;
+        sequence = 0;
+        status = 0;
+        flags = 0;
+        largestIndex = 3;
+        recordCount = 0;
+    }
+
+    inline const ovrPoseCodecParms& getParms() const
+    {
+        return parms;
+    }
+};
+
+class PoseEncoder: public PoseCodecState
+{
+private:
+    inline int quantize(const int index, const float value) const
+    {
+        float scaled = value * inverseSteps[index];
+        scaled = scaled > 1073741824.0f ? 1073741824.0f : (scaled < -1073741824.0f ? -1073741824.0f : scaled);
+        return (int)lrintf(scaled);
+    }
+
+public:
+    explicit PoseEncoder(const ovrPoseCodecParms& parms): PoseCodecState(parms)
+    {
+    }
+
+    // Writes the record to out (at least POSE_CODEC_MAX_ENCODED_SIZE bytes) and returns the bytes written.
+    size_t encode(const ovrPoseRecord& record, unsigned char* out)
+    {
+        const bool keyframe = (recordCount % parms.KeyframeInterval) == 0;
+        recordCount++;
+
+        // Smallest three
+        const float* q = record.Orientation;
+        int largest = 0;
+        for (int i = 1; i < 4; i++)
+        {
+            if (fabsf(q[i]) > fabsf(q[largest]))
+            {
+                largest = i;
+            }
+        }
+        const float sign = q[largest] < 0.0f ? -1.0f : 1.0f;
+        int quantized[VALUE_COUNT];
+        for (int i = 0, j = 0; i < 4; i++)
+        {
+            if (i != largest)
+            {
+                quantized[j] = quantize(j, q[i] * sign);
+                j++;
+            }
+        }
+        const float* vectors[VECTOR_COUNT] = { record.Position, record.AngularVelocity, record.LinearVelocity, record.AngularAcceleration, record.LinearAcceleration };
+        for (int i = 3; i < VALUE_COUNT; i++)
+        {
+            quantized[i] = quantize(i, vectors[i / 3 - 1][i % 3]);
+        }
+        const long long recordTime = (record.MonotonicTimeInNanoseconds + 500) / 1000;
+        const long long recordPoseTimeOffset = llround(record.PoseTimeInSeconds * 1e6) - recordTime;
+        const long long recordPrediction = llround(record.PredictionInSeconds * 1e6);
+        const bool statusChanged = keyframe || record.TrackingStatus != status || record.Flags != flags;
+
+        unsigned char* p = out;
+        *p++ = (unsigned char)(largest | (keyframe ? FRAME_KEYFRAME : 0) | (statusChanged ? FRAME_STATUS_CHANGED : 0));
+        if (keyframe)
+        {
+            p = ovrPoseCodec_WriteVarint(p, (unsigned long long)recordTime);
+            p = ovrPoseCodec_WriteVarint(p, ovrPoseCodec_ZigZag(recordPoseTimeOffset));
+            p = ovrPoseCodec_WriteVarint(p, ovrPoseCodec_ZigZag(recordPrediction));
+            p = ovrPoseCodec_WriteVarint(p, record.Sequence);
+            interval = 0;
+        }
+        else
+        {
+            // The interval is nearly constant: its difference is what is left
+            const long long recordInterval = recordTime - time;
+            p = ovrPoseCodec_WriteVarint(p, ovrPoseCodec_ZigZag(recordInterval - interval));
+            p = ovrPoseCodec_WriteVarint(p, ovrPoseCodec_ZigZag(recordPoseTimeOffset - poseTimeOffset));
+            p = ovrPoseCodec_WriteVarint(p, ovrPoseCodec_ZigZag(recordPrediction - prediction));
+            p = ovrPoseCodec_WriteVarint(p, ovrPoseCodec_ZigZag((long long)record.Sequence - sequence - 1));
+            interval = recordInterval;
+        }
+        if (statusChanged)
+        {
+            p = ovrPoseCodec_WriteVarint(p, record.TrackingStatus);
+            p = ovrPoseCodec_WriteVarint(p, record.Flags);
+        }
+        // The orientation components are only comparable with the same largest component
+        const int firstDelta = keyframe ? VALUE_COUNT : (largest == largestIndex ? 0 : 3);
+        for (int i = 0; i < VALUE_COUNT; i += 2)
+        {
+            const unsigned long long a = ovrPoseCodec_ZigZag(i >= firstDelta ? (long long)quantized[i] - values[i] : quantized[i]);
+            const unsigned long long b = ovrPoseCodec_ZigZag(i + 1 >= firstDelta ? (long long)quantized[i + 1] - values[i + 1] : quantized[i + 1]);
+            if (a < 8 && b < 8)
+            {
+                *p++ = (unsigned char)(0x80 | (a << 3) | b);
+            }
+            else
+            {
+                *p++ = 0;
+                p = ovrPoseCodec_WriteVarint(p, a);
+                p = ovrPoseCodec_WriteVarint(p, b);
+            }
+        }
+
+        time = recordTime;
+        poseTimeOffset = recordPoseTimeOffset;
+        prediction = recordPrediction;
+        sequence = record.Sequence;
+        status = record.TrackingStatus;
+        flags = record.Flags;
+        largestIndex = largest;
+        memcpy(values, quantized, sizeof(values));
+        return (size_t)(p - out);
+    }
+};
+
+class PoseDecoder: public PoseCodecState
+{
+public:
+    explicit PoseDecoder(const ovrPoseCodecParms& parms): PoseCodecState(parms)
+    {
+    }
+
+    // Reads one record from in. Returns the bytes read, 0 if the data ends before the record does (or the first
+    // record read is not a keyframe).
+    size_t decode(const unsigned char* in, const size_t size, ovrPoseRecord* record)
+    {
+        const unsigned char* end = in + size;
+        const unsigned char* p = in;
+        if (p >= end)
+        {
+            return 0;
+        }
+        const unsigned char frameFlags = *p++;
+        const bool keyframe = (frameFlags & FRAME_KEYFRAME) != 0;
+        if (!keyframe && recordCount == 0)
+        {
+            return 0;
+        }
+        unsigned long long v[4];
+        for (int i = 0; i < 4; i++)
+        {
+            if ((p = ovrPoseCodec_ReadVarint(p, end, &v[i])) == NULL)
+            {
+                return 0;
+            }
+        }
+        long long recordTime;
+        long long recordPoseTimeOffset;
+        long long recordPrediction;
+        unsigned int recordSequence;
+        if (keyframe)
+        {
+            recordTime = (long long)v[0];
+            recordPoseTimeOffset = ovrPoseCodec_UnZigZag(v[1]);
+            recordPrediction = ovrPoseCodec_UnZigZag(v[2]);
+            recordSequence = (unsigned int)v[3];
+            interval = 0;
+        }
+        else
+        {
+            interval += ovrPoseCodec_UnZigZag(v[0]);
+            recordTime = time + interval;
+            recordPoseTimeOffset = poseTimeOffset + ovrPoseCodec_UnZigZag(v[1]);
+            recordPrediction = prediction + ovrPoseCodec_UnZigZag(v[2]);
+            recordSequence = (unsigned int)(sequence + 1 + ovrPoseCodec_UnZigZag(v[3]));
+        }
+        unsigned int recordStatus = status;
+        unsigned int recordFlags = flags;
+        if ((frameFlags & FRAME_STATUS_CHANGED) != 0)
+        {
+            unsigned long long statusValue;
+            unsigned long long flagsValue;
+            if ((p = ovrPoseCodec_ReadVarint(p, end, &statusValue)) == NULL || (p = ovrPoseCodec_ReadVarint(p, end, &flagsValue)) == NULL)
+            {
+                return 0;
+            }
+            recordStatus = (unsigned int)statusValue;
+            recordFlags = (unsigned int)flagsValue;
+        }
+        const int largest = frameFlags & FRAME_LARGEST_INDEX_MASK;
+        const int firstDelta = keyframe ? VALUE_COUNT : (largest == largestIndex ? 0 : 3);
+        int quantized[VALUE_COUNT];
+        for (int i = 0; i < VALUE_COUNT; i += 2)
+        {
+            if (p >= end)
+            {
+                return 0;
+            }
+            unsigned long long pair[2];
+            const unsigned char packed = *p++;
+            if (packed != 0)
+            {
+                pair[0] = (packed >> 3) & 7;
+                pair[1] = packed & 7;
+            }
+            else if ((p = ovrPoseCodec_ReadVarint(p, end, &pair[0])) == NULL || (p = ovrPoseCodec_ReadVarint(p, end, &pair[1])) == NULL)
+            {
+                return 0;
+            }
+            for (int j = 0; j < 2; j++)
+            {
+                quantized[i + j] = (int)(ovrPoseCodec_UnZigZag(pair[j]) + (i + j >= firstDelta ? values[i + j] : 0));
+            }
+        }
+
+        memset(record, 0, sizeof(ovrPoseRecord));
+        record->MonotonicTimeInNanoseconds = recordTime * 1000;
+        record->PoseTimeInSeconds = (double)(recordTime + recordPoseTimeOffset) * 1e-6;
+        record->PredictionInSeconds = (double)recordPrediction * 1e-6;
+        float sumOfSquares = 0.0f;
+        for (int i = 0, j = 0; i < 4; i++)
+        {
+            if (i != largest)
+            {
+                record->Orientation[i] = quantized[j] * steps[j];
+                sumOfSquares += record->Orientation[i] * record->Orientation[i];
+                j++;
+            }
+        }
+        record->Orientation[largest] = sumOfSquares < 1.0f ? sqrtf(1.0f - sumOfSquares) : 0.0f;
+        float* vectors[VECTOR_COUNT] = { record->Position, record->AngularVelocity, record->LinearVelocity, record->AngularAcceleration, record->LinearAcceleration };
+        for (int i = 3; i < VALUE_COUNT; i++)
+        {
+            vectors[i / 3 - 1][i % 3] = quantized[i] * steps[i];
+        }
+        record->TrackingStatus = recordStatus;
+        record->Flags = recordFlags;
+        record->Sequence = recordSequence;
+
+        recordCount++;
+        time = recordTime;
+        poseTimeOffset = recordPoseTimeOffset;
+        prediction = recordPrediction;
+        sequence = recordSequence;
+        status = recordStatus;
+        flags = recordFlags;
+        largestIndex = largest;
+        memcpy(values, quantized, sizeof(values));
+        return (size_t)(p - in);
+    }
+};
+
+// ================================================================================================
+// Compressed recording file (<pathPrefix>.ovrposez): an ovrPoseCodecFileHeader (with the parms the
+// records were encoded with) followed by the encoded records.
+// ================================================================================================
+#define POSE_CODEC_FILE_MAGIC "OVRPOSZ"
+#define POSE_CODEC_FILE_VERSION 1
+#define POSE_CODEC_FILE_EXTENSION ".ovrposez"
+
+typedef struct
+{
+    char				Magic[8];
+    unsigned int		Version;
+    unsigned int		RecordCount;
+    ovrPoseCodecParms	Parms;
+} ovrPoseCodecFileHeader;
+
+// Returns the size of the file, 0 if it could not be written.
+static inline size_t ovrPoseCodec_WriteFile( const char * path, const ovrPoseCodecParms * parms, const ovrPoseRecord * records, const int count )
+{
+    FILE * file = fopen( path, "wb" );
+    if ( file == NULL )
+    {
+        return 0;
+    }
+    ovrPoseCodecFileHeader header;
+    memset( &header, 0, sizeof( header ) );
+    memcpy( header.Magic, POSE_CODEC_FILE_MAGIC, sizeof( POSE_CODEC_FILE_MAGIC ) );
+    header.Version = POSE_CODEC_FILE_VERSION;
+    header.RecordCount = (unsigned int)count;
+    header.Parms = *parms;
+    bool written = fwrite( &header, sizeof( header ), 1, file ) == 1;
+    size_t size = sizeof( header );
+    PoseEncoder encoder( *parms );
+    unsigned char buffer[POSE_CODEC_MAX_ENCODED_SIZE];
+    for ( int i = 0; i < count && written; i++ )
+    {
+        const size_t encodedSize = encoder.encode( records[i], buffer );
+        written = fwrite( buffer, 1, encodedSize, file ) == encodedSize;
+        size += encodedSize;
+    }
+    written = fclose( file ) == 0 && written;
+    if ( !written )
+    {
+        remove( path );
+        return 0;
+    }
+    return size;
+}
+
+// Appends the records of the file. Returns false if it could not be read or is not valid.
+static inline bool ovrPoseCodec_ReadFile( const char * path, std::vector<ovrPoseRecord> & records )
+{
+    FILE * file = fopen( path, "rb" );
+    if ( file == NULL )
+    {
+        return false;
+    }
+    ovrPoseCodecFileHeader header;
+    std::vector<unsigned char> data;
+    bool valid = fread( &header, sizeof( header ), 1, file ) == 1 && memcmp( header.Magic, POSE_CODEC_FILE_MAGIC, sizeof( POSE_CODEC_FILE_MAGIC ) ) == 0 &&
+                 header.Version == POSE_CODEC_FILE_VERSION;
+    if ( valid )
+    {
+        unsigned char buffer[4096];
+        for ( size_t readSize = fread( buffer, 1, sizeof( buffer ), file ); readSize > 0; readSize = fread( buffer, 1, sizeof( buffer ), file ) )
+        {
+            data.insert( data.end(), buffer, buffer + readSize );
+        }
+    }
+    fclose( file );
+    if ( !valid )
+    {
+        return false;
+    }
+    PoseDecoder decoder( header.Parms );
+    // The record count comes from the file: every record takes at least a byte, so no more than the data
+    // holds is reserved and the records are appended as they are decoded.
+    records.reserve( records.size() + std::min( (size_t)header.RecordCount, data.size() ) );
+    size_t offset = 0;
+    for ( unsigned int i = 0; i < header.RecordCount; i++ )
+    {
+        ovrPoseRecord record = ovrPoseRecord();
+        const size_t decodedSize = decoder.decode( data.empty() ? NULL : &data[offset], data.size() - offset, &record );
+        if ( decodedSize == 0 )
+        {
+            return false;
+        }
+        records.push_back( record );
+        offset += decodedSize;
+    }
+    return true;
+}
+
+#endif // POSE_CODEC_H
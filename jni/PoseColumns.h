@@ -0,0 +1,524 @@
+#ifndef POSE_COLUMNS_H
+#define POSE_COLUMNS_H
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <vector>
+
+#include "PoseRecorder.h"
+
+// ================================================================================================
+// Columnar recording file (<pathPrefix>.ovrposec, version 1), for analysis and seeking: the records
+// are split in chunks of up to ChunkCapacity records and every chunk stores each field of its records
+// as its own array (a column: all the orientation x, then all the orientation y...), each one aligned
+// to a cache line. A footer index after the last chunk has, per chunk, where it and its columns are and
+// the min/max pose time of its records, so a time window is found with a binary search on the index
+// and reading one field only touches that field. The file is read memory-mapped and used as it is:
+// the columns are plain arrays of the file (native byte order, little endian on every supported
+// device), nothing is parsed or copied. Opening only checks the header and the index, each chunk is
+// checked when it is read (see PoseColumnsReader::isChunkValid).
+// ================================================================================================
+#define POSE_COLUMNS_MAGIC "OVRPOSC"
+#define POSE_COLUMNS_VERSION 1
+#define POSE_COLUMNS_FILE_EXTENSION ".ovrposec"
+#define POSE_COLUMNS_ALIGNMENT 64
+#define POSE_COLUMNS_DEFAULT_CHUNK_CAPACITY 4096
+
+typedef enum
+{
+    POSE_COLUMN_MONOTONIC_TIME,		// long long, nanoseconds
+    POSE_COLUMN_POSE_TIME,			// double, seconds (the min/max time of the chunks)
+    POSE_COLUMN_PREDICTION,			// double, seconds
+    POSE_COLUMN_ORIENTATION_X,		// float
+    POSE_COLUMN_ORIENTATION_Y,
+    POSE_COLUMN_ORIENTATION_Z,
+    POSE_COLUMN_ORIENTATION_W,
+    POSE_COLUMN_POSITION_X,			// float
+    POSE_COLUMN_POSITION_Y,
+    POSE_COLUMN_POSITION_Z,
+    POSE_COLUMN_ANGULAR_VELOCITY_X,	// float
+    POSE_COLUMN_ANGULAR_VELOCITY_Y,
+    POSE_COLUMN_ANGULAR_VELOCITY_Z,
+    POSE_COLUMN_LINEAR_VELOCITY_X,	// float
+    POSE_COLUMN_LINEAR_VELOCITY_Y,
+    POSE_COLUMN_LINEAR_VELOCITY_Z,
+    POSE_COLUMN_ANGULAR_ACCELERATION_X,	// float
+    POSE_COLUMN_ANGULAR_ACCELERATION_Y,
+    POSE_COLUMN_ANGULAR_ACCELERATION_Z,
+    POSE_COLUMN_LINEAR_ACCELERATION_X,	// float
+    POSE_COLUMN_LINEAR_ACCELERATION_Y,
+    POSE_COLUMN_LINEAR_ACCELERATION_Z,
+    POSE_COLUMN_TRACKING_STATUS,	// unsigned int
+    POSE_COLUMN_FLAGS,				// unsigned int
+    POSE_COLUMN_SEQUENCE,			// unsigned int
+    POSE_COLUMN_COUNT
+} ovrPoseColumn;
+
+typedef struct
+{
+    char			Magic[8];
+    unsigned int	Version;
+    unsigned int	HeaderSize;
+    unsigned int	ColumnCount;
+    unsigned int	ChunkCapacity;
+    unsigned int	ChunkCount;
+    unsigned int	RecordCount;
+    // From the start of the file.
+    long long		FooterOffset;
+    double			MinTime;
+    double			MaxTime;
+    unsigned int	Reserved[2];
+} ovrPoseColumnsHeader;
+
+// The footer has one per chunk, in time order.
+typedef struct
+{
+    // From the start of the file.
+    long long		Offset;
+    unsigned int	RecordCount;
+    unsigned int	Reserved;
+    // Of the pose times of the records.
+    double			MinTime;
+    double			MaxTime;
+    // From Offset.
+    unsigned int	ColumnOffsets[POSE_COLUMN_COUNT];
+    unsigned int	Padding;
+} ovrPoseColumnsChunk;
+
+static_assert(sizeof(ovrPoseColumnsHeader) == 64, "The pose columns header must be 64 bytes");
+static_assert(sizeof(ovrPoseColumnsChunk) % 8 == 0, "The pose columns chunks must keep the footer aligned");
+
+static inline size_t ovrPoseColumns_ElementSize( const int column )
+{
+    return column <= POSE_COLUMN_PREDICTION ? 8 : 4;
+}
+
+static inline size_t ovrPoseColumns_Align( const size_t offset )
+{
+    return ( offset + POSE_COLUMNS_ALIGNMENT - 1 ) & ~(size_t)( POSE_COLUMNS_ALIGNMENT - 1 );
+}
+
+// Where the value of a float column (POSE_COLUMN_ORIENTATION_X to POSE_COLUMN_LINEAR_ACCELERATION_Z) is in ovrPoseRecord.
+static inline size_t ovrPoseColumns_FloatFieldOffset( const int column )
+{
+    static const size_t OFFSETS[POSE_COLUMN_LINEAR_ACCELERATION_Z - POSE_COLUMN_ORIENTATION_X + 1] =
+    {
+        offsetof( ovrPoseRecord, Orientation ), offsetof( ovrPoseRecord, Orientation ) + sizeof( float ),
+        offsetof( ovrPoseRecord, Orientation ) + 2 * sizeof( float ), offsetof( ovrPoseRecord, Orientation ) + 3 * sizeof( float ),
+        offsetof( ovrPoseRecord, Position ), offsetof( ovrPoseRecord, Position ) + sizeof( float ), offsetof( ovrPoseRecord, Position ) + 2 * sizeof( float ),
+        offsetof( ovrPoseRecord, AngularVelocity ), offsetof( ovrPoseRecord, AngularVelocity ) + sizeof( float ), offsetof( ovrPoseRecord, AngularVelocity ) + 2 * sizeof( float ),
+        offsetof( ovrPoseRecord, LinearVelocity ), offsetof( ovrPoseRecord, LinearVelocity ) + sizeof( float ), offsetof( ovrPoseRecord, LinearVelocity ) + 2 * sizeof( float ),
+        offsetof( ovrPoseRecord, AngularAcceleration ), offsetof( ovrPoseRecord, AngularAcceleration ) + sizeof( float ), offsetof( ovrPoseRecord, AngularAcceleration ) + 2 * sizeof( float ),
+        offsetof( ovrPoseRecord, LinearAcceleration ), offsetof( ovrPoseRecord, LinearAcceleration ) + sizeof( float ), offsetof( ovrPoseRecord, LinearAcceleration ) + 2 * sizeof( float )
+    };
+    return OFFSETS[column - POSE_COLUMN_ORIENTATION_X];
+}
+
+// Writes the records (in time order) in chunks of chunkCapacity. Returns the size of the file, 0 if it could
+// not be written.
+static inline size_t ovrPoseColumns_WriteFile( const char * path, const ovrPoseRecord * records, const int count, int chunkCapacity )
+{
+    if ( chunkCapacity <= 0 )
+    {
+        chunkCapacity = POSE_COLUMNS_DEFAULT_CHUNK_CAPACITY;
+    }
+    FILE * file = fopen( path, "wb" );
+    if ( file == NULL )
+    {
+        return 0;
+    }
+    ovrPoseColumnsHeader header;
+    memset( &header, 0, sizeof( header ) );
+    memcpy( header.Magic, POSE_COLUMNS_MAGIC, sizeof( POSE_COLUMNS_MAGIC ) );
+    header.Version = POSE_COLUMNS_VERSION;
+    header.HeaderSize = sizeof( ovrPoseColumnsHeader );
+    header.ColumnCount = POSE_COLUMN_COUNT;
+    header.ChunkCapacity = (unsigned int)chunkCapacity;
+    header.ChunkCount = (unsigned int)( ( count + chunkCapacity - 1 ) / chunkCapacity );
+    header.RecordCount = (unsigned int)count;
+    header.MinTime = count > 0 ? records[0].PoseTimeInSeconds : 0.0;
+    header.MaxTime = count > 0 ? records[count - 1].PoseTimeInSeconds : 0.0;
+    bool written = fwrite( &header, sizeof( header ), 1, file ) == 1;
+    size_t size = sizeof( header );
+
+    std::vector<ovrPoseColumnsChunk> chunks( header.ChunkCount );
+    std::vector<unsigned char> buffer;
+    for ( unsigned int c = 0; c < header.ChunkCount && written; c++ )
+    {
+        const ovrPoseRecord * chunkRecords = records + (size_t)c * chunkCapacity;
+        const unsigned int chunkCount = c + 1 < header.ChunkCount ? (unsigned int)chunkCapacity : (unsigned int)( count - (int)c * chunkCapacity );
+        ovrPoseColumnsChunk & chunk = chunks[c];
+        memset( &chunk, 0, sizeof( chunk ) );
+        chunk.Offset = (long long)ovrPoseColumns_Align( size );
+        chunk.RecordCount = chunkCount;
+        chunk.MinTime = chunkRecords[0].PoseTimeInSeconds;
+        chunk.MaxTime = chunkRecords[0].PoseTimeInSeconds;
+        size_t chunkSize = 0;
+        for ( int column = 0; column < POSE_COLUMN_COUNT; column++ )
+        {
+            chunk.ColumnOffsets[column] = (unsigned int)chunkSize;
+            chunkSize = ovrPoseColumns_Align( chunkSize + chunkCount * ovrPoseColumns_ElementSize( column ) );
+        }
+        // The padding before the chunk, then the chunk
+        const size_t padding = (size_t)chunk.Offset - size;
+        buffer.assign( padding + chunkSize, 0 );
+        unsigned char * base = &buffer[padding];
+        for ( unsigned int i = 0; i < chunkCount; i++ )
+        {
+            const ovrPoseRecord & record = chunkRecords[i];
+            chunk.MinTime = record.PoseTimeInSeconds < chunk.MinTime ? record.PoseTimeInSeconds : chunk.MinTime;
+            chunk.MaxTime = record.PoseTimeInSeconds > chunk.MaxTime ? record.PoseTimeInSeconds : chunk.MaxTime;
+            ( (long long *)( base + chunk.ColumnOffsets[POSE_COLUMN_MONOTONIC_TIME] ) )[i] = record.MonotonicTimeInNanoseconds;
+            ( (double *)( base + chunk.ColumnOffsets[POSE_COLUMN_POSE_TIME] ) )[i] = record.PoseTimeInSeconds;
+            ( (double *)( base + chunk.ColumnOffsets[POSE_COLUMN_PREDICTION] ) )[i] = record.PredictionInSeconds;
+            for ( int column = POSE_COLUMN_ORIENTATION_X; column <= POSE_COLUMN_LINEAR_ACCELERATION_Z; column++ )
+            {
+                ( (float *)( base + chunk.ColumnOffsets[column] ) )[i] = *(const float *)( (const char *)&record + ovrPoseColumns_FloatFieldOffset( column ) );
+            }
+            ( (unsigned int *)( base + chunk.ColumnOffsets[POSE_COLUMN_TRACKING_STATUS] ) )[i] = record.TrackingStatus;
+            ( (unsigned int *)( base + chunk.ColumnOffsets[POSE_COLUMN_FLAGS] ) )[i] = record.Flags;
+            ( (unsigned int *)( base + chunk.ColumnOffsets[POSE_COLUMN_SEQUENCE] ) )[i] = record.Sequence;
+        }
+        written = fwrite( &buffer[0], 1, buffer.size(), file ) == buffer.size();
+        size += buffer.size();
+    }
+
+    // The footer, then the header again with its offset
+    header.FooterOffset = (long long)size;
+    if ( written && !chunks.empty() )
+    {
+        written = fwrite( &chunks[0], sizeof( ovrPoseColumnsChunk ), chunks.size(), file ) == chunks.size();
+        size += chunks.size() * sizeof( ovrPoseColumnsChunk );
+    }
+    written = written && fseek( file, 0, SEEK_SET ) == 0 && fwrite( &header, sizeof( header ), 1, file ) == 1;
+    written = fclose( file ) == 0 && written;
+    if ( !written )
+    {
+        remove( path );
+        return 0;
+    }
+    return size;
+}
+
+// ================================================================================================
+// PoseColumnsReader
+// Maps a columnar recording file and hands out its columns as they are in the file. Any number of
+// threads can read an open reader. The columns of a chunk must only be used if isChunkValid.
+// ================================================================================================
+class PoseColumnsReader
+{
+private:
+    void* mapping;
+    size_t mappingSize;
+    const ovrPoseColumnsHeader* header;
+    const ovrPoseColumnsChunk* chunks;
+
+    PoseColumnsReader(const PoseColumnsReader&);
+    PoseColumnsReader& operator=(const PoseColumnsReader&);
+
+public:
+    PoseColumnsReader(): mapping(NULL), mappingSize(0), header(NULL), chunks(NULL)
+    {
+    }
+
+    ~PoseColumnsReader()
+    {
+        close();
+    }
+
+    // Returns false if the file could not be mapped or is not valid.
+    bool open(const char* path)
+    {
+        close();
+        const int fd = ::open(path, O_RDONLY);
+        if (fd < 0)
+        {
+            return false;
+        }
+        struct stat fileStat;
+        if (fstat(fd, &fileStat) != 0 || (size_t)fileStat.st_size < sizeof(ovrPoseColumnsHeader))
+        {
+            ::close(fd);
+            return false;
+        }
+        mappingSize = (size_t)fileStat.st_size;
+        mapping = mmap(NULL, mappingSize, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED)
+        {
+            mapping = NULL;
+            return false;
+        }
+        header = (const ovrPoseColumnsHeader*)mapping;
+        if (memcmp(header->Magic, POSE_COLUMNS_MAGIC, sizeof(POSE_COLUMNS_MAGIC)) != 0 || header->Version != POSE_COLUMNS_VERSION ||
+            header->ColumnCount != POSE_COLUMN_COUNT || header->FooterOffset < (long long)sizeof(ovrPoseColumnsHeader) ||
+            (size_t)header->FooterOffset + (size_t)header->ChunkCount * sizeof(ovrPoseColumnsChunk) > mappingSize)
+        {
+            close();
+            return false;
+        }
+        chunks = (const ovrPoseColumnsChunk*)((const char*)mapping + header->FooterOffset);
+        return true;
+    }
+
+    void close()
+    {
+        if (mapping != NULL)
+        {
+            munmap(mapping, mappingSize);
+        }
+        mapping = NULL;
+        mappingSize = 0;
+        header = NULL;
+        chunks = NULL;
+    }
+
+    inline bool isOpen() const
+    {
+        return mapping != NULL;
+    }
+
+    inline const ovrPoseColumnsHeader& getHeader() const
+    {
+        return *header;
+    }
+
+    inline int getChunkCount() const
+    {
+        return (int)header->ChunkCount;
+    }
+
+    inline const ovrPoseColumnsChunk& getChunk(const int chunk) const
+    {
+        return chunks[chunk];
+    }
+
+    // Whether all the columns of the chunk are within the file (before the index).
+    bool isChunkValid(const int chunk) const
+    {
+        // Its 8 byte columns alone must fit before the index, which also keeps the sizes below from overflowing
+        if (chunks[chunk].RecordCount > (size_t)header->FooterOffset / 8)
+        {
+            return false;
+        }
+        for (int column = 0; column < POSE_COLUMN_COUNT; column++)
+        {
+            if (chunks[chunk].Offset < 0 || (size_t)chunks[chunk].Offset + chunks[chunk].ColumnOffsets[column] + (size_t)chunks[chunk].RecordCount * ovrPoseColumns_ElementSize(column) > (size_t)header->FooterOffset)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // The column of the chunk as it is in the file: getChunk(chunk).RecordCount values of T (see ovrPoseColumn).
+    template<typename T>
+    inline const T* getColumn(const int chunk, const int column) const
+    {
+        return (const T*)((const char*)mapping + chunks[chunk].Offset + chunks[chunk].ColumnOffsets[column]);
+    }
+
+    // The chunks with records in [startTime, endTime]: returns how many, from firstChunk.
+    int findChunks(const double startTime, const double endTime, int* firstChunk) const
+    {
+        // The first chunk that ends at or after startTime
+        int low = 0;
+        int high = (int)header->ChunkCount;
+        while (low < high)
+        {
+            const int middle = (low + high) / 2;
+            if (chunks[middle].MaxTime < startTime)
+            {
+                low = middle + 1;
+            }
+            else
+            {
+                high = middle;
+            }
+        }
+        *firstChunk = low;
+        int last = low;
+        while (last < (int)header->ChunkCount && chunks[last].MinTime <= endTime)
+        {
+            last++;
+        }
+        return last - low;
+    }
+
+    // The index in the chunk of its first record at or after the time (RecordCount if none).
+    unsigned int findRecord(const int chunk, const double time) const
+    {
+        const double* times = getColumn<double>(chunk, POSE_COLUMN_POSE_TIME);
+        unsigned int low = 0;
+        unsigned int high = chunks[chunk].RecordCount;
+        while (low < high)
+        {
+            const unsigned int middle = (low + high) / 2;
+            if (times[middle] < time)
+            {
+                low = middle + 1;
+            }
+            else
+            {
+                high = middle;
+            }
+        }
+        return low;
+    }
+
+    // Appends the records of the chunk as rows. Returns false if the chunk is not valid.
+    bool readRecords(const int chunk, std::vector<ovrPoseRecord>& records) const
+    {
+        if (!isChunkValid(chunk))
+        {
+            return false;
+        }
+        const unsigned int count = chunks[chunk].RecordCount;
+        const size_t first = records.size();
+        records.resize(first + count);
+        const long long* monotonicTimes = getColumn<long long>(chunk, POSE_COLUMN_MONOTONIC_TIME);
+        const double* poseTimes = getColumn<double>(chunk, POSE_COLUMN_POSE_TIME);
+        const double* predictions = getColumn<double>(chunk, POSE_COLUMN_PREDICTION);
+        const unsigned int* status = getColumn<unsigned int>(chunk, POSE_COLUMN_TRACKING_STATUS);
+        const unsigned int* flags = getColumn<unsigned int>(chunk, POSE_COLUMN_FLAGS);
+        const unsigned int* sequences = getColumn<unsigned int>(chunk, POSE_COLUMN_SEQUENCE);
+        for (unsigned int i = 0; i < count; i++)
+        {
+            ovrPoseRecord& record = records[first + i];
+            memset(&record, 0, sizeof(record));
+            record.MonotonicTimeInNanoseconds = monotonicTimes[i];
+            record.PoseTimeInSeconds = poseTimes[i];
+            record.PredictionInSeconds = predictions[i];
+            for (int column = POSE_COLUMN_ORIENTATION_X; column <= POSE_COLUMN_LINEAR_ACCELERATION_Z; column++)
+            {
+                *(float*)((char*)&record + ovrPoseColumns_FloatFieldOffset(column)) = getColumn<float>(chunk, column)[i];
+            }
+            record.TrackingStatus = status[i];
+            record.Flags = flags[i];
+            record.Sequence = sequences[i];
+        }
+        return true;
+    }
+};
+
+// ================================================================================================
+// PoseColumnsReaderCache
+// Keeps the last file read mapped, so reading several windows or columns of the same file maps it
+// and checks its index only once. The file is opened again if it changed since (another inode, size
+// or modification time), and writers invalidate it first so the mapping does not outlive the file.
+// ================================================================================================
+class PoseColumnsReaderCache
+{
+public:
+    static const int PATH_SIZE = PoseRecorder::PATH_PREFIX_SIZE + 32;
+
+private:
+    pthread_mutex_t mutex;
+    PoseColumnsReader reader;
+    char path[PATH_SIZE];
+    struct stat fileStat;
+
+    PoseColumnsReaderCache()
+    {
+        pthread_mutex_init(&mutex, NULL);
+        path[0] = '\0';
+        memset(&fileStat, 0, sizeof(fileStat));
+    }
+
+    PoseColumnsReaderCache(const PoseColumnsReaderCache&);
+    PoseColumnsReaderCache& operator=(const PoseColumnsReaderCache&);
+
+public:
+    static PoseColumnsReaderCache& get()
+    {
+        static PoseColumnsReaderCache cache;
+        return cache;
+    }
+
+    // Locks the cache and returns its reader with the file open, or NULL (without keeping the cache locked)
+    // if the file could not be opened. unlock once done with the reader.
+    const PoseColumnsReader* lock(const char* filePath)
+    {
+        pthread_mutex_lock(&mutex);
+        struct stat currentStat;
+        if (stat(filePath, &currentStat) != 0)
+        {
+            pthread_mutex_unlock(&mutex);
+            return NULL;
+        }
+        if (!reader.isOpen() || strcmp(path, filePath) != 0 || currentStat.st_dev != fileStat.st_dev || currentStat.st_ino != fileStat.st_ino ||
+            currentStat.st_size != fileStat.st_size || currentStat.st_mtime != fileStat.st_mtime)
+        {
+            path[0] = '\0';
+            if (!reader.open(filePath))
+            {
+                pthread_mutex_unlock(&mutex);
+                return NULL;
+            }
+            snprintf(path, PATH_SIZE, "%s", filePath);
+            fileStat = currentStat;
+        }
+        return &reader;
+    }
+
+    void unlock()
+    {
+        pthread_mutex_unlock(&mutex);
+    }
+
+    // Before the file is written: unmaps it if it is the one cached.
+    void invalidate(const char* filePath)
+    {
+        pthread_mutex_lock(&mutex);
+        if (strcmp(path, filePath) == 0)
+        {
+            reader.close();
+            path[0] = '\0';
+        }
+        pthread_mutex_unlock(&mutex);
+    }
+};
+
+// Appends every record of the file. Returns false if it could not be read.
+static inline bool ovrPoseColumns_ReadFile( const char * path, std::vector<ovrPoseRecord> & records )
+{
+    PoseColumnsReader reader;
+    if ( !reader.open( path ) )
+    {
+        return false;
+    }
+    // The record count of the header is only trusted if the chunks within the file hold that many records
+    size_t count = 0;
+    for ( int chunk = 0; chunk < reader.getChunkCount(); chunk++ )
+    {
+        if ( !reader.isChunkValid( chunk ) )
+        {
+            return false;
+        }
+        count += reader.getChunk( chunk ).RecordCount;
+    }
+    if ( count != reader.getHeader().RecordCount )
+    {
+        return false;
+    }
+    const size_t first = records.size();
+    records.reserve( first + count );
+    for ( int chunk = 0; chunk < reader.getChunkCount(); chunk++ )
+    {
+        if ( !reader.readRecords( chunk, records ) )
+        {
+            records.resize( first );
+            return false;
+        }
+    }
+    return true;
+}
+
+#endif // POSE_COLUMNS_H
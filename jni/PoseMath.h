@@ -0,0 +1,85 @@
+#ifndef POSE_MATH_H
+#define POSE_MATH_H
+
+#include <math.h>
+
+#include "VrApi_Types.h"
+
+// ================================================================================================
+// Pure, stateless, inlined quaternion helpers in the same spirit as the ones in VrApi_Helpers.h
+// ================================================================================================
+static inline float ovrQuatf_Dot( const ovrQuatf * a, const ovrQuatf * b )
+{
+    return a->x * b->x + a->y * b->y + a->z * b->z + a->w * b->w;
+}
+
+// Smallest angle (in radians) of the rotation that takes orientation a to orientation b.
+static inline float ovrQuatf_AngleBetween( const ovrQuatf * a, const ovrQuatf * b )
+{
+    float d = fabsf( ovrQuatf_Dot( a, b ) );
+    if ( d > 1.0f )
+    {
+        d = 1.0f;
+    }
+    return 2.0f * acosf( d );
+}
+
+static inline ovrQuatf ovrQuatf_Normalize( const ovrQuatf * q )
+{
+    const float lengthSquared = ovrQuatf_Dot( q, q );
+    const float scale = ( lengthSquared > 0.0f ) ? 1.0f / sqrtf( lengthSquared ) : 0.0f;
+    ovrQuatf out;
+    out.x = q->x * scale;
+    out.y = q->y * scale;
+    out.z = q->z * scale;
+    out.w = q->w * scale;
+    return out;
+}
+
+// Normalized linear interpolation along the shortest arc. Good enough for the small
+// angles between consecutive tracking samples.
+static inline ovrQuatf ovrQuatf_Nlerp( const ovrQuatf * a, const ovrQuatf * b, const float t )
+{
+    const float s = ( ovrQuatf_Dot( a, b ) < 0.0f ) ? -t : t;
+    ovrQuatf out;
+    out.x = a->x * ( 1.0f - t ) + b->x * s;
+    out.y = a->y * ( 1.0f - t ) + b->y * s;
+    out.z = a->z * ( 1.0f - t ) + b->z * s;
+    out.w = a->w * ( 1.0f - t ) + b->w * s;
+    return ovrQuatf_Normalize( &out );
+}
+
+static inline ovrQuatf ovrQuatf_Multiply( const ovrQuatf * a, const ovrQuatf * b )
+{
+    ovrQuatf out;
+    out.x = a->w * b->x + a->x * b->w + a->y * b->z - a->z * b->y;
+    out.y = a->w * b->y - a->x * b->z + a->y * b->w + a->z * b->x;
+    out.z = a->w * b->z + a->x * b->y - a->y * b->x + a->z * b->w;
+    out.w = a->w * b->w - a->x * b->x - a->y * b->y - a->z * b->z;
+    return out;
+}
+
+// Rotation of |v| radians around the axis v / |v| (exponential map of a rotation vector).
+static inline ovrQuatf ovrQuatf_CreateFromRotationVector( const float x, const float y, const float z )
+{
+    const float angleSquared = x * x + y * y + z * z;
+    ovrQuatf out;
+    if ( angleSquared < 1e-12f )
+    {
+        // First order approximation, avoids the division by a vanishing angle.
+        out.x = 0.5f * x;
+        out.y = 0.5f * y;
+        out.z = 0.5f * z;
+        out.w = 1.0f;
+        return ovrQuatf_Normalize( &out );
+    }
+    const float angle = sqrtf( angleSquared );
+    const float s = sinf( 0.5f * angle ) / angle;
+    out.x = x * s;
+    out.y = y * s;
+    out.z = z * s;
+    out.w = cosf( 0.5f * angle );
+    return out;
+}
+
+#endif // POSE_MATH_H
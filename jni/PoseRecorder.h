@@ -0,0 +1,377 @@
+#ifndef POSE_RECORDER_H
+#define POSE_RECORDER_H
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+
+#include <atomic>
+
+#include "Clock.h"
+#include "WorkerPool.h"
+
+// ================================================================================================
+// Recording file format (version 1). Every file is an ovrPoseRecordingHeader followed by Capacity
+// fixed-size ovrPoseRecord slots (native byte order, little endian on every supported device).
+// RecordCount is written when the file is closed: a file that was not closed (the process died) has
+// RecordCount 0 and its records are the slots up to the first one with Sequence 0.
+// ================================================================================================
+#define POSE_RECORDING_MAGIC "OVRPOSE"
+#define POSE_RECORDING_VERSION 1
+#define POSE_RECORDING_FILE_EXTENSION ".ovrpose"
+
+struct ovrPoseRecordingHeader
+{
+    char Magic[8];
+    unsigned int Version;
+    unsigned int HeaderSize;
+    unsigned int RecordSize;
+    unsigned int Capacity;
+    unsigned int RecordCount;
+    // The position of the file in the recording (0 for the first one).
+    unsigned int FileIndex;
+    // GetTimeInNanoseconds when the file was created.
+    long long CreationTimeInNanoseconds;
+    unsigned int Reserved[6];
+};
+
+enum ovrPoseRecordFlags
+{
+    POSE_RECORD_FLAG_MOUNTED = 1,
+    POSE_RECORD_FLAG_DOCKED = 2
+};
+
+struct ovrPoseRecord
+{
+    // GetTimeInNanoseconds when the pose was sampled.
+    long long MonotonicTimeInNanoseconds;
+    // ovrTracking.HeadPose.TimeInSeconds and PredictionInSeconds.
+    double PoseTimeInSeconds;
+    double PredictionInSeconds;
+    float Orientation[4];
+    float Position[3];
+    float AngularVelocity[3];
+    float LinearVelocity[3];
+    float AngularAcceleration[3];
+    float LinearAcceleration[3];
+    // ovrTracking.Status.
+    unsigned int TrackingStatus;
+    // ovrPoseRecordFlags.
+    unsigned int Flags;
+    // The position of the record in the whole recording, from 1 (0 marks a slot never written).
+    unsigned int Sequence;
+    unsigned int Reserved[4];
+};
+
+static_assert(sizeof(ovrPoseRecordingHeader) == 64, "The pose recording header must be 64 bytes");
+static_assert(sizeof(ovrPoseRecord) == 128, "The pose records must be 128 bytes");
+
+// ================================================================================================
+// PoseRecorder
+// Appends the sampled poses to pre-sized memory-mapped files (<pathPrefix>.<file index>.ovrpose). The
+// producer (the sampler thread) only copies each record into the current mapping: files are created,
+// sized, mapped and populated ahead of time by a worker, and closed (record count written, unmapped,
+// trimmed) by a worker once full, so the hot path makes no syscall but the wakeup of a worker once
+// per file. The last maxFiles completed files are kept (the older ones are deleted) besides the one being
+// written and the next one, and at most those two are mapped at a time, so both the disk and the memory
+// used are bounded.
+// If the producer fills a file before the next one is ready the records are dropped (and counted)
+// rather than waiting.
+// start and stop are only called while the producer is not recording (the session stops the sampler
+// around them), the statistics can be read from any thread.
+// ================================================================================================
+class PoseRecorder
+{
+public:
+    static const int PATH_PREFIX_SIZE = 256;
+    static const int MIN_FILE_SIZE = 64 * 1024;
+    // Records written, records dropped (no file ready), files completed, MB written, files that could not be
+    // created, recording (1 or 0)
+    static const int STATISTICS_FLOAT_COUNT = 6;
+
+private:
+    struct File
+    {
+        ovrPoseRecordingHeader* header;
+        ovrPoseRecord* records;
+        unsigned int index;
+        char path[PATH_PREFIX_SIZE + 32];
+    };
+
+    WorkerPool* workers;
+    char pathPrefix[PATH_PREFIX_SIZE];
+    size_t fileSize;
+    unsigned int capacity;
+    int maxFiles;
+    std::atomic<bool> recording;
+    // Only used by the producer.
+    File current;
+    unsigned int currentCount;
+    unsigned int sequence;
+    // Handed from the producer to the worker: set before the task is submitted, not touched by the producer
+    // again until nextReady.
+    File full;
+    unsigned int fullCount;
+    unsigned int nextFileIndex;
+    // Written by the worker, taken by the producer once nextReady.
+    File next;
+    std::atomic<bool> nextReady;
+    // A rotation task is submitted and not done yet.
+    std::atomic<bool> rotating;
+    std::atomic<unsigned int> writtenCount;
+    std::atomic<unsigned int> droppedCount;
+    std::atomic<unsigned int> completedFileCount;
+    std::atomic<unsigned int> failedFileCount;
+    std::atomic<long long> writtenBytes;
+
+    static void clearFile(File& file)
+    {
+        file.header = NULL;
+        file.records = NULL;
+        file.index = 0;
+        file.path[0] = 0;
+    }
+
+    bool createFile(File& file)
+    {
+        file.index = nextFileIndex++;
+        snprintf(file.path, sizeof(file.path), "%s.%u%s", pathPrefix, file.index, POSE_RECORDING_FILE_EXTENSION);
+        const int fd = open(file.path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0)
+        {
+            failedFileCount.fetch_add(1, std::memory_order_relaxed);
+            clearFile(file);
+            return false;
+        }
+        if (ftruncate(fd, (off_t)fileSize) != 0)
+        {
+            close(fd);
+            unlink(file.path);
+            failedFileCount.fetch_add(1, std::memory_order_relaxed);
+            clearFile(file);
+            return false;
+        }
+        void* mapping = mmap(NULL, fileSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, 0);
+        close(fd);
+        if (mapping == MAP_FAILED)
+        {
+            unlink(file.path);
+            failedFileCount.fetch_add(1, std::memory_order_relaxed);
+            clearFile(file);
+            return false;
+        }
+        // MAP_POPULATE only read-faults a shared mapping: writing every page here makes the file system allocate
+        // the blocks (posix_fallocate needs android-21) so the producer never takes a fault.
+        memset(mapping, 0, fileSize);
+        file.header = (ovrPoseRecordingHeader*)mapping;
+        file.records = (ovrPoseRecord*)((char*)mapping + sizeof(ovrPoseRecordingHeader));
+        memcpy(file.header->Magic, POSE_RECORDING_MAGIC, sizeof(POSE_RECORDING_MAGIC));
+        file.header->Version = POSE_RECORDING_VERSION;
+        file.header->HeaderSize = sizeof(ovrPoseRecordingHeader);
+        file.header->RecordSize = sizeof(ovrPoseRecord);
+        file.header->Capacity = capacity;
+        file.header->FileIndex = file.index;
+        file.header->CreationTimeInNanoseconds = GetTimeInNanoseconds();
+        return true;
+    }
+
+    // Writes the record count, unmaps the file and trims it to the records written (or deletes it if empty). The
+    // completed file maxFiles before it is deleted.
+    void closeFile(File& file, const unsigned int recordCount)
+    {
+        if (file.header == NULL)
+        {
+            return;
+        }
+        file.header->RecordCount = recordCount;
+        munmap(file.header, fileSize);
+        if (recordCount == 0)
+        {
+            unlink(file.path);
+        }
+        else
+        {
+            if (recordCount < capacity)
+            {
+                truncate(file.path, (off_t)(sizeof(ovrPoseRecordingHeader) + (size_t)recordCount * sizeof(ovrPoseRecord)));
+            }
+            completedFileCount.fetch_add(1, std::memory_order_relaxed);
+            if (maxFiles > 0 && file.index >= (unsigned int)maxFiles)
+            {
+                char oldPath[sizeof(file.path)];
+                snprintf(oldPath, sizeof(oldPath), "%s.%u%s", pathPrefix, file.index - maxFiles, POSE_RECORDING_FILE_EXTENSION);
+                unlink(oldPath);
+            }
+        }
+        clearFile(file);
+    }
+
+    void rotate()
+    {
+        closeFile(full, fullCount);
+        if (createFile(next))
+        {
+            nextReady.store(true, std::memory_order_release);
+        }
+        rotating.store(false, std::memory_order_release);
+    }
+
+    static void rotateStatic(const ovrWorkerTask* task)
+    {
+        ((PoseRecorder*)task->Context)->rotate();
+    }
+
+    // From the producer. Returns false if the task could not be queued (it is tried again on the next record).
+    bool submitRotation()
+    {
+        rotating.store(true, std::memory_order_relaxed);
+        ovrWorkerTask task;
+        task.Function = rotateStatic;
+        task.Context = this;
+        task.Text[0] = 0;
+        if (!workers->submit(task))
+        {
+            rotating.store(false, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+public:
+    PoseRecorder(): workers(NULL), fileSize(0), capacity(0), maxFiles(0), recording(false), currentCount(0), sequence(0), fullCount(0), nextFileIndex(0), nextReady(false), rotating(false), writtenCount(0), droppedCount(0), completedFileCount(0), failedFileCount(0), writtenBytes(0)
+    {
+        pathPrefix[0] = 0;
+        clearFile(current);
+        clearFile(full);
+        clearFile(next);
+    }
+
+    ~PoseRecorder()
+    {
+        stop();
+    }
+
+    inline bool isRecording() const
+    {
+        return recording.load(std::memory_order_relaxed);
+    }
+
+    // Creates the first file (here) and the next one (on a worker). Returns false if the first file could not be
+    // created. maxFileCount 0 keeps every file.
+    bool start(WorkerPool* workerPool, const char* prefix, int fileSizeInBytes, int maxFileCount)
+    {
+        stop();
+        if (prefix == NULL || strlen(prefix) >= PATH_PREFIX_SIZE)
+        {
+            return false;
+        }
+        workers = workerPool;
+        strcpy(pathPrefix, prefix);
+        fileSize = fileSizeInBytes < MIN_FILE_SIZE ? MIN_FILE_SIZE : (size_t)fileSizeInBytes;
+        capacity = (unsigned int)((fileSize - sizeof(ovrPoseRecordingHeader)) / sizeof(ovrPoseRecord));
+        fileSize = sizeof(ovrPoseRecordingHeader) + (size_t)capacity * sizeof(ovrPoseRecord);
+        maxFiles = maxFileCount < 0 ? 0 : maxFileCount;
+        nextFileIndex = 0;
+        sequence = 0;
+        currentCount = 0;
+        writtenCount.store(0);
+        droppedCount.store(0);
+        completedFileCount.store(0);
+        failedFileCount.store(0);
+        writtenBytes.store(0);
+        if (!createFile(current))
+        {
+            return false;
+        }
+        fullCount = 0;
+        nextReady.store(false);
+        submitRotation();
+        recording.store(true, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Closes every file, waiting for the rotation in flight if any.
+    void stop()
+    {
+        if (!recording.load(std::memory_order_relaxed))
+        {
+            return;
+        }
+        recording.store(false, std::memory_order_relaxed);
+        while (rotating.load(std::memory_order_acquire))
+        {
+            usleep(1000);
+        }
+        // Still open if its rotation could not be queued
+        if (full.header != NULL)
+        {
+            closeFile(full, fullCount);
+            fullCount = 0;
+        }
+        closeFile(current, currentCount);
+        currentCount = 0;
+        if (nextReady.load(std::memory_order_acquire))
+        {
+            closeFile(next, 0);
+            nextReady.store(false, std::memory_order_relaxed);
+        }
+    }
+
+    // From the producer only, while recording. Returns false if the record was dropped.
+    inline bool record(const ovrTracking& tracking, const unsigned int flags, const long long timeInNanoseconds)
+    {
+        if (currentCount == capacity)
+        {
+            if (!nextReady.load(std::memory_order_acquire))
+            {
+                if (!rotating.load(std::memory_order_acquire))
+                {
+                    // The file could not be created (or the task queued): try again
+                    submitRotation();
+                }
+                droppedCount.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            full = current;
+            fullCount = currentCount;
+            current = next;
+            currentCount = 0;
+            nextReady.store(false, std::memory_order_relaxed);
+            submitRotation();
+        }
+        ovrPoseRecord& record = current.records[currentCount++];
+        record.MonotonicTimeInNanoseconds = timeInNanoseconds;
+        record.PoseTimeInSeconds = tracking.HeadPose.TimeInSeconds;
+        record.PredictionInSeconds = tracking.HeadPose.PredictionInSeconds;
+        const ovrPosef& pose = tracking.HeadPose.Pose;
+        record.Orientation[0] = pose.Orientation.x;
+        record.Orientation[1] = pose.Orientation.y;
+        record.Orientation[2] = pose.Orientation.z;
+        record.Orientation[3] = pose.Orientation.w;
+        memcpy(record.Position, &pose.Position, sizeof(record.Position));
+        memcpy(record.AngularVelocity, &tracking.HeadPose.AngularVelocity, sizeof(record.AngularVelocity));
+        memcpy(record.LinearVelocity, &tracking.HeadPose.LinearVelocity, sizeof(record.LinearVelocity));
+        memcpy(record.AngularAcceleration, &tracking.HeadPose.AngularAcceleration, sizeof(record.AngularAcceleration));
+        memcpy(record.LinearAcceleration, &tracking.HeadPose.LinearAcceleration, sizeof(record.LinearAcceleration));
+        record.TrackingStatus = tracking.Status;
+        record.Flags = flags;
+        record.Sequence = ++sequence;
+        writtenCount.store(writtenCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        writtenBytes.store(writtenBytes.load(std::memory_order_relaxed) + (long long)sizeof(ovrPoseRecord), std::memory_order_relaxed);
+        return true;
+    }
+
+    void getStatistics(float statistics[STATISTICS_FLOAT_COUNT]) const
+    {
+        statistics[0] = (float)writtenCount.load(std::memory_order_relaxed);
+        statistics[1] = (float)droppedCount.load(std::memory_order_relaxed);
+        statistics[2] = (float)completedFileCount.load(std::memory_order_relaxed);
+        statistics[3] = (float)((double)writtenBytes.load(std::memory_order_relaxed) / (1024.0 * 1024.0));
+        statistics[4] = (float)failedFileCount.load(std::memory_order_relaxed);
+        statistics[5] = recording.load(std::memory_order_relaxed) ? 1.0f : 0.0f;
+    }
+};
+
+#endif // POSE_RECORDER_H
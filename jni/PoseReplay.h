@@ -0,0 +1,419 @@
+#ifndef POSE_REPLAY_H
+#define POSE_REPLAY_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include <atomic>
+#include <vector>
+#include <algorithm>
+
+#include "PoseRecorder.h"
+#include "PoseCodec.h"
+#include "PoseColumns.h"
+#include "GuardedPointer.h"
+#include "SeqLock.h"
+
+// ================================================================================================
+// Reads a recording made by PoseRecorder: every <pathPrefix>.<index>.ovrpose file, in index order (the
+// first ones may have been deleted by the rotation). A file that was not closed is read up to its first
+// slot never written, and the files left by an older recording with the same prefix (their poses go
+// back in time) are ignored. Without any, the columnar <pathPrefix>.ovrposec file (see PoseColumns.h) or
+// else the compressed <pathPrefix>.ovrposez file (see PoseCodec.h) is read instead. Returns the number of files read (0 if none or if none is valid).
+// ================================================================================================
+static inline int ovrPoseRecording_Load( const char * pathPrefix, std::vector<ovrPoseRecord> & records )
+{
+    char directory[PoseRecorder::PATH_PREFIX_SIZE];
+    const char * slash = strrchr( pathPrefix, '/' );
+    const char * name = slash != NULL ? slash + 1 : pathPrefix;
+    const size_t directoryLength = slash != NULL ? (size_t)( slash - pathPrefix ) : 0;
+    const size_t nameLength = strlen( name );
+    if ( directoryLength >= sizeof( directory ) )
+    {
+        return 0;
+    }
+    if ( slash == NULL )
+    {
+        strcpy( directory, "." );
+    }
+    else if ( directoryLength == 0 )
+    {
+        strcpy( directory, "/" );
+    }
+    else
+    {
+        memcpy( directory, pathPrefix, directoryLength );
+        directory[directoryLength] = 0;
+    }
+
+    DIR * dir = opendir( directory );
+    if ( dir == NULL )
+    {
+        return 0;
+    }
+    std::vector<unsigned int> indices;
+    const size_t extensionLength = strlen( POSE_RECORDING_FILE_EXTENSION );
+    for ( struct dirent * entry = readdir( dir ); entry != NULL; entry = readdir( dir ) )
+    {
+        // <name>.<digits><extension>
+        const size_t entryLength = strlen( entry->d_name );
+        if ( entryLength <= nameLength + 1 + extensionLength || strncmp( entry->d_name, name, nameLength ) != 0 || entry->d_name[nameLength] != '.' ||
+             strcmp( entry->d_name + entryLength - extensionLength, POSE_RECORDING_FILE_EXTENSION ) != 0 )
+        {
+            continue;
+        }
+        char * end = NULL;
+        const unsigned long index = strtoul( entry->d_name + nameLength + 1, &end, 10 );
+        if ( end == entry->d_name + entryLength - extensionLength )
+        {
+            indices.push_back( (unsigned int)index );
+        }
+    }
+    closedir( dir );
+    std::sort( indices.begin(), indices.end() );
+
+    int fileCount = 0;
+    std::vector<ovrPoseRecord> fileRecords;
+    for ( size_t i = 0; i < indices.size(); i++ )
+    {
+        char path[PoseRecorder::PATH_PREFIX_SIZE + 32];
+        snprintf( path, sizeof( path ), "%s.%u%s", pathPrefix, indices[i], POSE_RECORDING_FILE_EXTENSION );
+        FILE * file = fopen( path, "rb" );
+        if ( file == NULL )
+        {
+            continue;
+        }
+        ovrPoseRecordingHeader header;
+        if ( fread( &header, sizeof( header ), 1, file ) != 1 || memcmp( header.Magic, POSE_RECORDING_MAGIC, sizeof( POSE_RECORDING_MAGIC ) ) != 0 ||
+             header.Version != POSE_RECORDING_VERSION || header.HeaderSize != sizeof( ovrPoseRecordingHeader ) || header.RecordSize != sizeof( ovrPoseRecord ) )
+        {
+            fclose( file );
+            continue;
+        }
+        // The header is not trusted with the allocation: no more slots than the file holds (fewer than the capacity
+        // once it was closed and trimmed)
+        struct stat fileStat;
+        if ( fstat( fileno( file ), &fileStat ) != 0 || (size_t)fileStat.st_size < sizeof( header ) )
+        {
+            fclose( file );
+            continue;
+        }
+        const size_t fileSlots = ( (size_t)fileStat.st_size - sizeof( header ) ) / sizeof( ovrPoseRecord );
+        const size_t slotCount = header.Capacity < fileSlots ? header.Capacity : fileSlots;
+        fileRecords.resize( slotCount );
+        const size_t readCount = slotCount > 0 ? fread( &fileRecords[0], sizeof( ovrPoseRecord ), slotCount, file ) : 0;
+        fclose( file );
+        size_t count = header.RecordCount != 0 && header.RecordCount <= readCount ? header.RecordCount : 0;
+        if ( header.RecordCount == 0 )
+        {
+            while ( count < readCount && fileRecords[count].Sequence != 0 )
+            {
+                count++;
+            }
+        }
+        if ( count == 0 || ( !records.empty() && fileRecords[0].PoseTimeInSeconds < records.back().PoseTimeInSeconds ) )
+        {
+            continue;
+        }
+        records.insert( records.end(), fileRecords.begin(), fileRecords.begin() + count );
+        fileCount++;
+    }
+    if ( fileCount == 0 )
+    {
+        char path[PoseRecorder::PATH_PREFIX_SIZE + 32];
+        snprintf( path, sizeof( path ), "%s%s", pathPrefix, POSE_COLUMNS_FILE_EXTENSION );
+        if ( ovrPoseColumns_ReadFile( path, records ) )
+        {
+            return 1;
+        }
+        snprintf( path, sizeof( path ), "%s%s", pathPrefix, POSE_CODEC_FILE_EXTENSION );
+        if ( ovrPoseCodec_ReadFile( path, records ) )
+        {
+            fileCount++;
+        }
+    }
+    return fileCount;
+}
+
+// ================================================================================================
+// PoseReplay
+// Replaces the live vrapi tracking with a recording (see PoseRecorder) so everything downstream (the
+// sampler, late latching, getData, the push delivery, the pose recorder itself) sees the recorded
+// motion. The recording is played along the pose times it was recorded with:
+// - at speed 1 in real time, at any other speed > 0 scaled (velocities and accelerations are scaled
+//   accordingly so the extrapolations made downstream stay consistent),
+// - at speed 0 as fast as possible: every stepping query (the sampler and getData) gets the next
+//   record, whatever the time, which makes a run deterministic (the same queries get the same poses).
+//   The other queries (the push delivery, the prediction accuracy) get the last record handed out
+//   so they don't move the playback.
+// The pose returned for a target time is the last record at or before the matching recording time (no
+// interpolation, so the recorded values are replayed as they are) and its time is mapped to the live
+// clock. When the end is reached the playback loops to the start or stays on the last record.
+// The recording is owned by the tracking thread (it publishes and retires it); the playback state is a
+// SeqLock, so any thread can play, seek and query without locks.
+// ================================================================================================
+struct ovrPoseRecording
+{
+    std::vector<ovrPoseRecord> records;
+    double startTime;
+    double duration;
+};
+
+class PoseReplay
+{
+public:
+    static const int STATISTICS_FLOAT_COUNT = 6;
+
+private:
+    struct Playback
+    {
+        // Live time and recording time that match (seconds).
+        double liveTime;
+        double recordingTime;
+        float speed;
+        bool playing;
+        bool loop;
+    };
+
+    GuardedPointer<ovrPoseRecording> recording;
+    SeqLock<Playback> playback;
+    // The next record at speed 0.
+    std::atomic<unsigned int> nextIndex;
+    std::atomic<unsigned int> lastIndex;
+    std::atomic<unsigned int> loops;
+    std::atomic<unsigned int> replayedCount;
+    std::atomic<bool> ended;
+
+    static size_t findRecord(const ovrPoseRecording& poseRecording, const double recordingTime)
+    {
+        // The last record at or before the time (the first one if before the start)
+        size_t low = 0;
+        size_t high = poseRecording.records.size();
+        while (high - low > 1)
+        {
+            const size_t middle = (low + high) / 2;
+            if (poseRecording.records[middle].PoseTimeInSeconds <= recordingTime)
+            {
+                low = middle;
+            }
+            else
+            {
+                high = middle;
+            }
+        }
+        return low;
+    }
+
+    static void setTracking(const ovrPoseRecord& record, const double timeInSeconds, const float speed, ovrTracking* tracking)
+    {
+        const float speedSquared = speed * speed;
+        tracking->Status = record.TrackingStatus;
+        tracking->HeadPose.Pose.Orientation.x = record.Orientation[0];
+        tracking->HeadPose.Pose.Orientation.y = record.Orientation[1];
+        tracking->HeadPose.Pose.Orientation.z = record.Orientation[2];
+        tracking->HeadPose.Pose.Orientation.w = record.Orientation[3];
+        tracking->HeadPose.Pose.Position.x = record.Position[0];
+        tracking->HeadPose.Pose.Position.y = record.Position[1];
+        tracking->HeadPose.Pose.Position.z = record.Position[2];
+        tracking->HeadPose.AngularVelocity.x = record.AngularVelocity[0] * speed;
+        tracking->HeadPose.AngularVelocity.y = record.AngularVelocity[1] * speed;
+        tracking->HeadPose.AngularVelocity.z = record.AngularVelocity[2] * speed;
+        tracking->HeadPose.LinearVelocity.x = record.LinearVelocity[0] * speed;
+        tracking->HeadPose.LinearVelocity.y = record.LinearVelocity[1] * speed;
+        tracking->HeadPose.LinearVelocity.z = record.LinearVelocity[2] * speed;
+        tracking->HeadPose.AngularAcceleration.x = record.AngularAcceleration[0] * speedSquared;
+        tracking->HeadPose.AngularAcceleration.y = record.AngularAcceleration[1] * speedSquared;
+        tracking->HeadPose.AngularAcceleration.z = record.AngularAcceleration[2] * speedSquared;
+        tracking->HeadPose.LinearAcceleration.x = record.LinearAcceleration[0] * speedSquared;
+        tracking->HeadPose.LinearAcceleration.y = record.LinearAcceleration[1] * speedSquared;
+        tracking->HeadPose.LinearAcceleration.z = record.LinearAcceleration[2] * speedSquared;
+        tracking->HeadPose.TimeInSeconds = timeInSeconds;
+        tracking->HeadPose.PredictionInSeconds = record.PredictionInSeconds;
+    }
+
+public:
+    PoseReplay(): nextIndex(0), lastIndex(0), loops(0), replayedCount(0), ended(false)
+    {
+    }
+
+    ~PoseReplay()
+    {
+        delete recording.retire();
+    }
+
+    // Only from the owner thread. Replaces the recording (NULL to replay nothing) and stops the playback.
+    void setRecording(ovrPoseRecording* poseRecording)
+    {
+        Playback stopped;
+        memset(&stopped, 0, sizeof(stopped));
+        stopped.recordingTime = poseRecording != NULL ? poseRecording->startTime : 0.0;
+        playback.write(stopped);
+        delete recording.retire();
+        nextIndex.store(0);
+        lastIndex.store(0);
+        loops.store(0);
+        replayedCount.store(0);
+        ended.store(false);
+        recording.publish(poseRecording);
+    }
+
+    // speed 0 plays as fast as possible. Starts from the current position (the start, where paused or where seeked).
+    void play(const double now, const float speed, const bool loop)
+    {
+        GuardedPointer<ovrPoseRecording>::ReadScope scope(recording);
+        const ovrPoseRecording* poseRecording = scope.get();
+        if (poseRecording == NULL || poseRecording->records.empty())
+        {
+            return;
+        }
+        Playback current;
+        playback.read(current);
+        Playback next;
+        next.liveTime = now;
+        next.recordingTime = current.playing ? poseRecording->records[lastIndex.load(std::memory_order_relaxed)].PoseTimeInSeconds : current.recordingTime;
+        next.speed = speed < 0.0f ? 0.0f : speed;
+        next.playing = true;
+        next.loop = loop;
+        if (next.speed == 0.0f)
+        {
+            nextIndex.store((unsigned int)findRecord(*poseRecording, next.recordingTime), std::memory_order_relaxed);
+        }
+        ended.store(false, std::memory_order_relaxed);
+        playback.write(next);
+    }
+
+    // Moves the playback to seconds from the start of the recording.
+    void seek(const double now, const double seconds)
+    {
+        GuardedPointer<ovrPoseRecording>::ReadScope scope(recording);
+        const ovrPoseRecording* poseRecording = scope.get();
+        if (poseRecording == NULL || poseRecording->records.empty())
+        {
+            return;
+        }
+        Playback next;
+        playback.read(next);
+        next.liveTime = now;
+        next.recordingTime = poseRecording->startTime + (seconds < 0.0 ? 0.0 : (seconds > poseRecording->duration ? poseRecording->duration : seconds));
+        const unsigned int index = (unsigned int)findRecord(*poseRecording, next.recordingTime);
+        nextIndex.store(index, std::memory_order_relaxed);
+        lastIndex.store(index, std::memory_order_relaxed);
+        ended.store(false, std::memory_order_relaxed);
+        playback.write(next);
+    }
+
+    // Keeps the position, the live tracking is used until playing again.
+    void pause()
+    {
+        GuardedPointer<ovrPoseRecording>::ReadScope scope(recording);
+        const ovrPoseRecording* poseRecording = scope.get();
+        if (poseRecording == NULL || poseRecording->records.empty())
+        {
+            return;
+        }
+        Playback next;
+        playback.read(next);
+        if (next.playing)
+        {
+            next.recordingTime = poseRecording->records[lastIndex.load(std::memory_order_relaxed)].PoseTimeInSeconds;
+            next.playing = false;
+            playback.write(next);
+        }
+    }
+
+    // The recorded tracking for the live target time. Returns false if not playing (the live tracking is used). Any thread.
+    // At speed 0 only a stepping query moves to the next record, the others get the last one handed out.
+    bool getTracking(const double targetTime, const bool step, ovrTracking* tracking)
+    {
+        Playback current;
+        if (playback.read(current) == 0 || !current.playing)
+        {
+            return false;
+        }
+        GuardedPointer<ovrPoseRecording>::ReadScope scope(recording);
+        const ovrPoseRecording* poseRecording = scope.get();
+        if (poseRecording == NULL)
+        {
+            return false;
+        }
+        const unsigned int count = (unsigned int)poseRecording->records.size();
+        unsigned int index;
+        double timeInSeconds = targetTime;
+        if (current.speed == 0.0f && !step)
+        {
+            index = lastIndex.load(std::memory_order_relaxed);
+        }
+        else if (current.speed == 0.0f)
+        {
+            index = nextIndex.fetch_add(1, std::memory_order_relaxed);
+            if (index >= count)
+            {
+                if (current.loop)
+                {
+                    if (index / count > loops.load(std::memory_order_relaxed))
+                    {
+                        loops.store(index / count, std::memory_order_relaxed);
+                    }
+                    index %= count;
+                }
+                else
+                {
+                    index = count - 1;
+                    ended.store(true, std::memory_order_relaxed);
+                }
+            }
+        }
+        else
+        {
+            double recordingTime = current.recordingTime + (targetTime - current.liveTime) * current.speed;
+            double elapsed = recordingTime - poseRecording->startTime;
+            if (elapsed > poseRecording->duration)
+            {
+                if (current.loop && poseRecording->duration > 0.0)
+                {
+                    const double loopCount = floor(elapsed / poseRecording->duration);
+                    if ((unsigned int)loopCount > loops.load(std::memory_order_relaxed))
+                    {
+                        loops.store((unsigned int)loopCount, std::memory_order_relaxed);
+                    }
+                    elapsed -= loopCount * poseRecording->duration;
+                }
+                else
+                {
+                    elapsed = poseRecording->duration;
+                    ended.store(true, std::memory_order_relaxed);
+                }
+                recordingTime = poseRecording->startTime + elapsed;
+            }
+            index = (unsigned int)findRecord(*poseRecording, recordingTime);
+            // The live time of the record
+            timeInSeconds = targetTime - (recordingTime - poseRecording->records[index].PoseTimeInSeconds) / current.speed;
+        }
+        setTracking(poseRecording->records[index], timeInSeconds, current.speed == 0.0f ? 1.0f : current.speed, tracking);
+        lastIndex.store(index, std::memory_order_relaxed);
+        replayedCount.store(replayedCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Records loaded, duration (seconds), playing (1 or 0), position (seconds from the start), loops, poses replayed
+    void getStatistics(float statistics[STATISTICS_FLOAT_COUNT])
+    {
+        Playback current;
+        playback.read(current);
+        GuardedPointer<ovrPoseRecording>::ReadScope scope(recording);
+        const ovrPoseRecording* poseRecording = scope.get();
+        const bool loaded = poseRecording != NULL && !poseRecording->records.empty();
+        statistics[0] = loaded ? (float)poseRecording->records.size() : 0.0f;
+        statistics[1] = loaded ? (float)poseRecording->duration : 0.0f;
+        statistics[2] = current.playing && !ended.load(std::memory_order_relaxed) ? 1.0f : 0.0f;
+        statistics[3] = loaded ? (float)(poseRecording->records[lastIndex.load(std::memory_order_relaxed)].PoseTimeInSeconds - poseRecording->startTime) : 0.0f;
+        statistics[4] = (float)loops.load(std::memory_order_relaxed);
+        statistics[5] = (float)replayedCount.load(std::memory_order_relaxed);
+    }
+};
+
+#endif // POSE_REPLAY_H
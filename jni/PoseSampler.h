@@ -0,0 +1,218 @@
+#ifndef POSE_SAMPLER_H
+#define POSE_SAMPLER_H
+
+#include <time.h>
+#include <errno.h>
+#include <sched.h>
+#include <string.h>
+#include <pthread.h>
+
+#include <atomic>
+
+#include "Clock.h"
+#include "ThreadConfiguration.h"
+
+// ================================================================================================
+// PoseSampler
+// A dedicated thread that calls a sample function at a fixed rate. Every wake up is paced against
+// an absolute deadline (clock_nanosleep with TIMER_ABSTIME) so the period does not drift with the
+// time spent sampling, and the difference between the deadline and the actual wake up time
+// (jitter) is accumulated in a histogram. Deadlines that are missed by more than a full period are
+// skipped instead of being caught up with a burst of samples.
+// An optional deadline function can move each deadline to follow another clock (the display refresh),
+// the fixed period is then only what it falls back to.
+// The statistics are only written by the sampler thread and can be read from any thread.
+// The thread applies its ovrThreadConfiguration to itself before the first sample and start does not
+// return until it has, so the telemetry (and the tid) are available right away.
+// ================================================================================================
+class PoseSampler
+{
+public:
+    typedef void (*SampleFunction)(void* context);
+    // Returns the absolute deadline (GetTimeInNanoseconds) of the next sample, given the one of the fixed period.
+    typedef long long (*DeadlineFunction)(void* context, long long periodDeadline);
+
+    // samples, mean jitter (us), p99 jitter (us), max jitter (us), missed deadlines
+    static const int STATISTICS_FLOAT_COUNT = 5;
+
+private:
+    static const int JITTER_BIN_MICROSECONDS = 10;
+    // The last bin also collects any longer jitter.
+    static const int JITTER_BIN_COUNT = 256;
+
+    pthread_t thread;
+    std::atomic<bool> running;
+    long long periodNanoseconds;
+    SampleFunction sampleFunction;
+    DeadlineFunction deadlineFunction;
+    void* sampleContext;
+    ovrThreadConfiguration configuration;
+    ovrThreadTelemetry telemetry;
+    std::atomic<bool> configured;
+
+    std::atomic<unsigned int> jitterHistogram[JITTER_BIN_COUNT];
+    std::atomic<unsigned int> sampleCount;
+    std::atomic<unsigned int> missedDeadlineCount;
+    std::atomic<long long> jitterSumNanoseconds;
+    std::atomic<long long> jitterMaxNanoseconds;
+
+    void recordJitter(const long long jitterNanoseconds)
+    {
+        int bin = (int)(jitterNanoseconds / (JITTER_BIN_MICROSECONDS * 1000));
+        bin = bin < 0 ? 0 : (bin >= JITTER_BIN_COUNT ? JITTER_BIN_COUNT - 1 : bin);
+        jitterHistogram[bin].store(jitterHistogram[bin].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        jitterSumNanoseconds.store(jitterSumNanoseconds.load(std::memory_order_relaxed) + jitterNanoseconds, std::memory_order_relaxed);
+        if (jitterNanoseconds > jitterMaxNanoseconds.load(std::memory_order_relaxed))
+        {
+            jitterMaxNanoseconds.store(jitterNanoseconds, std::memory_order_relaxed);
+        }
+        sampleCount.store(sampleCount.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    static void toTimespec(const long long nanoseconds, struct timespec& result)
+    {
+        result.tv_sec = (time_t)(nanoseconds / 1000000000LL);
+        result.tv_nsec = (long)(nanoseconds % 1000000000LL);
+    }
+
+    void threadFunction()
+    {
+        ovrThreadConfiguration_ApplyToCurrentThread(&configuration, &telemetry);
+        configured.store(true, std::memory_order_release);
+        
+        long long deadline = nextDeadline(GetTimeInNanoseconds() + periodNanoseconds);
+        while (running.load(std::memory_order_acquire))
+        {
+            struct timespec deadlineTimespec;
+            toTimespec(deadline, deadlineTimespec);
+            while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadlineTimespec, NULL) == EINTR)
+            {
+            }
+            const long long now = GetTimeInNanoseconds();
+            recordJitter(now - deadline);
+
+            sampleFunction(sampleContext);
+
+            deadline += periodNanoseconds;
+            const long long afterSample = GetTimeInNanoseconds();
+            if (afterSample - deadline > periodNanoseconds)
+            {
+                const long long missed = (afterSample - deadline) / periodNanoseconds;
+                missedDeadlineCount.fetch_add((unsigned int)missed, std::memory_order_relaxed);
+                deadline += missed * periodNanoseconds;
+            }
+            deadline = nextDeadline(deadline);
+        }
+    }
+
+    inline long long nextDeadline(const long long periodDeadline)
+    {
+        return deadlineFunction != NULL ? deadlineFunction(sampleContext, periodDeadline) : periodDeadline;
+    }
+
+    static void* threadFunctionStatic(void* data)
+    {
+        ((PoseSampler*)data)->threadFunction();
+        return NULL;
+    }
+
+public:
+    PoseSampler(): running(false), periodNanoseconds(0), sampleFunction(NULL), deadlineFunction(NULL), sampleContext(NULL), configured(false)
+    {
+        ovrThreadConfiguration_Init(&configuration, "");
+        memset(&telemetry, 0, sizeof(telemetry));
+        resetStatistics();
+    }
+
+    ~PoseSampler()
+    {
+        stop();
+    }
+
+    void resetStatistics()
+    {
+        for (int i = 0; i < JITTER_BIN_COUNT; i++)
+        {
+            jitterHistogram[i].store(0);
+        }
+        sampleCount.store(0);
+        missedDeadlineCount.store(0);
+        jitterSumNanoseconds.store(0);
+        jitterMaxNanoseconds.store(0);
+    }
+
+    // Returns false if the thread could not be created.
+    bool start(const int samplesPerSecond, SampleFunction function, void* context, const ovrThreadConfiguration& threadConfiguration, DeadlineFunction nextDeadlineFunction = NULL)
+    {
+        stop();
+        if (samplesPerSecond <= 0)
+        {
+            return true;
+        }
+        periodNanoseconds = 1000000000LL / samplesPerSecond;
+        sampleFunction = function;
+        deadlineFunction = nextDeadlineFunction;
+        sampleContext = context;
+        configuration = threadConfiguration;
+        configured.store(false);
+        running.store(true);
+        if (pthread_create(&thread, NULL, threadFunctionStatic, this) != 0)
+        {
+            running.store(false);
+            return false;
+        }
+        while (!configured.load(std::memory_order_acquire))
+        {
+            sched_yield();
+        }
+        return true;
+    }
+
+    // Waits for the sampler thread to finish its current sample.
+    void stop()
+    {
+        if (running.exchange(false))
+        {
+            pthread_join(thread, NULL);
+        }
+    }
+
+    inline bool isRunning() const
+    {
+        return running.load(std::memory_order_relaxed);
+    }
+
+    inline pthread_t getThread() const
+    {
+        return thread;
+    }
+    
+    // What the running (or last) sampler thread was granted. Only valid after start returned true.
+    inline const ovrThreadTelemetry& getTelemetry() const
+    {
+        return telemetry;
+    }
+
+    void getStatistics(float statistics[STATISTICS_FLOAT_COUNT]) const
+    {
+        const unsigned int count = sampleCount.load(std::memory_order_acquire);
+        statistics[0] = (float)count;
+        statistics[1] = count > 0 ? (float)(jitterSumNanoseconds.load(std::memory_order_relaxed) / count) * 0.001f : 0.0f;
+        statistics[2] = 0.0f;
+        const unsigned int rank = count - count / 100;
+        unsigned int cumulative = 0;
+        for (int bin = 0; bin < JITTER_BIN_COUNT && count > 0; bin++)
+        {
+            cumulative += jitterHistogram[bin].load(std::memory_order_relaxed);
+            if (cumulative >= rank)
+            {
+                statistics[2] = (float)((bin + 1) * JITTER_BIN_MICROSECONDS);
+                break;
+            }
+        }
+        statistics[3] = (float)jitterMaxNanoseconds.load(std::memory_order_relaxed) * 0.001f;
+        statistics[4] = (float)missedDeadlineCount.load(std::memory_order_relaxed);
+    }
+};
+
+#endif // POSE_SAMPLER_H
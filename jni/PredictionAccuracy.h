@@ -0,0 +1,217 @@
+#ifndef PREDICTION_ACCURACY_H
+#define PREDICTION_ACCURACY_H
+
+#include <math.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "VrApi_Types.h"
+#include "PoseMath.h"
+
+// ================================================================================================
+// PredictionAccuracy
+// Keeps every predicted orientation until the head has actually been observed at the predicted
+// target time and accumulates the angular error in a histogram per prediction horizon.
+// Observations are plain sensor readings (time + orientation), so the same code works online
+// (feeding it vrapi_GetPredictedTracking(ovr, 0.0), the most recent sensor reading) and offline
+// over a recorded stream. Percentiles come from fixed exponential histograms so nothing is
+// allocated and the statistics can be queried at any time.
+// ================================================================================================
+class PredictionAccuracy
+{
+public:
+    static const int HORIZON_BUCKET_MILLISECONDS = 5;
+    // The last bucket also collects every horizon beyond the others.
+    static const int HORIZON_BUCKET_COUNT = 20;
+    // horizon (upper bound in ms), sample count, p50, p95, p99 (degrees)
+    static const int STATISTICS_FLOATS_PER_BUCKET = 5;
+    static const int STATISTICS_FLOAT_COUNT = HORIZON_BUCKET_COUNT * STATISTICS_FLOATS_PER_BUCKET;
+
+private:
+    // Must be a power of 2.
+    static const int MAX_PENDING_PREDICTIONS = 256;
+    // Error bins grow exponentially (8% each) from 0.01 degrees, which covers up to ~190 degrees.
+    static const int ERROR_BIN_COUNT = 128;
+    static constexpr float ERROR_BIN_MIN_DEGREES = 0.01f;
+    static constexpr float ERROR_BIN_RATIO = 1.08f;
+    // Predictions whose target falls in a gap between observations larger than this (pause, stalls)
+    // cannot be compared reliably and are discarded.
+    static constexpr double MAX_OBSERVATION_GAP_SECONDS = 0.05;
+
+    struct PendingPrediction
+    {
+        double targetTime;
+        float horizon;
+        ovrQuatf orientation;
+    };
+
+    PendingPrediction pendingPredictions[MAX_PENDING_PREDICTIONS];
+    unsigned int pendingHead;
+    unsigned int pendingTail;
+    unsigned int errorHistograms[HORIZON_BUCKET_COUNT][ERROR_BIN_COUNT];
+    unsigned int sampleCounts[HORIZON_BUCKET_COUNT];
+    unsigned int discardedCount;
+    bool hasObservation;
+    double lastObservationTime;
+    ovrQuatf lastObservationOrientation;
+    pthread_mutex_t mutex;
+
+    static int horizonBucket(const float horizon)
+    {
+        const int bucket = (int)(horizon * 1000.0f) / HORIZON_BUCKET_MILLISECONDS;
+        return bucket < 0 ? 0 : (bucket >= HORIZON_BUCKET_COUNT ? HORIZON_BUCKET_COUNT - 1 : bucket);
+    }
+
+    static int errorBin(const float errorDegrees)
+    {
+        if (errorDegrees <= ERROR_BIN_MIN_DEGREES)
+        {
+            return 0;
+        }
+        const int bin = (int)(logf(errorDegrees / ERROR_BIN_MIN_DEGREES) / logf(ERROR_BIN_RATIO));
+        return bin >= ERROR_BIN_COUNT ? ERROR_BIN_COUNT - 1 : bin;
+    }
+
+    static float errorBinUpperDegrees(const int bin)
+    {
+        return ERROR_BIN_MIN_DEGREES * powf(ERROR_BIN_RATIO, (float)(bin + 1));
+    }
+
+    float percentile(const int bucket, const float fraction) const
+    {
+        if (sampleCounts[bucket] == 0)
+        {
+            return 0.0f;
+        }
+        const unsigned int rank = (unsigned int)ceilf(fraction * sampleCounts[bucket]);
+        unsigned int cumulative = 0;
+        for (int bin = 0; bin < ERROR_BIN_COUNT; bin++)
+        {
+            cumulative += errorHistograms[bucket][bin];
+            if (cumulative >= rank)
+            {
+                return errorBinUpperDegrees(bin);
+            }
+        }
+        return errorBinUpperDegrees(ERROR_BIN_COUNT - 1);
+    }
+
+    void recordError(const float horizon, const ovrQuatf& predicted, const ovrQuatf& observed)
+    {
+        const float errorDegrees = ovrQuatf_AngleBetween(&predicted, &observed) * (180.0f / (float)M_PI);
+        const int bucket = horizonBucket(horizon);
+        errorHistograms[bucket][errorBin(errorDegrees)]++;
+        sampleCounts[bucket]++;
+    }
+
+public:
+    PredictionAccuracy()
+    {
+        pthread_mutex_init(&mutex, NULL);
+        reset();
+    }
+
+    ~PredictionAccuracy()
+    {
+        pthread_mutex_destroy(&mutex);
+    }
+
+    void reset()
+    {
+        pthread_mutex_lock(&mutex);
+        pendingHead = 0;
+        pendingTail = 0;
+        memset(errorHistograms, 0, sizeof(errorHistograms));
+        memset(sampleCounts, 0, sizeof(sampleCounts));
+        discardedCount = 0;
+        hasObservation = false;
+        lastObservationTime = 0.0;
+        pthread_mutex_unlock(&mutex);
+    }
+
+    // A prediction made 'horizon' seconds ahead of time for the absolute time 'targetTime'. The predictions
+    // can be added in any target time order.
+    void addPrediction(const double targetTime, const double horizon, const ovrQuatf& orientation)
+    {
+        pthread_mutex_lock(&mutex);
+        if (pendingTail - pendingHead >= MAX_PENDING_PREDICTIONS)
+        {
+            // Nobody is observing. Forget the oldest one.
+            pendingHead++;
+            discardedCount++;
+        }
+        // Kept in target time order: the targets are not monotonic (adaptive horizon, several consumers,
+        // push deliveries) and an earlier one queued behind a later one would be discarded when resolved
+        unsigned int index = pendingTail;
+        while (index != pendingHead && pendingPredictions[(index - 1) & (MAX_PENDING_PREDICTIONS - 1)].targetTime > targetTime)
+        {
+            pendingPredictions[index & (MAX_PENDING_PREDICTIONS - 1)] = pendingPredictions[(index - 1) & (MAX_PENDING_PREDICTIONS - 1)];
+            index--;
+        }
+        PendingPrediction& prediction = pendingPredictions[index & (MAX_PENDING_PREDICTIONS - 1)];
+        prediction.targetTime = targetTime;
+        prediction.horizon = (float)horizon;
+        prediction.orientation = orientation;
+        pendingTail++;
+        pthread_mutex_unlock(&mutex);
+    }
+
+    // An actual sensor reading. Observations must be provided in increasing time order. Every pending
+    // prediction that targets a time between the previous observation and this one is resolved
+    // against the orientation interpolated at its target time.
+    void addObservation(const double time, const ovrQuatf& orientation)
+    {
+        pthread_mutex_lock(&mutex);
+        if (hasObservation && time <= lastObservationTime)
+        {
+            pthread_mutex_unlock(&mutex);
+            return;
+        }
+        while (pendingTail != pendingHead)
+        {
+            const PendingPrediction& prediction = pendingPredictions[pendingHead & (MAX_PENDING_PREDICTIONS - 1)];
+            if (prediction.targetTime > time)
+            {
+                break;
+            }
+            if (!hasObservation || prediction.targetTime < lastObservationTime || time - lastObservationTime > MAX_OBSERVATION_GAP_SECONDS)
+            {
+                discardedCount++;
+            }
+            else
+            {
+                const float t = (float)((prediction.targetTime - lastObservationTime) / (time - lastObservationTime));
+                const ovrQuatf observed = ovrQuatf_Nlerp(&lastObservationOrientation, &orientation, t);
+                recordError(prediction.horizon, prediction.orientation, observed);
+            }
+            pendingHead++;
+        }
+        hasObservation = true;
+        lastObservationTime = time;
+        lastObservationOrientation = orientation;
+        pthread_mutex_unlock(&mutex);
+    }
+
+    // Fills STATISTICS_FLOAT_COUNT floats, STATISTICS_FLOATS_PER_BUCKET per horizon bucket.
+    void getStatistics(float* statistics)
+    {
+        pthread_mutex_lock(&mutex);
+        for (int bucket = 0; bucket < HORIZON_BUCKET_COUNT; bucket++)
+        {
+            float* s = statistics + bucket * STATISTICS_FLOATS_PER_BUCKET;
+            s[0] = (float)((bucket + 1) * HORIZON_BUCKET_MILLISECONDS);
+            s[1] = (float)sampleCounts[bucket];
+            s[2] = percentile(bucket, 0.50f);
+            s[3] = percentile(bucket, 0.95f);
+            s[4] = percentile(bucket, 0.99f);
+        }
+        pthread_mutex_unlock(&mutex);
+    }
+
+    unsigned int getDiscardedCount() const
+    {
+        return discardedCount;
+    }
+};
+
+#endif // PREDICTION_ACCURACY_H
@@ -0,0 +1,64 @@
+#ifndef RESUME_STATISTICS_H
+#define RESUME_STATISTICS_H
+
+#include <atomic>
+
+// ================================================================================================
+// ResumeStatistics
+// How long it takes to be back in VR mode after a resume, separately for warm resumes (the VR mode
+// was only suspended, see the warm resume grace period) and cold ones (it had to be entered again).
+// The latency is measured from the moment the tracking thread processes the resume to the moment
+// poses are available again, so a cold resume also includes waiting for the surface.
+// Only recorded by the tracking thread, can be read from any thread.
+// ================================================================================================
+class ResumeStatistics
+{
+public:
+    // warm resumes, mean warm latency (ms), last warm latency (ms), cold resumes, mean cold latency (ms), last cold latency (ms)
+    static const int STATISTICS_FLOAT_COUNT = 6;
+
+private:
+    enum Kinds
+    {
+        WARM,
+        COLD,
+        KIND_COUNT
+    };
+
+    std::atomic<unsigned int> counts[KIND_COUNT];
+    std::atomic<long long> sumNanoseconds[KIND_COUNT];
+    std::atomic<long long> lastNanoseconds[KIND_COUNT];
+
+public:
+    ResumeStatistics()
+    {
+        for (int kind = 0; kind < KIND_COUNT; kind++)
+        {
+            counts[kind].store(0);
+            sumNanoseconds[kind].store(0);
+            lastNanoseconds[kind].store(0);
+        }
+    }
+
+    void record(const bool warm, const long long latencyNanoseconds)
+    {
+        const int kind = warm ? WARM : COLD;
+        sumNanoseconds[kind].store(sumNanoseconds[kind].load(std::memory_order_relaxed) + latencyNanoseconds, std::memory_order_relaxed);
+        lastNanoseconds[kind].store(latencyNanoseconds, std::memory_order_relaxed);
+        counts[kind].store(counts[kind].load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    void getStatistics(float statistics[STATISTICS_FLOAT_COUNT]) const
+    {
+        for (int kind = 0; kind < KIND_COUNT; kind++)
+        {
+            const unsigned int count = counts[kind].load(std::memory_order_acquire);
+            float* kindStatistics = statistics + kind * 3;
+            kindStatistics[0] = (float)count;
+            kindStatistics[1] = count > 0 ? (float)(sumNanoseconds[kind].load(std::memory_order_relaxed) / count) * 1e-6f : 0.0f;
+            kindStatistics[2] = (float)lastNanoseconds[kind].load(std::memory_order_relaxed) * 1e-6f;
+        }
+    }
+};
+
+#endif // RESUME_STATISTICS_H
@@ -0,0 +1,73 @@
+#ifndef SAMPLE_RING_H
+#define SAMPLE_RING_H
+
+#include <string.h>
+
+#include <atomic>
+
+// ================================================================================================
+// SampleRing
+// Fixed size history of the last CAPACITY samples written by a single producer. Every slot has its
+// own sequence number (like a SeqLock) so any number of readers can walk the history with their own
+// cursor, without locks and without ever blocking the producer. A reader that falls behind by more
+// than CAPACITY samples simply sees the slots it missed as overwritten.
+// ================================================================================================
+template<typename T, unsigned int CAPACITY>
+class SampleRing
+{
+private:
+    static_assert((CAPACITY & (CAPACITY - 1)) == 0, "The SampleRing capacity must be a power of 2");
+
+    struct Slot
+    {
+        std::atomic<unsigned int> sequence;
+        T value;
+    };
+
+    Slot slots[CAPACITY];
+    std::atomic<unsigned int> writeCount;
+
+public:
+    SampleRing(): writeCount(0)
+    {
+        for (unsigned int i = 0; i < CAPACITY; i++)
+        {
+            slots[i].sequence.store(0);
+        }
+    }
+
+    // Only one thread may push.
+    void push(const T& value)
+    {
+        const unsigned int index = writeCount.load(std::memory_order_relaxed);
+        Slot& slot = slots[index & (CAPACITY - 1)];
+        slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        memcpy(&slot.value, &value, sizeof(T));
+        slot.sequence.store(2 * index + 2, std::memory_order_release);
+        writeCount.store(index + 1, std::memory_order_release);
+    }
+
+    // The index the next pushed sample will get (the number of samples pushed so far).
+    inline unsigned int getWriteCount() const
+    {
+        return writeCount.load(std::memory_order_acquire);
+    }
+
+    // Copies the sample with the given index. Returns false if it has not been written yet or it has
+    // already been overwritten.
+    bool read(const unsigned int index, T& result) const
+    {
+        const Slot& slot = slots[index & (CAPACITY - 1)];
+        const unsigned int expected = 2 * index + 2;
+        if (slot.sequence.load(std::memory_order_acquire) != expected)
+        {
+            return false;
+        }
+        memcpy(&result, &slot.value, sizeof(T));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return slot.sequence.load(std::memory_order_relaxed) == expected;
+    }
+};
+
+#endif // SAMPLE_RING_H
@@ -0,0 +1,60 @@
+#ifndef SEQ_LOCK_H
+#define SEQ_LOCK_H
+
+#include <string.h>
+
+#include <atomic>
+
+// ================================================================================================
+// SeqLock
+// Many readers that never take a lock: they copy the value and retry if a write happened in the
+// middle. Writes are expected to come from a single thread at a time; the rare overlapping writer
+// spins until the other one is done. Meant for small, trivially copyable
+// values like an ovrTracking that are written often and read from any thread.
+// ================================================================================================
+template<typename T>
+class SeqLock
+{
+private:
+    std::atomic<unsigned int> sequence;
+    T value;
+
+public:
+    SeqLock(): sequence(0)
+    {
+        memset(&value, 0, sizeof(value));
+    }
+
+    void write(const T& newValue)
+    {
+        unsigned int s = sequence.load(std::memory_order_relaxed);
+        while ((s & 1) != 0 || !sequence.compare_exchange_weak(s, s + 1, std::memory_order_acquire, std::memory_order_relaxed))
+        {
+            s = sequence.load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+        memcpy(&value, &newValue, sizeof(T));
+        sequence.store(s + 2, std::memory_order_release);
+    }
+
+    // Returns the number of writes so far (0 means the value was never written).
+    unsigned int read(T& result) const
+    {
+        for ( ; ; )
+        {
+            const unsigned int before = sequence.load(std::memory_order_acquire);
+            if ((before & 1) != 0)
+            {
+                continue;
+            }
+            memcpy(&result, &value, sizeof(T));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence.load(std::memory_order_relaxed) == before)
+            {
+                return before >> 1;
+            }
+        }
+    }
+};
+
+#endif // SEQ_LOCK_H
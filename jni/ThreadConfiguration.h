@@ -0,0 +1,155 @@
+#ifndef THREAD_CONFIGURATION_H
+#define THREAD_CONFIGURATION_H
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sched.h>
+#include <pthread.h>
+#include <sys/resource.h>
+
+// ================================================================================================
+// Thread configuration
+// CPU affinity, SCHED_FIFO priority and name of the native threads. Everything is applied by the
+// thread to itself (so it works the same for the tracking and the sampler threads) and whatever was
+// actually granted is read back into an ovrThreadTelemetry.
+// Apps do not normally have the permission to use SCHED_FIFO. When it is denied, the thread falls back
+// to the highest nice value it is allowed to use and the owner can ask vrapi, which does have the
+// permission, to promote it through ovrPerformanceParms (see ovrThreadTelemetry::VrapiFifoRequested).
+// ================================================================================================
+#define THREAD_NAME_MAX_LENGTH 16
+
+// The nice value tried when SCHED_FIFO is denied (Android's THREAD_PRIORITY_URGENT_DISPLAY).
+#define THREAD_FALLBACK_NICE -8
+
+typedef struct
+{
+    // Bit i set allows the thread to run on CPU i. 0 leaves the affinity untouched.
+    unsigned int AffinityMask;
+    // SCHED_FIFO priority [1, 99]. 0 leaves the thread with the default policy.
+    int FifoPriority;
+    char Name[THREAD_NAME_MAX_LENGTH];
+} ovrThreadConfiguration;
+
+typedef struct
+{
+    int Tid;
+    unsigned int RequestedAffinityMask;
+    unsigned int GrantedAffinityMask;
+    int RequestedFifoPriority;
+    int GrantedPolicy;
+    int GrantedPriority;
+    int GrantedNice;
+    // SCHED_FIFO was requested but denied, so it should be requested through vrapi instead.
+    bool VrapiFifoRequested;
+} ovrThreadTelemetry;
+
+static inline void ovrThreadConfiguration_Init( ovrThreadConfiguration * configuration, const char * name )
+{
+    configuration->AffinityMask = 0;
+    configuration->FifoPriority = 0;
+    strncpy( configuration->Name, name, THREAD_NAME_MAX_LENGTH - 1 );
+    configuration->Name[THREAD_NAME_MAX_LENGTH - 1] = '\0';
+}
+
+// Returns the mask of the CPUs with the highest maximum frequency (the "big" cores of a big.LITTLE
+// SoC, all of them on a symmetric one). 0 if it cannot be determined.
+static inline unsigned int ovrThreadConfiguration_GetBigCoresMask()
+{
+    unsigned int mask = 0;
+    long long highestFrequency = 0;
+    const long cpuCount = sysconf( _SC_NPROCESSORS_CONF );
+    for ( int cpu = 0; cpu < cpuCount && cpu < 32; cpu++ )
+    {
+        char path[128];
+        snprintf( path, sizeof( path ), "/sys/devices/system/cpu/cpu%d/cpufreq/cpuinfo_max_freq", cpu );
+        FILE * file = fopen( path, "r" );
+        if ( file == NULL )
+        {
+            continue;
+        }
+        long long frequency = 0;
+        if ( fscanf( file, "%lld", &frequency ) == 1 )
+        {
+            if ( frequency > highestFrequency )
+            {
+                highestFrequency = frequency;
+                mask = 0;
+            }
+            if ( frequency == highestFrequency )
+            {
+                mask |= 1u << cpu;
+            }
+        }
+        fclose( file );
+    }
+    return mask;
+}
+
+// Reads back what the thread telemetry->Tid currently has. vrapi promotes the threads asynchronously
+// so this can be called again later, from any thread, to see if it did.
+static inline void ovrThreadTelemetry_Refresh( ovrThreadTelemetry * telemetry )
+{
+    const pid_t tid = telemetry->Tid;
+    telemetry->GrantedAffinityMask = 0;
+    cpu_set_t grantedCpuSet;
+    CPU_ZERO( &grantedCpuSet );
+    if ( sched_getaffinity( tid, sizeof( grantedCpuSet ), &grantedCpuSet ) == 0 )
+    {
+        for ( int cpu = 0; cpu < 32; cpu++ )
+        {
+            if ( CPU_ISSET( cpu, &grantedCpuSet ) )
+            {
+                telemetry->GrantedAffinityMask |= 1u << cpu;
+            }
+        }
+    }
+    telemetry->GrantedPolicy = sched_getscheduler( tid );
+    struct sched_param grantedParam;
+    telemetry->GrantedPriority = sched_getparam( tid, &grantedParam ) == 0 ? grantedParam.sched_priority : 0;
+    telemetry->GrantedNice = getpriority( PRIO_PROCESS, tid );
+}
+
+static inline void ovrThreadConfiguration_ApplyToCurrentThread( const ovrThreadConfiguration * configuration, ovrThreadTelemetry * telemetry )
+{
+    memset( telemetry, 0, sizeof( ovrThreadTelemetry ) );
+    telemetry->Tid = gettid();
+    telemetry->RequestedAffinityMask = configuration->AffinityMask;
+    telemetry->RequestedFifoPriority = configuration->FifoPriority;
+
+    if ( configuration->Name[0] != '\0' )
+    {
+        pthread_setname_np( pthread_self(), configuration->Name );
+    }
+
+    if ( configuration->AffinityMask != 0 )
+    {
+        cpu_set_t cpuSet;
+        CPU_ZERO( &cpuSet );
+        for ( int cpu = 0; cpu < 32; cpu++ )
+        {
+            if ( ( configuration->AffinityMask & ( 1u << cpu ) ) != 0 )
+            {
+                CPU_SET( cpu, &cpuSet );
+            }
+        }
+        // pid 0 is the calling thread. A failure shows up in GrantedAffinityMask.
+        sched_setaffinity( 0, sizeof( cpuSet ), &cpuSet );
+    }
+
+    if ( configuration->FifoPriority > 0 )
+    {
+        struct sched_param param;
+        param.sched_priority = configuration->FifoPriority;
+        if ( sched_setscheduler( 0, SCHED_FIFO, &param ) != 0 )
+        {
+            // Most likely EPERM. Do the best we can on our own and let vrapi do the rest.
+            setpriority( PRIO_PROCESS, 0, THREAD_FALLBACK_NICE );
+            telemetry->VrapiFifoRequested = true;
+        }
+    }
+
+    ovrThreadTelemetry_Refresh( telemetry );
+}
+
+#endif // THREAD_CONFIGURATION_H
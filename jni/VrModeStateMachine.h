@@ -0,0 +1,110 @@
+#ifndef VR_MODE_STATE_MACHINE_H
+#define VR_MODE_STATE_MACHINE_H
+
+#include <atomic>
+
+// ================================================================================================
+// VrModeStateMachine
+// The states the graphics and VR mode of the session go through, and the transitions between them.
+// The session computes the state it should be in (from the consumers and the warm resume grace
+// period) and walks the transition table towards it one edge at a time, so the side effects of each
+// edge (create the window surface, enter VR mode, suspend, resume, leave VR mode, destroy the window
+// surface) only run when the target state actually differs from the current one.
+// The count and duration of each edge taken are recorded. The transitions are only run and recorded
+// by the tracking thread, the statistics can be read from any thread.
+// ================================================================================================
+class VrModeStateMachine
+{
+public:
+    enum States
+    {
+        // No window surface.
+        STATE_IDLE,
+        // The window surface is created, not in VR mode.
+        STATE_SURFACE,
+        // In VR mode, sampling.
+        STATE_VR_MODE,
+        // Still in VR mode (paused for less than the warm resume grace period), not sampling.
+        STATE_SUSPENDED,
+        STATE_COUNT
+    };
+
+    // Per edge (from * STATE_COUNT + to): count, mean duration (ms), max duration (ms)
+    static const int FLOATS_PER_EDGE = 3;
+    static const int STATISTICS_FLOAT_COUNT = STATE_COUNT * STATE_COUNT * FLOATS_PER_EDGE;
+
+    // The state to go to next to reach the target one (itself if already there).
+    static int getNextState(const int state, const int targetState)
+    {
+        static const int NEXT_STATES[STATE_COUNT][STATE_COUNT] =
+        {
+            // to:           IDLE            SURFACE         VR_MODE          SUSPENDED
+            /* IDLE */      { STATE_IDLE,    STATE_SURFACE,  STATE_SURFACE,   STATE_SURFACE   },
+            /* SURFACE */   { STATE_IDLE,    STATE_SURFACE,  STATE_VR_MODE,   STATE_VR_MODE   },
+            /* VR_MODE */   { STATE_SURFACE, STATE_SURFACE,  STATE_VR_MODE,   STATE_SUSPENDED },
+            /* SUSPENDED */ { STATE_SURFACE, STATE_SURFACE,  STATE_VR_MODE,   STATE_SUSPENDED }
+        };
+        return NEXT_STATES[state][targetState];
+    }
+
+private:
+    struct Edge
+    {
+        std::atomic<unsigned int> count;
+        std::atomic<long long> totalNanoseconds;
+        std::atomic<long long> maxNanoseconds;
+    };
+
+    Edge edges[STATE_COUNT][STATE_COUNT];
+    std::atomic<int> state;
+
+public:
+    VrModeStateMachine(): state(STATE_IDLE)
+    {
+        for (int from = 0; from < STATE_COUNT; from++)
+        {
+            for (int to = 0; to < STATE_COUNT; to++)
+            {
+                edges[from][to].count.store(0);
+                edges[from][to].totalNanoseconds.store(0);
+                edges[from][to].maxNanoseconds.store(0);
+            }
+        }
+    }
+
+    inline int getState() const
+    {
+        return state.load(std::memory_order_relaxed);
+    }
+
+    // Moves to the next state once the side effects of the edge are done. Only from the tracking thread.
+    void transitioned(const int nextState, const long long nanoseconds)
+    {
+        Edge& edge = edges[state.load(std::memory_order_relaxed)][nextState];
+        edge.totalNanoseconds.store(edge.totalNanoseconds.load(std::memory_order_relaxed) + nanoseconds, std::memory_order_relaxed);
+        if (nanoseconds > edge.maxNanoseconds.load(std::memory_order_relaxed))
+        {
+            edge.maxNanoseconds.store(nanoseconds, std::memory_order_relaxed);
+        }
+        edge.count.store(edge.count.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        state.store(nextState, std::memory_order_relaxed);
+    }
+
+    void getStatistics(float statistics[STATISTICS_FLOAT_COUNT]) const
+    {
+        for (int from = 0; from < STATE_COUNT; from++)
+        {
+            for (int to = 0; to < STATE_COUNT; to++)
+            {
+                const Edge& edge = edges[from][to];
+                const unsigned int count = edge.count.load(std::memory_order_acquire);
+                float* edgeStatistics = statistics + (from * STATE_COUNT + to) * FLOATS_PER_EDGE;
+                edgeStatistics[0] = (float)count;
+                edgeStatistics[1] = count > 0 ? (float)(edge.totalNanoseconds.load(std::memory_order_relaxed) / count) * 1e-6f : 0.0f;
+                edgeStatistics[2] = (float)edge.maxNanoseconds.load(std::memory_order_relaxed) * 1e-6f;
+            }
+        }
+    }
+};
+
+#endif // VR_MODE_STATE_MACHINE_H
@@ -0,0 +1,317 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <string.h>
+#include <sched.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <sys/resource.h>
+
+#include <atomic>
+
+#include "Clock.h"
+#include "ThreadConfiguration.h"
+
+// ================================================================================================
+// WorkerPool
+// A few low priority threads (nice WORKER_NICE) that run the work that does not have to be done right away (logging,
+// file output, aggregating metrics) off the tracking, sampler and Java threads.
+// Tasks are copied into a bounded multi producer/multi consumer ring (each cell has a sequence number
+// that tells whether it is free or full for the current lap), so submitting never takes a lock and
+// never allocates: when the ring is full the task is rejected (and counted) instead of blocking the
+// caller. Idle workers sleep on a semaphore that is only posted when some worker is idle.
+// stop() runs every task submitted before it returns: it waits for the submitters that may still be
+// pushing (counted around the push) before its final drain.
+// ================================================================================================
+#define WORKER_TASK_TEXT_SIZE 112
+
+typedef struct ovrWorkerTask_s ovrWorkerTask;
+
+struct ovrWorkerTask_s
+{
+    void (*Function)(const ovrWorkerTask* task);
+    void* Context;
+    // Free for the task to use (a log line, a file name...).
+    char Text[WORKER_TASK_TEXT_SIZE];
+    // Set by submit.
+    long long SubmitTimeInNanoseconds;
+};
+
+class WorkerPool
+{
+public:
+    static const int WORKER_COUNT = 2;
+    // Must be a power of 2.
+    static const unsigned int CAPACITY = 256;
+    // Android's THREAD_PRIORITY_BACKGROUND. Lowering the priority of a thread needs no permission.
+    static const int WORKER_NICE = 10;
+
+    // submitted, executed, rejected, queue depth, max queue depth, mean latency (us), max latency (us)
+    static const int STATISTICS_FLOAT_COUNT = 7;
+
+private:
+    struct Cell
+    {
+        std::atomic<unsigned int> sequence;
+        ovrWorkerTask task;
+    };
+
+    Cell cells[CAPACITY];
+    std::atomic<unsigned int> enqueuePosition;
+    std::atomic<unsigned int> dequeuePosition;
+
+    pthread_t threads[WORKER_COUNT];
+    int threadCount;
+    std::atomic<bool> running;
+    std::atomic<int> idleCount;
+    // The submit calls between their running check and the end of their push.
+    std::atomic<int> submittingCount;
+    sem_t semaphore;
+
+    std::atomic<unsigned int> submittedCount;
+    std::atomic<unsigned int> executedCount;
+    std::atomic<unsigned int> rejectedCount;
+    std::atomic<unsigned int> maxDepth;
+    std::atomic<long long> latencySumNanoseconds;
+    std::atomic<long long> latencyMaxNanoseconds;
+
+    bool push(const ovrWorkerTask& task)
+    {
+        unsigned int position = enqueuePosition.load(std::memory_order_relaxed);
+        for ( ; ; )
+        {
+            Cell& cell = cells[position & (CAPACITY - 1)];
+            const unsigned int sequence = cell.sequence.load(std::memory_order_acquire);
+            const int difference = (int)(sequence - position);
+            if (difference == 0)
+            {
+                if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    cell.task = task;
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (difference < 0)
+            {
+                // The cell still holds the task of the previous lap: full
+                return false;
+            }
+            else
+            {
+                position = enqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool pop(ovrWorkerTask& task)
+    {
+        unsigned int position = dequeuePosition.load(std::memory_order_relaxed);
+        for ( ; ; )
+        {
+            Cell& cell = cells[position & (CAPACITY - 1)];
+            const unsigned int sequence = cell.sequence.load(std::memory_order_acquire);
+            const int difference = (int)(sequence - (position + 1));
+            if (difference == 0)
+            {
+                if (dequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    task = cell.task;
+                    cell.sequence.store(position + CAPACITY, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (difference < 0)
+            {
+                // Empty
+                return false;
+            }
+            else
+            {
+                position = dequeuePosition.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void execute(const ovrWorkerTask& task)
+    {
+        const long long latency = GetTimeInNanoseconds() - task.SubmitTimeInNanoseconds;
+        latencySumNanoseconds.fetch_add(latency, std::memory_order_relaxed);
+        long long latencyMax = latencyMaxNanoseconds.load(std::memory_order_relaxed);
+        while (latency > latencyMax && !latencyMaxNanoseconds.compare_exchange_weak(latencyMax, latency, std::memory_order_relaxed))
+        {
+        }
+        task.Function(&task);
+        executedCount.fetch_add(1, std::memory_order_release);
+    }
+
+    void threadFunction()
+    {
+        ovrThreadConfiguration configuration;
+        ovrThreadConfiguration_Init(&configuration, "OVRHeadWorker");
+        ovrThreadTelemetry telemetry;
+        ovrThreadConfiguration_ApplyToCurrentThread(&configuration, &telemetry);
+        setpriority(PRIO_PROCESS, 0, WORKER_NICE);
+
+        ovrWorkerTask task;
+        for ( ; ; )
+        {
+            if (pop(task))
+            {
+                execute(task);
+                continue;
+            }
+            if (!running.load())
+            {
+                // Drained
+                break;
+            }
+            // Announce the wait before checking the ring one last time: either this check sees a task that
+            // was just pushed or its submitter sees the idle worker and posts the semaphore
+            idleCount.fetch_add(1);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const bool popped = pop(task);
+            if (!popped && running.load())
+            {
+                while (sem_wait(&semaphore) != 0)
+                {
+                }
+            }
+            idleCount.fetch_sub(1);
+            if (popped)
+            {
+                execute(task);
+            }
+        }
+    }
+
+    static void* threadFunctionStatic(void* data)
+    {
+        ((WorkerPool*)data)->threadFunction();
+        return NULL;
+    }
+
+public:
+    WorkerPool(): enqueuePosition(0), dequeuePosition(0), threadCount(0), running(false), idleCount(0), submittingCount(0)
+    {
+        for (unsigned int i = 0; i < CAPACITY; i++)
+        {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        sem_init(&semaphore, 0, 0);
+        resetStatistics();
+    }
+
+    ~WorkerPool()
+    {
+        stop();
+        sem_destroy(&semaphore);
+    }
+
+    void resetStatistics()
+    {
+        submittedCount.store(0);
+        executedCount.store(0);
+        rejectedCount.store(0);
+        maxDepth.store(0);
+        latencySumNanoseconds.store(0);
+        latencyMaxNanoseconds.store(0);
+    }
+
+    // Returns false if no worker thread could be created (the tasks are then run by submit itself).
+    bool start()
+    {
+        running.store(true);
+        for (threadCount = 0; threadCount < WORKER_COUNT; threadCount++)
+        {
+            if (pthread_create(&threads[threadCount], NULL, threadFunctionStatic, this) != 0)
+            {
+                break;
+            }
+        }
+        if (threadCount == 0)
+        {
+            running.store(false);
+            return false;
+        }
+        return true;
+    }
+
+    // Runs every task that was submitted before the call, then stops the workers.
+    void stop()
+    {
+        if (!running.exchange(false))
+        {
+            return;
+        }
+        for (int i = 0; i < threadCount; i++)
+        {
+            sem_post(&semaphore);
+        }
+        for (int i = 0; i < threadCount; i++)
+        {
+            pthread_join(threads[i], NULL);
+        }
+        threadCount = 0;
+        // Anything that raced with the stop: a submit that saw the workers running may still be pushing
+        while (submittingCount.load() > 0)
+        {
+            sched_yield();
+        }
+        ovrWorkerTask task;
+        while (pop(task))
+        {
+            execute(task);
+        }
+    }
+
+    // Any thread. Returns false if the queue is full (the task is dropped).
+    bool submit(ovrWorkerTask& task)
+    {
+        task.SubmitTimeInNanoseconds = GetTimeInNanoseconds();
+        // Counted before the running check so that stop either sees this submit or this submit sees it stopped
+        submittingCount.fetch_add(1);
+        if (!running.load())
+        {
+            submittingCount.fetch_sub(1);
+            // Not started (or stopped): do it here so nothing is lost
+            submittedCount.fetch_add(1, std::memory_order_relaxed);
+            execute(task);
+            return true;
+        }
+        const bool pushed = push(task);
+        submittingCount.fetch_sub(1);
+        if (!pushed)
+        {
+            rejectedCount.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        const unsigned int submitted = submittedCount.fetch_add(1, std::memory_order_relaxed) + 1;
+        const unsigned int depth = submitted - executedCount.load(std::memory_order_relaxed);
+        unsigned int currentMaxDepth = maxDepth.load(std::memory_order_relaxed);
+        while (depth > currentMaxDepth && depth <= CAPACITY && !maxDepth.compare_exchange_weak(currentMaxDepth, depth, std::memory_order_relaxed))
+        {
+        }
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (idleCount.load() > 0)
+        {
+            sem_post(&semaphore);
+        }
+        return true;
+    }
+
+    void getStatistics(float statistics[STATISTICS_FLOAT_COUNT]) const
+    {
+        const unsigned int executed = executedCount.load(std::memory_order_acquire);
+        const unsigned int submitted = submittedCount.load(std::memory_order_relaxed);
+        statistics[0] = (float)submitted;
+        statistics[1] = (float)executed;
+        statistics[2] = (float)rejectedCount.load(std::memory_order_relaxed);
+        statistics[3] = submitted > executed ? (float)(submitted - executed) : 0.0f;
+        statistics[4] = (float)maxDepth.load(std::memory_order_relaxed);
+        statistics[5] = executed > 0 ? (float)(latencySumNanoseconds.load(std::memory_order_relaxed) / executed) * 0.001f : 0.0f;
+        statistics[6] = (float)latencyMaxNanoseconds.load(std::memory_order_relaxed) * 0.001f;
+    }
+};
+
+#endif // WORKER_POOL_H